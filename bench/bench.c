@@ -0,0 +1,59 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "whiskey.h"
+
+
+volatile size_t bench_sink;
+
+double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void bench_report(const char *name, size_t iterations, double seconds) {
+  double nsPerIteration = seconds * 1e9 / (double)iterations;
+  printf("  %-40s %10.1f ns/op  (%zu ops in %.3f s)\n",
+         name, nsPerIteration, iterations, seconds);
+}
+
+
+typedef struct {
+  const char *name;
+  void (*function)(void);
+} Benchmark;
+
+static const Benchmark BENCHMARKS[] = {
+  {"dict", dictBenchmark},
+  {"escape", escapeBenchmark},
+  {"eval", evalBenchmark},
+  {"gc", gcBenchmark},
+  {"template", templateBenchmark},
+  {0, 0},
+};
+
+
+static void run(const Benchmark *benchmark) {
+  printf("%s\n", benchmark->name);
+  benchmark->function();
+}
+
+int main(int argc, char **argv) {
+  wsky_start();
+
+  for (const Benchmark *b = BENCHMARKS; b->name; b++) {
+    bool selected = argc == 1;
+    for (int i = 1; i < argc; i++)
+      if (strcmp(argv[i], b->name) == 0)
+        selected = true;
+    if (selected)
+      run(b);
+  }
+
+  wsky_stop();
+  return 0;
+}
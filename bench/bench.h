@@ -0,0 +1,29 @@
+#ifndef BENCH_H
+# define BENCH_H
+
+# include <stddef.h>
+
+/** Returns a monotonic time in seconds */
+double bench_now(void);
+
+/**
+ * Prints a line of results.
+ * @param name The name of the measure
+ * @param iterations The number of iterations
+ * @param seconds The elapsed time
+ */
+void bench_report(const char *name, size_t iterations, double seconds);
+
+/**
+ * A value which can be written by the benchmarks to prevent the compiler
+ * from optimizing the measured code away.
+ */
+extern volatile size_t bench_sink;
+
+void dictBenchmark(void);
+void escapeBenchmark(void);
+void evalBenchmark(void);
+void gcBenchmark(void);
+void templateBenchmark(void);
+
+#endif /* !BENCH_H */
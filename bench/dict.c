@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "dict.h"
+
+
+/*
+ * The former linked-list dictionnary, kept here as a reference point.
+ */
+
+typedef struct ListEntry_s {
+  char *key;
+  void *value;
+  struct ListEntry_s *previous;
+  struct ListEntry_s *next;
+} ListEntry;
+
+typedef struct {
+  ListEntry *first;
+} ListDict;
+
+static void ListDict_free(ListDict *self) {
+  ListEntry *entry = self->first;
+  while (entry) {
+    ListEntry *next = entry->next;
+    free(entry->key);
+    free(entry);
+    entry = next;
+  }
+  self->first = NULL;
+}
+
+static ListEntry *ListDict_getEntry(const ListDict *self, const char *key) {
+  for (ListEntry *entry = self->first; entry; entry = entry->next)
+    if (strcmp(entry->key, key) == 0)
+      return entry;
+  return NULL;
+}
+
+static void *ListDict_get(const ListDict *self, const char *key) {
+  ListEntry *entry = ListDict_getEntry(self, key);
+  return entry ? entry->value : NULL;
+}
+
+static void ListDict_set(ListDict *self, const char *key, void *value) {
+  ListEntry *entry = ListDict_getEntry(self, key);
+  if (entry) {
+    entry->value = value;
+    return;
+  }
+  entry = malloc(sizeof(ListEntry));
+  size_t length = strlen(key);
+  entry->key = malloc(length + 1);
+  memcpy(entry->key, key, length + 1);
+  entry->value = value;
+  entry->previous = NULL;
+  entry->next = self->first;
+  if (self->first)
+    self->first->previous = entry;
+  self->first = entry;
+}
+
+
+
+#define MAX_KEYS 1024
+#define LOOKUPS (1 << 20)
+
+static char keys[MAX_KEYS][32];
+
+static void fillKeys(size_t count) {
+  for (size_t i = 0; i < count; i++)
+    snprintf(keys[i], sizeof keys[i], "identifier_%zu", i);
+}
+
+static void benchSize(size_t count) {
+  char name[64];
+  double start;
+  size_t found;
+
+  fillKeys(count);
+
+  ListDict list = {NULL};
+  for (size_t i = 0; i < count; i++)
+    ListDict_set(&list, keys[i], keys[i]);
+
+  found = 0;
+  start = bench_now();
+  for (size_t i = 0; i < LOOKUPS; i++)
+    found += ListDict_get(&list, keys[i % count]) != NULL;
+  bench_sink = found;
+  snprintf(name, sizeof name, "list get, %zu keys", count);
+  bench_report(name, LOOKUPS, bench_now() - start);
+  ListDict_free(&list);
+
+  wsky_Dict dict;
+  wsky_Dict_init(&dict);
+  for (size_t i = 0; i < count; i++)
+    wsky_Dict_set(&dict, keys[i], keys[i]);
+
+  found = 0;
+  start = bench_now();
+  for (size_t i = 0; i < LOOKUPS; i++)
+    found += wsky_Dict_get(&dict, keys[i % count]) != NULL;
+  bench_sink = found;
+  snprintf(name, sizeof name, "dict get, %zu keys", count);
+  bench_report(name, LOOKUPS, bench_now() - start);
+  wsky_Dict_free(&dict);
+}
+
+static void benchInsertions(size_t count) {
+  char name[64];
+  size_t rounds = LOOKUPS / count / 8;
+  double start;
+
+  fillKeys(count);
+
+  start = bench_now();
+  for (size_t r = 0; r < rounds; r++) {
+    ListDict list = {NULL};
+    for (size_t i = 0; i < count; i++)
+      ListDict_set(&list, keys[i], keys[i]);
+    ListDict_free(&list);
+  }
+  snprintf(name, sizeof name, "list set, %zu keys", count);
+  bench_report(name, rounds * count, bench_now() - start);
+
+  start = bench_now();
+  for (size_t r = 0; r < rounds; r++) {
+    wsky_Dict dict;
+    wsky_Dict_init(&dict);
+    for (size_t i = 0; i < count; i++)
+      wsky_Dict_set(&dict, keys[i], keys[i]);
+    wsky_Dict_free(&dict);
+  }
+  snprintf(name, sizeof name, "dict set, %zu keys", count);
+  bench_report(name, rounds * count, bench_now() - start);
+}
+
+void dictBenchmark(void) {
+  static const size_t SIZES[] = {4, 16, 64, 256, 1024};
+  for (size_t i = 0; i < sizeof SIZES / sizeof SIZES[0]; i++)
+    benchSize(SIZES[i]);
+  for (size_t i = 0; i < sizeof SIZES / sizeof SIZES[0]; i++)
+    benchInsertions(SIZES[i]);
+}
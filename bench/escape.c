@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "whiskey.h"
+
+
+/*
+ * Escapes a text without special characters, an English-like text with a
+ * few ones and a text of markup, with the kernel and with a loop which
+ * tests each byte. Then prints a long string to a template output, and
+ * quotes it with wsky_String_escapeCString().
+ */
+
+enum {
+  TEXT_LENGTH = 64 * 1024
+};
+
+static const size_t RUNS = 2000;
+
+static char text[TEXT_LENGTH];
+static char escaped[TEXT_LENGTH * 6];
+
+
+/** Fills the text by repeating a pattern */
+static void fillText(const char *pattern) {
+  size_t patternLength = strlen(pattern);
+  for (size_t i = 0; i < TEXT_LENGTH; i++)
+    text[i] = pattern[i % patternLength];
+}
+
+/** The reference, one byte at a time */
+static char *escapeBytes(char *dest, const char *bytes, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    size_t entityLength;
+    const char *entity = wsky_html_getEntity(bytes[i], &entityLength);
+    if (entity) {
+      memcpy(dest, entity, entityLength);
+      dest += entityLength;
+    } else {
+      *dest++ = bytes[i];
+    }
+  }
+  return dest;
+}
+
+static void report(const char *name, double seconds) {
+  bench_report(name, RUNS, seconds);
+  printf("  %-40s %10.0f MB/s\n", "",
+         (double)RUNS * TEXT_LENGTH / seconds / 1e6);
+}
+
+static void benchText(const char *textName, const char *pattern) {
+  char name[64];
+  fillText(pattern);
+
+  double start = bench_now();
+  for (size_t i = 0; i < RUNS; i++)
+    bench_sink = (size_t)(wsky_html_escape(escaped, text, TEXT_LENGTH) -
+                          escaped);
+  snprintf(name, sizeof name, "%s, %s", textName, wsky_html_getScannerName());
+  report(name, bench_now() - start);
+
+  start = bench_now();
+  for (size_t i = 0; i < RUNS; i++)
+    bench_sink = (size_t)(escapeBytes(escaped, text, TEXT_LENGTH) - escaped);
+  snprintf(name, sizeof name, "%s, byte per byte", textName);
+  report(name, bench_now() - start);
+}
+
+static void benchPrint(void) {
+  fillText("Lorem ipsum dolor sit amet, consectetur 'adipiscing' elit. ");
+  text[TEXT_LENGTH - 1] = '\0';
+
+  wsky_HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  wsky_Value *string = wsky_Handle_new(
+    wsky_Value_fromObject((wsky_Object *)wsky_String_new(text)));
+  wsky_TemplateOutput output;
+  wsky_TemplateOutput_initBuffer(&output);
+
+  double start = bench_now();
+  for (size_t i = 0; i < RUNS; i++) {
+    wsky_TemplateOutput_clear(&output);
+    wsky_Result rv = wsky_TemplateOutput_writeValue(&output, *string);
+    if (rv.exception) {
+      wsky_Exception_print(rv.exception);
+      break;
+    }
+    bench_sink = output.length;
+  }
+  report("template print", bench_now() - start);
+  wsky_TemplateOutput_free(&output);
+  wsky_HandleScope_close(&handleScope);
+
+  start = bench_now();
+  for (size_t i = 0; i < RUNS; i++) {
+    char *quoted = wsky_String_escapeCString(text);
+    bench_sink = (size_t)quoted[1];
+    wsky_free(quoted);
+  }
+  report("escapeCString", bench_now() - start);
+}
+
+void escapeBenchmark(void) {
+  benchText("clean text",
+            "Lorem ipsum dolor sit amet, consectetur adipiscing elit. ");
+  benchText("sparse text",
+            "Lorem ipsum dolor sit amet, consectetur adipiscing elit; "
+            "sed do eiusmod tempor incididunt ut labore & dolore. ");
+  benchText("markup",
+            "<a href=\"#\">x</a>");
+  benchPrint();
+}
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include "bench.h"
+#include "whiskey.h"
+
+
+/*
+ * Runs the same programs with the tree-walking evaluator and with the
+ * virtual machine.
+ */
+
+typedef struct {
+  const char *name;
+  const char *source;
+  size_t runs;
+} Program;
+
+static const Program PROGRAMS[] = {
+  {
+    "fibonacci",
+    "var fib = {n: if n < 2: n else: fib(n - 1) + fib(n - 2)};"
+    "fib(20)",
+    20,
+  },
+  {
+    "methods",
+    "class Counter ("
+    "  init {@count = 0};"
+    "  get @count;"
+    "  @increment {@count = @count + 1}"
+    ");"
+    "var c = Counter();"
+    "var loop = {n: if n == 0: c.count else: (c.increment(); loop(n - 1))};"
+    "loop(2000)",
+    200,
+  },
+  {
+    "points",
+    "class Point ("
+    "  init {x, y: @x = x; @y = y};"
+    "  get @x; get @y;"
+    "  @add {p: Point(@x + p.x, @y + p.y)}"
+    ");"
+    "var step = Point(0.5, 1);"
+    "var loop = {n, p: if n == 0: p.y else: loop(n - 1, p.add(step))};"
+    "loop(2000, Point(0, 0))",
+    200,
+  },
+  {
+    "exceptions",
+    "var f = {n:"
+    "  if n == 0: 0 else: ("
+    "    try: 1 / 0 except ZeroDivisionError: f(n - 1)"
+    "  )"
+    "};"
+    "f(1000)",
+    200,
+  },
+  {0, 0, 0},
+};
+
+static void benchProgram(const Program *program, bool vm) {
+  char name[64];
+
+  wsky_vm_setEnabled(vm);
+  double start = bench_now();
+  for (size_t i = 0; i < program->runs; i++) {
+    wsky_Result rv = wsky_evalString(program->source, NULL);
+    if (rv.exception) {
+      wsky_Exception_print(rv.exception);
+      break;
+    }
+    bench_sink = (size_t)wsky_Value_toInt(rv.v);
+  }
+  snprintf(name, sizeof name, "%s, %s", program->name,
+           vm ? "vm" : "tree walker");
+  bench_report(name, program->runs, bench_now() - start);
+  wsky_vm_setEnabled(false);
+}
+
+void evalBenchmark(void) {
+  printf("  values of %zu bytes, results of %zu bytes\n",
+         sizeof(wsky_Value), sizeof(wsky_Result));
+  for (const Program *program = PROGRAMS; program->name; program++) {
+    benchProgram(program, false);
+    benchProgram(program, true);
+  }
+}
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include "bench.h"
+#include "whiskey.h"
+#include "src/heaps.h"
+
+
+/*
+ * Measures the pause of the full and minor collections with a growing
+ * number of live objects, the time spent in the lazy sweep, the cost
+ * of the conservative membership test and the compaction of a fragmented
+ * heap.
+ */
+
+#define MAX_LIVE_OBJECTS 256000
+
+/** Creates a scope which holds the given number of strings */
+static wsky_Scope *newLiveScope(unsigned count) {
+  wsky_Scope *scope = wsky_Scope_newWithSlots(NULL, NULL, NULL, count);
+  wsky_eval_pushScope(scope);
+  wsky_Symbol name = wsky_Symbol_intern("live");
+  for (unsigned i = 0; i < count; i++) {
+    wsky_String *string = wsky_String_new("live");
+    wsky_Scope_declareSlot(scope, i, name, wsky_Value_fromObject(
+                             (wsky_Object *)string));
+  }
+  return scope;
+}
+
+static void allocateGarbage(unsigned count) {
+  for (unsigned i = 0; i < count; i++)
+    wsky_String_new("garbage");
+}
+
+static void benchPause(unsigned liveObjectCount) {
+  char name[64];
+  const size_t runs = 10;
+
+  newLiveScope(liveObjectCount);
+  double seconds = 0, sweepSeconds = 0;
+  for (size_t i = 0; i < runs; i++) {
+    allocateGarbage(1000);
+    double start = bench_now();
+    wsky_GC_collect();
+    seconds += bench_now() - start;
+
+    start = bench_now();
+    wsky_GC_finishSweep();
+    sweepSeconds += bench_now() - start;
+  }
+  snprintf(name, sizeof name, "full pause, %u live objects",
+           liveObjectCount);
+  bench_report(name, runs, seconds);
+  snprintf(name, sizeof name, "lazy sweep, %u live objects",
+           liveObjectCount);
+  bench_report(name, runs, sweepSeconds);
+
+  /* The live objects are old, only the garbage is young */
+  seconds = 0;
+  for (size_t i = 0; i < runs; i++) {
+    allocateGarbage(1000);
+    double start = bench_now();
+    wsky_GC_collectYoung();
+    seconds += bench_now() - start;
+  }
+  snprintf(name, sizeof name, "minor pause, %u live objects",
+           liveObjectCount);
+  bench_report(name, runs, seconds);
+
+  wsky_eval_popScope();
+}
+
+static void benchMembership(void) {
+  const unsigned count = 1000;
+  const size_t runs = 10000;
+  wsky_Scope *scope = newLiveScope(count);
+
+  /* Objects, interior pointers and addresses out of the heaps */
+  void *pointers[3 * 1000];
+  for (unsigned i = 0; i < count; i++) {
+    char *object = (char *)wsky_Value_toObject(scope->slots[i]);
+    pointers[3 * i] = object;
+    pointers[3 * i + 1] = object + 8;
+    pointers[3 * i + 2] = &pointers[i];
+  }
+
+  size_t found = 0;
+  double start = bench_now();
+  for (size_t r = 0; r < runs; r++)
+    for (size_t i = 0; i < 3 * count; i++)
+      found += wsky_heaps_contains(pointers[i]);
+  double seconds = bench_now() - start;
+  bench_sink = found;
+  wsky_eval_popScope();
+
+  bench_report("membership test", runs * 3 * count, seconds);
+}
+
+/** Keeps one string out of 16 after a peak of allocations */
+static void benchCompaction(void) {
+  const unsigned count = MAX_LIVE_OBJECTS;
+  wsky_Scope *scope = wsky_Scope_newWithSlots(NULL, NULL, NULL, count / 16);
+  wsky_eval_pushScope(scope);
+  wsky_Symbol name = wsky_Symbol_intern("live");
+  for (unsigned i = 0; i < count; i++) {
+    wsky_String *string = wsky_String_new("peak");
+    if (i % 16 == 0)
+      wsky_Scope_declareSlot(scope, i / 16, name, wsky_Value_fromObject(
+                               (wsky_Object *)string));
+  }
+  wsky_GC_collect();
+  wsky_GC_finishSweep();
+
+  wsky_GC_Stats before, after;
+  wsky_GC_getStats(&before);
+  double start = bench_now();
+  wsky_GC_compact();
+  double seconds = bench_now() - start;
+  wsky_GC_getStats(&after);
+  wsky_eval_popScope();
+
+  char report[64];
+  snprintf(report, sizeof report, "compaction, heap %zu KiB -> %zu KiB",
+           before.heapSize / 1024, after.heapSize / 1024);
+  bench_report(report, after.movedObjectCount - before.movedObjectCount,
+               seconds);
+}
+
+void gcBenchmark(void) {
+  bool stressed = wsky_GC_isStressed();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  wsky_GC_setStressed(false);
+  wsky_GC_setMinimumThreshold((size_t)-1);
+
+  for (unsigned count = 1000; count <= MAX_LIVE_OBJECTS; count *= 4)
+    benchPause(count);
+  benchMembership();
+  benchCompaction();
+
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setStressed(stressed);
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include "bench.h"
+#include "whiskey.h"
+
+
+/*
+ * Renders a page of 50 rows into a buffered, a streamed and a vectored
+ * output, with the tree-walking evaluator and with the virtual machine. The
+ * page is parsed at each rendering from a string, and only once from a
+ * file, which stays in the cache.
+ */
+
+static const char PAGE[] =
+  "<% var title = 'Products';"
+  "   var price = {n: n * 1.25};"
+  "   var row = {i: ( %>\n"
+  "    <tr><td>Item <%= i %></td><td><%= price(i) %></td>"
+  "<td><%= i < 10 %></td></tr>\n"
+  "<% )};"
+  "   var rows = {i, n: if i < n: (row(i); rows(i + 1, n))} %>"
+  "<!DOCTYPE html>\n"
+  "<html>\n"
+  "  <head><title><%= title %></title></head>\n"
+  "  <body>\n"
+  "    <h1><%= title %></h1>\n"
+  "    <table>\n"
+  "<% rows(0, 50) %>"
+  "    </table>\n"
+  "  </body>\n"
+  "</html>\n";
+
+static const size_t RUNS = 2000;
+
+typedef enum {
+  BUFFERED,
+  STREAMED,
+  VECTORED
+} Mode;
+
+static const char *const MODE_NAMES[] = {"buffered", "streamed", "vectored"};
+
+
+static bool discard(void *data, const char *bytes, size_t length) {
+  (void)data;
+  bench_sink = (size_t)bytes[0] + length;
+  return true;
+}
+
+static bool discardSlices(void *data,
+                          const wsky_TemplateSlice *slices, size_t count) {
+  (void)data;
+  for (size_t i = 0; i < count; i++)
+    bench_sink += slices[i].length;
+  return true;
+}
+
+static wsky_Result render(const char *path, wsky_TemplateOutput *output) {
+  if (path)
+    return wsky_evalTemplateFile(path, NULL, output);
+  return wsky_evalTemplateString(PAGE, NULL, output);
+}
+
+static void benchPage(const char *path, bool vm, Mode mode) {
+  char name[64];
+  wsky_TemplateOutput output;
+  if (mode == STREAMED)
+    wsky_TemplateOutput_initStream(&output, discard, NULL);
+  else if (mode == VECTORED)
+    wsky_TemplateOutput_initVector(&output, discardSlices, NULL);
+  else
+    wsky_TemplateOutput_initBuffer(&output);
+
+  wsky_vm_setEnabled(vm);
+  double start = bench_now();
+  for (size_t i = 0; i < RUNS; i++) {
+    wsky_TemplateOutput_clear(&output);
+    wsky_Result rv = render(path, &output);
+    if (rv.exception) {
+      wsky_Exception_print(rv.exception);
+      break;
+    }
+    bench_sink = output.length;
+  }
+  double seconds = bench_now() - start;
+  wsky_vm_setEnabled(false);
+  wsky_TemplateOutput_free(&output);
+
+  snprintf(name, sizeof name, "%s, %s, %s",
+           path ? "file" : "string",
+           MODE_NAMES[mode], vm ? "vm" : "tree walker");
+  bench_report(name, RUNS, seconds);
+  printf("  %-40s %10.0f pages/s\n", "", (double)RUNS / seconds);
+}
+
+static char *writePage(void) {
+  char *directory = wsky_path_getProgramDirectoryPath();
+  char *path = wsky_path_concat(directory, "bench_page.html");
+  wsky_free(directory);
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    wsky_free(path);
+    return NULL;
+  }
+  fputs(PAGE, file);
+  fclose(file);
+  return path;
+}
+
+void templateBenchmark(void) {
+  benchPage(NULL, false, BUFFERED);
+  benchPage(NULL, true, BUFFERED);
+
+  char *path = writePage();
+  if (!path)
+    return;
+
+  /* The page is never truncated while it is mapped */
+  wsky_FileContent_setMappingEnabled(true);
+  size_t hitCount = wsky_FileCache_getHitCount();
+  size_t missCount = wsky_FileCache_getMissCount();
+  for (Mode mode = BUFFERED; mode <= VECTORED; mode++) {
+    benchPage(path, false, mode);
+    benchPage(path, true, mode);
+  }
+  printf("  file cache: %zu hits, %zu misses\n",
+         wsky_FileCache_getHitCount() - hitCount,
+         wsky_FileCache_getMissCount() - missCount);
+  wsky_FileContent_setMappingEnabled(false);
+  remove(path);
+  wsky_free(path);
+}
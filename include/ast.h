@@ -4,6 +4,8 @@
 # include "position.h"
 # include "token.h"
 # include "method_def.h"
+# include "symbol.h"
+# include "inline_cache.h"
 
 /**
  * @defgroup ast ast
@@ -113,6 +115,9 @@ void wsky_ASTNode_print(const wsky_ASTNode *node, FILE *output);
 
 /**
  * Deletes the node and its children.
+ *
+ * A function node is shared with the functions created from it, so it
+ * is only deleted by its last owner.
  */
 void wsky_ASTNode_delete(wsky_ASTNode *node);
 
@@ -156,7 +161,17 @@ typedef struct {
   wsky_ASTNode_HEAD
 
   /** The identifier or NULL */
-  char *name;
+  wsky_Symbol name;
+
+  /**
+   * The number of scopes between the use of the identifier and its
+   * declaration, or -1 if the variable has to be looked up by name.
+   * Set by the resolver.
+   */
+  int depth;
+
+  /** The slot of the variable in its scope, if `depth` is not -1 */
+  unsigned slot;
 } wsky_IdentifierNode;
 
 /** Creates a new wsky_IdentifierNode from a wsky_Token */
@@ -168,19 +183,46 @@ wsky_IdentifierNode *wsky_IdentifierNode_new(const char *name,
                                              wsky_Position position);
 
 
+struct wsky_FileContent_s;
+
+/** A slice of the content of a template */
+typedef struct {
+
+  /** The index of the first byte */
+  size_t offset;
+
+  /** The number of bytes */
+  size_t length;
+} wsky_HtmlSlice;
+
 /**
  * An HTML node
  * Template-only.
+ *
+ * The HTML is not copied, it is made of slices of the content of the
+ * template. The parser merges the adjacent HTML nodes into one node.
  */
 typedef struct {
   wsky_ASTNode_HEAD
 
-  /** The HTML source code */
-  char *content;
+  /** The content of the template, shared by the node */
+  struct wsky_FileContent_s *source;
+
+  /** The slices, in the order of the template */
+  wsky_HtmlSlice *slices;
+
+  /** The number of slices */
+  unsigned sliceCount;
 } wsky_HtmlNode;
 
 wsky_HtmlNode *wsky_HtmlNode_new(const wsky_Token *token);
 
+/**
+ * Appends the slices of an HTML node to another one, which must have
+ * the same content.
+ */
+void wsky_HtmlNode_append(wsky_HtmlNode *node, const wsky_HtmlNode *next);
+
 
 
 /**
@@ -311,6 +353,9 @@ typedef struct {
 
   /** `true` if this node is the root of a program. */
   bool program;
+
+  /** The number of variable slots of the scope. Set by the resolver. */
+  unsigned slotCount;
 } wsky_SequenceNode;
 
 
@@ -330,7 +375,16 @@ typedef struct {
   wsky_ASTNodeList *parameters;
 
   /** The name or NULL */
-  char *name;
+  wsky_Symbol name;
+
+  /**
+   * The number of variable slots of the scope of a call, parameters
+   * included. Set by the resolver.
+   */
+  unsigned slotCount;
+
+  /** The number of owners: the parent node and the functions */
+  unsigned refCount;
 
 } wsky_FunctionNode;
 
@@ -341,6 +395,12 @@ wsky_FunctionNode *wsky_FunctionNode_new(const wsky_Token *token,
 
 void wsky_FunctionNode_setName(wsky_FunctionNode *node, const char *newName);
 
+/**
+ * Adds an owner to the node and returns it. The tree is not copied, it
+ * must not be modified anymore.
+ */
+wsky_FunctionNode *wsky_FunctionNode_retain(const wsky_FunctionNode *node);
+
 
 /**
  * A variable declaration node
@@ -349,11 +409,17 @@ typedef struct {
   wsky_ASTNode_HEAD
 
   /** The variable name */
-  char *name;
+  wsky_Symbol name;
 
   /** The right node (the value to assign to the variable) or NULL */
   wsky_ASTNode *right;
 
+  /**
+   * The slot of the variable in the current scope, or -1 if it is
+   * declared by name. Set by the resolver.
+   */
+  int slot;
+
 } wsky_VarNode;
 
 wsky_VarNode *wsky_VarNode_new(const wsky_Token *token,
@@ -406,7 +472,10 @@ typedef struct {
   wsky_ASTNode *left;
 
   /** The member name */
-  char *name;
+  wsky_Symbol name;
+
+  /** The methods found for the last classes of the object */
+  wsky_InlineCache cache;
 
 } wsky_MemberAccessNode;
 
@@ -420,7 +489,7 @@ typedef struct {
   wsky_ListNode_HEAD
 
   /** The class name */
-  char *name;
+  wsky_Symbol name;
 
   /** The superclass or NULL */
   wsky_ASTNode *superclass;
@@ -428,6 +497,9 @@ typedef struct {
   /** The implemented interfaces */
   wsky_ASTNodeList *interfaces;
 
+  /** The slot of the class variable or -1. Set by the resolver. */
+  int slot;
+
 } wsky_ClassNode;
 
 wsky_ClassNode *wsky_ClassNode_new(const wsky_Token *token,
@@ -442,7 +514,7 @@ typedef struct {
   wsky_ASTNode_HEAD
 
   /** The member name or NULL if constructor */
-  char *name;
+  wsky_Symbol name;
 
   wsky_MethodFlags flags;
 
@@ -466,6 +538,9 @@ typedef struct {
   unsigned level;
 
   char *name;
+
+  /** The slot of the module variable or -1. Set by the resolver. */
+  int slot;
 } wsky_ImportNode;
 
 /**
@@ -483,10 +558,16 @@ wsky_ImportNode *wsky_ImportNode_new(wsky_Position position,
 typedef struct {
   wsky_ASTNode_HEAD
 
-  char *name;
+  wsky_Symbol name;
 
   /* The value or NULL */
   wsky_ASTNode *right;
+
+  /**
+   * The slot of the variable if `right` is not NULL, or -1.
+   * Set by the resolver.
+   */
+  int slot;
 } wsky_ExportNode;
 
 /**
@@ -523,9 +604,21 @@ typedef struct {
   wsky_ASTNodeList *classes;
 
   /** The variable name after the 'as' or NULL */
-  char *variable;
+  wsky_Symbol variable;
 
   wsky_ASTNode *expression;
+
+  /**
+   * The slot of the variable in the scope of the clause, or -1.
+   * Set by the resolver.
+   */
+  int slot;
+
+  /**
+   * The number of variable slots of the scope of the clause.
+   * Set by the resolver.
+   */
+  unsigned slotCount;
 } wsky_ExceptNode;
 
 void wsky_ExceptNode_init(wsky_ExceptNode *node,
@@ -0,0 +1,158 @@
+#ifndef BYTECODE_H_
+# define BYTECODE_H_
+
+# include <stdio.h>
+# include <stdint.h>
+# include "ast.h"
+
+/**
+ * @defgroup bytecode bytecode
+ * @{
+ *
+ * The compiler from the AST to the bytecode run by the virtual machine.
+ *
+ * An instruction is an opcode followed by its operands, all stored in
+ * 32-bit words. Jump targets are offsets in the code. The strings and the
+ * nodes of the constant table point into the compiled AST, which must
+ * outlive the bytecode.
+ */
+
+/**
+ * The opcodes, with their operand count.
+ *
+ * Unless stated otherwise, an instruction pops its operands from the
+ * stack and pushes its result.
+ */
+# define wsky_OPCODES(X)                                                \
+  X(PUSH_NULL, 0)                                                       \
+  X(PUSH_TRUE, 0)                                                       \
+  X(PUSH_FALSE, 0)                                                      \
+  /* constant */                                                        \
+  X(PUSH_INT, 1)                                                        \
+  /* constant */                                                        \
+  X(PUSH_FLOAT, 1)                                                      \
+  /* constant */                                                        \
+  X(PUSH_STRING, 1)                                                     \
+  X(POP, 0)                                                             \
+  /* depth, slot, name constant - falls back to a lookup by name */     \
+  X(LOAD_SLOT, 3)                                                       \
+  /* name constant */                                                   \
+  X(LOAD_NAME, 1)                                                       \
+  /* depth, slot, name constant - leaves the value on the stack */      \
+  X(STORE_SLOT, 3)                                                      \
+  /* name constant - leaves the value on the stack */                   \
+  X(STORE_NAME, 1)                                                      \
+  /* slot, name constant - leaves the value on the stack */             \
+  X(DECLARE_SLOT, 2)                                                    \
+  /* name constant - leaves the value on the stack */                   \
+  X(DECLARE_NAME, 1)                                                    \
+  X(PUSH_SELF, 0)                                                       \
+  X(PUSH_SUPERCLASS, 0)                                                 \
+  /* operator */                                                        \
+  X(BINARY, 1)                                                          \
+  /* operator */                                                        \
+  X(UNARY, 1)                                                           \
+  /* slot count */                                                      \
+  X(ENTER_SCOPE, 1)                                                     \
+  X(LEAVE_SCOPE, 0)                                                     \
+  /* function node constant */                                          \
+  X(MAKE_FUNCTION, 1)                                                   \
+  /* parameter count - the stack is [callee, parameters...] */          \
+  X(CALL, 1)                                                            \
+  /* parameter count */                                                 \
+  X(SUPER_CALL, 1)                                                      \
+  /* member access node constant - replaces the object by [method,   */ \
+  /* object], or by [null, member] if the member is not a method     */ \
+  X(GET_METHOD, 1)                                                      \
+  /* parameter count - the stack is [method, self, parameters...]    */ \
+  X(CALL_METHOD, 1)                                                     \
+  /* member access node constant - the node holds the inline cache */  \
+  X(GET_MEMBER, 1)                                                      \
+  /* name constant */                                                   \
+  X(GET_SUPER_MEMBER, 1)                                                \
+  /* member access node constant - the stack is [value, object] */     \
+  X(SET_MEMBER, 1)                                                      \
+  /* name constant */                                                   \
+  X(SET_SUPER_MEMBER, 1)                                                \
+  /* target */                                                          \
+  X(JUMP, 1)                                                            \
+  /* target - raises a TypeError if the value is not a Boolean */       \
+  X(JUMP_IF_FALSE, 1)                                                   \
+  /* handler - the handler starts with the exception on the stack */    \
+  X(TRY, 1)                                                             \
+  X(END_TRY, 0)                                                         \
+  /* target - the stack is [exception, class], the exception is kept */ \
+  X(EXCEPT_MATCH, 1)                                                    \
+  X(RAISE, 0)                                                           \
+  /* HTML node constant - writes the HTML to the template output */    \
+  X(WRITE_HTML, 1)                                                      \
+  /* writes the value to the template output */                         \
+  X(PRINT, 0)                                                           \
+  /* node constant - evaluates a node with the tree-walking evaluator */ \
+  X(EVAL_NODE, 1)                                                       \
+  X(RETURN, 0)
+
+/** An enumeration of the opcodes */
+typedef enum {
+# define wsky_OPCODE_ENUM(name, operandCount) wsky_Opcode_ ## name,
+  wsky_OPCODES(wsky_OPCODE_ENUM)
+# undef wsky_OPCODE_ENUM
+
+  wsky_Opcode_COUNT
+} wsky_Opcode;
+
+/** Returns the name of an opcode */
+const char *wsky_Opcode_toString(wsky_Opcode opcode);
+
+/** Returns the number of operands of an opcode */
+unsigned wsky_Opcode_getOperandCount(wsky_Opcode opcode);
+
+
+/** An entry of the constant table */
+typedef union {
+  wsky_int intValue;
+  wsky_float floatValue;
+
+  /** A string or a symbol */
+  const char *stringValue;
+
+  const wsky_ASTNode *node;
+} wsky_BytecodeConstant;
+
+
+/** A compiled piece of code */
+typedef struct {
+  uint32_t *code;
+  unsigned length;
+  unsigned capacity;
+
+  wsky_BytecodeConstant *constants;
+  unsigned constantCount;
+  unsigned constantCapacity;
+
+  /** The maximum number of values pushed on the stack by the code */
+  unsigned maxStackSize;
+} wsky_Bytecode;
+
+
+/**
+ * Compiles code which evaluates a node and returns its value.
+ */
+wsky_Bytecode *wsky_Bytecode_compile(const wsky_ASTNode *node);
+
+/**
+ * Compiles the body of a function. The code is run in the scope
+ * of the call, where the parameters are already declared.
+ */
+wsky_Bytecode *wsky_Bytecode_compileFunction(const wsky_FunctionNode *node);
+
+void wsky_Bytecode_delete(wsky_Bytecode *bytecode);
+
+/** Prints a disassembly of the bytecode */
+void wsky_Bytecode_print(const wsky_Bytecode *bytecode, FILE *output);
+
+/**
+ * @}
+ */
+
+#endif /* !BYTECODE_H_ */
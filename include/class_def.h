@@ -25,6 +25,12 @@ typedef struct wsky_ClassDef_s {
   /** The name of the class */
   const char *name;
 
+  /**
+   * The size of the objects of the class, or 0 to use the size of
+   * the objects of the superclass
+   */
+  size_t objectSize;
+
   /** False if another class can extend this class */
   bool final;
 
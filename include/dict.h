@@ -2,6 +2,9 @@
 # define DICT_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "symbol.h"
 
 /**
  * @defgroup Dict Dict
@@ -15,10 +18,31 @@ typedef struct wsky_DictEntry_s wsky_DictEntry;
 
 /**
  * A dictionnary which maps keys to values
+ *
+ * This is an open-addressing hash table. The keys are interned symbols
+ * (see symbol.h) and are compared by pointer. The entries are stored in
+ * a dense array, in insertion order, with their hashes. An index table
+ * is only built when the dictionnary grows beyond a few entries, smaller
+ * ones are scanned linearly.
  */
 typedef struct wsky_Dict_s {
   /** Private member, don't use it */
-  wsky_DictEntry *first;
+  wsky_DictEntry *entries;
+
+  /** Private member, don't use it */
+  uint32_t *indices;
+
+  /** Private member, don't use it */
+  uint32_t entryCount;
+
+  /** Private member, don't use it */
+  uint32_t entryCapacity;
+
+  /** Private member, don't use it */
+  uint32_t removedCount;
+
+  /** Private member, don't use it */
+  uint32_t indexCapacity;
 
 } wsky_Dict;
 
@@ -52,33 +76,57 @@ void wsky_Dict_free(wsky_Dict *self);
 void wsky_Dict_delete(wsky_Dict *self);
 
 /**
- * Applies a function on each element of the dictionnary.
+ * Applies a function on each element of the dictionnary, in insertion
+ * order.
+ * The function must not add or remove entries.
  */
 void wsky_Dict_apply(wsky_Dict *self,
                      void (*function)(const char *key, void *value));
 
 /**
- * Applies a function on each element of the dictionnary.
+ * Applies a function on each element of the dictionnary, in insertion
+ * order.
  */
 void wsky_Dict_applyConst(const wsky_Dict *self,
                           void (*function)(const char *key, void *value));
 
+/**
+ * Returns the number of entries.
+ */
+size_t wsky_Dict_getCount(const wsky_Dict *self);
+
 /**
  * Returns `true` if the dictionnary contain an entry with the given key.
  */
 bool wsky_Dict_contains(const wsky_Dict *self, const char *key);
 
+/**
+ * Like wsky_Dict_contains(), but with a key which is already a symbol.
+ */
+bool wsky_Dict_containsSymbol(const wsky_Dict *self, wsky_Symbol key);
+
 /**
  * Sets a value to a given key.
  * Creates a new entry if the value does not exists.
+ * The key is interned.
  */
 void wsky_Dict_set(wsky_Dict *self, const char *key, void *value);
 
+/**
+ * Like wsky_Dict_set(), but with a key which is already a symbol.
+ */
+void wsky_Dict_setSymbol(wsky_Dict *self, wsky_Symbol key, void *value);
+
 /**
  * Returns the value for a key.
  * Returns NULL if there is no entry with the given key.
  */
-void *wsky_Dict_get(wsky_Dict *self, const char *key);
+void *wsky_Dict_get(const wsky_Dict *self, const char *key);
+
+/**
+ * Like wsky_Dict_get(), but with a key which is already a symbol.
+ */
+void *wsky_Dict_getSymbol(const wsky_Dict *self, wsky_Symbol key);
 
 /**
  * Removes an entry from a dictionnary.
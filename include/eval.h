@@ -3,6 +3,7 @@
 
 #include "ast.h"
 #include "objects/scope.h"
+#include "template.h"
 
 wsky_Result wsky_doBinaryOperation(wsky_Value left,
                                    wsky_Operator operator,
@@ -25,6 +26,18 @@ wsky_Result wsky_evalFile(const char *filePath, wsky_Scope *scope);
 
 wsky_Result wsky_evalModuleFile(const char *filePath);
 
+/**
+ * Renders a template into an output. A streamed output is flushed.
+ *
+ * @param scope The root scope or NULL. It is pushed and poped.
+ */
+wsky_Result wsky_evalTemplateString(const char *source, wsky_Scope *scope,
+                                    wsky_TemplateOutput *output);
+
+/** Like wsky_evalTemplateString(), with the path of a template file */
+wsky_Result wsky_evalTemplateFile(const char *filePath, wsky_Scope *scope,
+                                  wsky_TemplateOutput *output);
+
 /**
  * For the garbage collector.
  */
@@ -0,0 +1,131 @@
+#ifndef FILE_CACHE_H_
+# define FILE_CACHE_H_
+
+# include <stdbool.h>
+# include <stddef.h>
+# include <stdint.h>
+# include "ast.h"
+# include "bytecode.h"
+# include "objects/program_file.h"
+
+/**
+ * @defgroup FileCache FileCache
+ * @{
+ *
+ * The parsed programs and templates, kept between the evaluations of
+ * the same files.
+ *
+ * An entry is identified by the absolute path of its file, and by
+ * whether the file is a template. It is valid while the file has the
+ * same modification time, size and inode. When the cache is full, the
+ * least recently used entries are removed.
+ *
+ * The entries are retained while they are evaluated. An entry which is
+ * removed while it is retained is deleted when it is released.
+ */
+
+/** The state of a file when it has been read */
+typedef struct {
+  /** The modification time in nanoseconds */
+  int64_t modificationTime;
+
+  int64_t size;
+  uint64_t inode;
+  uint64_t device;
+} wsky_FileStamp;
+
+typedef struct wsky_CachedFile_s wsky_CachedFile;
+
+/** An entry of the cache */
+struct wsky_CachedFile_s {
+
+  /** The file, with its absolute path */
+  wsky_ProgramFile *file;
+
+  /** True if the file is a template */
+  bool template;
+
+  /** The state of the file before it has been read */
+  wsky_FileStamp stamp;
+
+  /** The resolved program */
+  wsky_ASTNode *node;
+
+  /** The compiled program, or NULL until it is run by the VM */
+  wsky_Bytecode *bytecode;
+
+  /** The number of evaluations of the entry which are running */
+  unsigned useCount;
+
+  /** True if the entry is no longer in the cache */
+  bool removed;
+
+  /** The more recently used entry */
+  wsky_CachedFile *previous;
+
+  /** The less recently used entry */
+  wsky_CachedFile *next;
+};
+
+/** The default maximum number of entries */
+# define wsky_FileCache_DEFAULT_CAPACITY 64
+
+/**
+ * Reads the state of a file. Returns false if the file cannot be
+ * accessed.
+ */
+bool wsky_FileStamp_read(wsky_FileStamp *stamp, const char *path);
+
+/**
+ * Returns the entry of a file if it has the given state, or NULL. An
+ * entry with another state is removed.
+ */
+wsky_CachedFile *wsky_FileCache_find(const char *absolutePath,
+                                     bool template,
+                                     const wsky_FileStamp *stamp);
+
+/**
+ * Adds a new entry, which takes the node. The least recently used
+ * entries are removed if the cache is full.
+ *
+ * @param stamp The state of the file before it has been read
+ */
+wsky_CachedFile *wsky_FileCache_add(wsky_ProgramFile *file,
+                                    bool template,
+                                    const wsky_FileStamp *stamp,
+                                    wsky_ASTNode *node);
+
+/** Prevents an entry from being deleted while it is used */
+void wsky_FileCache_retain(wsky_CachedFile *entry);
+
+/** Releases an entry, which is deleted if it has been removed */
+void wsky_FileCache_release(wsky_CachedFile *entry);
+
+/**
+ * Sets the maximum number of entries and removes the least recently
+ * used ones. 0 disables the cache.
+ */
+void wsky_FileCache_setCapacity(size_t capacity);
+
+size_t wsky_FileCache_getCapacity(void);
+
+/** Returns the number of entries */
+size_t wsky_FileCache_getSize(void);
+
+/** Returns the number of files found in the cache */
+size_t wsky_FileCache_getHitCount(void);
+
+/** Returns the number of files which were not in the cache */
+size_t wsky_FileCache_getMissCount(void);
+
+/** Removes all the entries */
+void wsky_FileCache_clear(void);
+
+/** Visits the files of the entries, for the garbage collector */
+void wsky_FileCache_visit(void);
+
+/**
+ * @}
+ */
+
+#endif /* !FILE_CACHE_H_ */
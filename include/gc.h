@@ -1,7 +1,9 @@
 #ifndef WSKY_GC_H_
 # define WSKY_GC_H_
 
+# include <stddef.h>
 # include "value.h"
+# include "objects/object.h"
 
 /** Don't call this function directly. */
 void wsky_GC_initImpl(void *stackStart);
@@ -18,8 +20,29 @@ static inline void wsky_GC_init(void) {
 
 void wsky_GC_unmarkAll(void);
 
+/** Performs a full collection */
 void wsky_GC_collect(void);
 
+/**
+ * Performs a minor collection: only the objects allocated since the
+ * previous collection are collected, the survivors are promoted.
+ */
+void wsky_GC_collectYoung(void);
+
+/**
+ * Sweeps at most the given number of pages after a full collection.
+ *
+ * The sweep is lazy: the pages are swept by the allocation when needed.
+ * This function lets the host spread the remaining work, for example
+ * between two requests.
+ *
+ * Returns true if there is nothing left to sweep.
+ */
+bool wsky_GC_sweep(size_t pageCount);
+
+/** Sweeps all the remaining pages */
+void wsky_GC_finishSweep(void);
+
 void wsky_GC_deleteAll(void);
 
 void wsky_GC_autoCollect(void);
@@ -28,15 +51,56 @@ void wsky_GC_autoCollect(void);
  * Requests a garbage collection.
  *
  * If the stress mode is disabled, the garbage collection
- * is performed only if needed.
+ * is performed only if the allocated bytes have reached the threshold
+ * computed after the previous collection.
  * If the stress mode is enabled, the garbage collection
  * is performed in anyway.
  */
 void wsky_GC_requestCollection(void);
 
-void wsky_GC_visitObject(void *object);
+/** Don't call this function directly. */
+void wsky_GC_visitObjectImpl(void *reference);
+
+/** Don't call this function directly. */
+void wsky_GC_visitValueImpl(wsky_Value *reference);
+
+/**
+ * Visits a reference to an object, which may be NULL.
+ *
+ * The argument must be the field or the variable which holds the
+ * reference: it is updated if the object is moved by a compaction.
+ */
+# define wsky_GC_visitObject(object) wsky_GC_visitObjectImpl(&(object))
+
+/** Like wsky_GC_visitObject(), with a value */
+# define wsky_GC_visitValue(value) wsky_GC_visitValueImpl(&(value))
+
+
+/**
+ * Adds an old object to the remembered set. The children of the
+ * remembered objects are visited by the minor collections.
+ */
+void wsky_GC_remember(wsky_Object *object);
+
+/**
+ * The write barrier. Must be called when an object is stored into an
+ * object which may have survived a collection.
+ *
+ * @param owner The object which holds the reference
+ * @param object The stored object, or NULL
+ */
+static inline void wsky_GC_writeBarrierObject(void *owner, void *object) {
+  wsky_Object *o = (wsky_Object *)owner;
+  wsky_Object *stored = (wsky_Object *)object;
+  if (o->_gcOld && !o->_gcRemembered && stored && !stored->_gcOld)
+    wsky_GC_remember(o);
+}
 
-void wsky_GC_visitValue(wsky_Value v);
+/** Like wsky_GC_writeBarrierObject(), with a value */
+static inline void wsky_GC_writeBarrier(void *owner, wsky_Value value) {
+  if (wsky_Value_getType(value) == wsky_Type_OBJECT)
+    wsky_GC_writeBarrierObject(owner, wsky_Value_toObject(value));
+}
 
 
 /**
@@ -55,4 +119,147 @@ void wsky_GC_setStressed(bool stressed);
 bool wsky_GC_isStressed(void);
 
 
+/**
+ * Performs a full collection and compacts the heaps.
+ *
+ * The objects of the sparse pages are moved to the other pages of their
+ * size class, the references to them are updated, and the heaps which
+ * become empty are released. The pages which contain an object
+ * referenced from the C stack or the registers are pinned, even in
+ * precise mode.
+ */
+void wsky_GC_compact(void);
+
+/**
+ * Sets the compacting mode. If enabled, the automatic full collections
+ * compact the heaps.
+ */
+void wsky_GC_setCompacting(bool compacting);
+
+/** Returns true if the compacting mode is enabled */
+bool wsky_GC_isCompacting(void);
+
+
+/**
+ * Sets the precise mode.
+ *
+ * In precise mode, the C stack and the registers are not scanned: the
+ * only roots are the builtins, the scopes, the stack of the virtual
+ * machine and the handles (see handle.h). The collections requested by
+ * the allocations are deferred to the next safepoint.
+ */
+void wsky_GC_setPrecise(bool precise);
+
+/** Returns true if the precise mode is enabled */
+bool wsky_GC_isPrecise(void);
+
+/**
+ * A point where a collection can happen in precise mode: all the values
+ * used by the callers are reachable from the roots.
+ *
+ * Performs the pending collection, if any.
+ */
+void wsky_GC_safepoint(void);
+
+
+/** The default growth factor of the heap */
+# define wsky_GC_DEFAULT_GROWTH_FACTOR 2.0
+
+/** The default minimum threshold, in bytes */
+# define wsky_GC_DEFAULT_MINIMUM_THRESHOLD ((size_t)1 << 20)
+
+/**
+ * Sets the growth factor of the heap.
+ *
+ * After a collection, the next one is triggered when the allocated
+ * bytes reach the live bytes multiplied by this factor, which must be
+ * greater than 1.
+ */
+void wsky_GC_setGrowthFactor(double factor);
+
+/** Returns the growth factor of the heap */
+double wsky_GC_getGrowthFactor(void);
+
+/**
+ * Sets the minimum number of allocated bytes which triggers
+ * a collection.
+ */
+void wsky_GC_setMinimumThreshold(size_t bytes);
+
+/** Returns the minimum threshold, in bytes */
+size_t wsky_GC_getMinimumThreshold(void);
+
+
+/** The default maximum number of entries of the mark stack */
+# define wsky_GC_DEFAULT_MARK_STACK_LIMIT ((size_t)1 << 20)
+
+/**
+ * Sets the maximum number of entries of the mark stack.
+ *
+ * When the mark stack is full, the marking goes on by rescanning the
+ * heaps for marked objects whose children are not marked.
+ */
+void wsky_GC_setMarkStackLimit(size_t limit);
+
+/** Returns the maximum number of entries of the mark stack */
+size_t wsky_GC_getMarkStackLimit(void);
+
+
+/** Statistics about the garbage collector */
+typedef struct {
+
+  /** The number of collections since wsky_start() */
+  size_t collectionCount;
+
+  /** The number of minor collections since wsky_start() */
+  size_t minorCollectionCount;
+
+  /** The total time spent in collections, in seconds */
+  double totalPauseTime;
+
+  /** The duration of the last collection, in seconds */
+  double lastPauseTime;
+
+  /** The duration of the longest collection, in seconds */
+  double maxPauseTime;
+
+  /** The number of objects which survived the last collection */
+  size_t liveObjectCount;
+
+  /** The bytes used by the objects which survived the last collection */
+  size_t liveBytes;
+
+  /** The number of allocated objects, reachable or not */
+  size_t objectCount;
+
+  /** The bytes used by the allocated objects, reachable or not */
+  size_t allocatedBytes;
+
+  /** The size of the heaps, in bytes */
+  size_t heapSize;
+
+  /**
+   * The bytes of the live and the young objects which will trigger the
+   * next collection
+   */
+  size_t threshold;
+
+  /** The number of times the mark stack has overflowed */
+  size_t markStackOverflowCount;
+
+  /** The number of pages which have not been swept yet */
+  size_t unsweptPageCount;
+
+  /** The number of compactions since wsky_start() */
+  size_t compactionCount;
+
+  /** The number of objects moved by the compactions */
+  size_t movedObjectCount;
+
+} wsky_GC_Stats;
+
+/** Fills the given structure with the current statistics */
+void wsky_GC_getStats(wsky_GC_Stats *stats);
+
+
 #endif /* !WSKY_GC_H_ */
@@ -0,0 +1,65 @@
+#ifndef HANDLE_H_
+# define HANDLE_H_
+
+# include "value.h"
+
+/**
+ * @defgroup Handle Handle
+ * @{
+ *
+ * Precise roots for the values held by C code.
+ *
+ * A handle is a slot of a shadow stack which is visited by the garbage
+ * collector. C code which keeps a value in a local variable while
+ * Whiskey code may run (a call of a function, a method or an operator)
+ * stores it in a handle. The handles are released by scopes:
+ *
+ *     wsky_HandleScope handleScope;
+ *     wsky_HandleScope_open(&handleScope);
+ *     wsky_Value *largest = wsky_Handle_new(parameters[0]);
+ *     ...
+ *     wsky_Value result = *largest;
+ *     wsky_HandleScope_close(&handleScope);
+ *
+ * The handles are required in the precise mode of the garbage collector,
+ * where the C stack is not scanned.
+ */
+
+/** The state of the shadow stack when a handle scope has been opened */
+typedef struct {
+  struct wsky_HandleChunk_s *chunk;
+  size_t count;
+} wsky_HandleScope;
+
+/** Opens a handle scope */
+void wsky_HandleScope_open(wsky_HandleScope *scope);
+
+/**
+ * Closes a handle scope and releases the handles created since it has
+ * been opened. The scopes must be closed in the reverse order.
+ */
+void wsky_HandleScope_close(wsky_HandleScope *scope);
+
+/**
+ * Creates a handle in the current handle scope.
+ *
+ * The returned pointer is valid until the scope is closed.
+ */
+wsky_Value *wsky_Handle_new(wsky_Value value);
+
+/**
+ * Creates an array of consecutive handles, initialized to `null`.
+ */
+wsky_Value *wsky_Handle_newArray(size_t count);
+
+/** Visits the values of all the handles. Called by the garbage collector */
+void wsky_Handle_visitAll(void);
+
+/** Frees the shadow stack. Called by wsky_stop() */
+void wsky_Handle_freeAll(void);
+
+/**
+ * @}
+ */
+
+#endif /* !HANDLE_H_ */
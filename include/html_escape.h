@@ -0,0 +1,48 @@
+#ifndef HTML_ESCAPE_H_
+# define HTML_ESCAPE_H_
+
+# include <stddef.h>
+
+/**
+ * @defgroup HtmlEscape HtmlEscape
+ * @{
+ *
+ * The escaping of the values printed by the templates.
+ *
+ * The characters `<`, `>`, `&`, `"` and `'` are replaced by entities.
+ * The other bytes are copied in runs, which are found 32 or 16 bytes at
+ * a time with AVX2 or SSE2 when the compiler targets them.
+ */
+
+/**
+ * Returns the index of the first byte which must be escaped, or the
+ * length if there is none.
+ */
+size_t wsky_html_findSpecial(const char *bytes, size_t length);
+
+/**
+ * Returns the entity of a byte, or NULL if the byte is not escaped.
+ *
+ * @param length Set to the length of the entity
+ */
+const char *wsky_html_getEntity(char c, size_t *length);
+
+/** Returns the length of some bytes once escaped */
+size_t wsky_html_getEscapedLength(const char *bytes, size_t length);
+
+/**
+ * Escapes some bytes. Returns the end of the escaped bytes.
+ *
+ * @param dest A buffer of at least wsky_html_getEscapedLength() bytes,
+ * which is not null-terminated
+ */
+char *wsky_html_escape(char *dest, const char *bytes, size_t length);
+
+/** Returns the name of the scanner used: "avx2", "sse2" or "scalar" */
+const char *wsky_html_getScannerName(void);
+
+/**
+ * @}
+ */
+
+#endif /* !HTML_ESCAPE_H_ */
@@ -0,0 +1,129 @@
+#ifndef INLINE_CACHE_H_
+# define INLINE_CACHE_H_
+
+# include <stddef.h>
+# include "value.h"
+
+/**
+ * @defgroup InlineCache InlineCache
+ * @{
+ *
+ * Inline caches of the method lookups.
+ *
+ * An inline cache is stored in the node of a member access. It remembers
+ * the methods found for the last classes of the objects accessed by
+ * the node, so that the superclass chain is not searched again.
+ *
+ * An entry is valid while the version of its class is unchanged. The
+ * versions are unique among all the classes, so an entry never matches
+ * a new class allocated at the address of a dead one. The classes are
+ * not visited by the garbage collector through the caches.
+ *
+ * The cache also remembers the index of the last field accessed by the
+ * node, for the shape of the object.
+ */
+
+struct wsky_Method_s;
+struct wsky_ObjectFields_s;
+struct wsky_Shape_s;
+
+/** The number of classes remembered by an inline cache */
+# define wsky_InlineCache_SIZE 4
+
+/** An entry of an inline cache */
+typedef struct {
+
+  /** The class or NULL if the entry is empty */
+  const wsky_Class *class;
+
+  /** The version of the class when the method has been found */
+  unsigned version;
+
+  /** The method or the getter, or NULL if the class has none */
+  struct wsky_Method_s *method;
+
+} wsky_InlineCacheEntry;
+
+/** The last field accessed through an inline cache */
+typedef struct {
+
+  /** The identifier of the shape of the object, 0 if the cache is empty */
+  unsigned shapeId;
+
+  /** The class which declares the field */
+  const wsky_Class *class;
+
+  /**
+   * The shape of the object after an assignment. It differs from the
+   * shape of the object if the assignment adds the field.
+   */
+  const struct wsky_Shape_s *newShape;
+
+  /** The index of the field */
+  unsigned index;
+
+} wsky_FieldCache;
+
+/**
+ * An inline cache. It is monomorphic while it holds one class, and
+ * polymorphic up to wsky_InlineCache_SIZE classes. Then the entries are
+ * replaced in turn.
+ *
+ * The node of an assignment target caches setters instead of getters.
+ */
+typedef struct {
+  wsky_InlineCacheEntry entries[wsky_InlineCache_SIZE];
+
+  /** The index of the next entry to replace */
+  unsigned next;
+
+  wsky_FieldCache field;
+} wsky_InlineCache;
+
+/** Empties an inline cache */
+void wsky_InlineCache_init(wsky_InlineCache *cache);
+
+/**
+ * Finds a method or a getter in a class and its superclasses, like
+ * wsky_Class_findMethodOrGetter(), and remembers it in the cache.
+ */
+struct wsky_Method_s *wsky_InlineCache_findMethodOrGetter(
+  wsky_InlineCache *cache, wsky_Class *class, const char *name);
+
+/** Like wsky_Class_findSetter(), and remembers the setter in the cache */
+struct wsky_Method_s *wsky_InlineCache_findSetter(
+  wsky_InlineCache *cache, wsky_Class *class, const char *name);
+
+/**
+ * Returns a pointer to a field of an object, or NULL if it has no such
+ * field.
+ *
+ * @param class The class which declares the field
+ */
+wsky_Value *wsky_InlineCache_getField(wsky_InlineCache *cache,
+                                      struct wsky_ObjectFields_s *fields,
+                                      const wsky_Class *class,
+                                      const char *name);
+
+/**
+ * Sets a field of an object, which is added if needed.
+ *
+ * @param class The class which declares the field
+ */
+void wsky_InlineCache_setField(wsky_InlineCache *cache,
+                               struct wsky_ObjectFields_s *fields,
+                               const wsky_Class *class,
+                               const char *name,
+                               wsky_Value value);
+
+/** Returns the number of lookups found in a cache */
+size_t wsky_InlineCache_getHitCount(void);
+
+/** Returns the number of lookups which were not in a cache */
+size_t wsky_InlineCache_getMissCount(void);
+
+/**
+ * @}
+ */
+
+#endif /* !INLINE_CACHE_H_ */
@@ -22,4 +22,14 @@ static inline void wsky_free(void *data) {
   free(data);
 }
 
+/**
+ * Allocates memory directly from the system, with mmap() if available,
+ * or returns NULL. The size should be a multiple of the page size of
+ * the system.
+ */
+void *wsky_allocatePages(size_t size);
+
+/** Returns memory allocated by wsky_allocatePages() to the system */
+void wsky_freePages(void *pages, size_t size);
+
 #endif /* MEMORY_H */
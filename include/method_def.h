@@ -108,7 +108,10 @@ typedef struct wsky_MethodDef_s {
   /** The name of the method. */
   const char *name;
 
-  /** The parameter count, or -1 if variable parameter count. */
+  /**
+   * The parameter count, at most 8, or -1 if variable parameter count.
+   * The variadic methods get a pointer to the parameters of the caller.
+   */
   int parameterCount;
 
   /** The flags */
@@ -17,7 +17,7 @@ extern const wsky_ClassDef wsky_Boolean_CLASS_DEF;
 extern wsky_Class *wsky_Boolean_CLASS;
 
 static inline bool wsky_isBoolean(wsky_Value value) {
-  return value.type == wsky_Type_BOOL;
+  return wsky_Value_getType(value) == wsky_Type_BOOL;
 }
 
 /**
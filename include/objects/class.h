@@ -4,6 +4,7 @@
 # include "object.h"
 # include "method.h"
 # include "dict.h"
+# include "inline_cache.h"
 
 
 extern const wsky_ClassDef wsky_Class_CLASS_DEF;
@@ -16,7 +17,7 @@ struct wsky_Class_s {
   wsky_OBJECT_HEAD
 
   /** The name of the class */
-  char *name;
+  wsky_Symbol name;
 
   /** True if the class is written in C */
   bool native;
@@ -41,6 +42,19 @@ struct wsky_Class_s {
 
   /** The accept function, used by the garbage collector */
   wsky_GCAcceptFunction gcAcceptFunction;
+
+  /** The size of the objects of the class */
+  size_t objectSize;
+
+  /** The empty shape of the objects, the root of the tree of their shapes */
+  struct wsky_Shape_s *shape;
+
+  /**
+   * Changed when a method is added, to invalidate the inline caches.
+   * The methods of a class are added before the class can be extended,
+   * so the version also stands for the methods of the superclasses.
+   */
+  unsigned version;
 };
 
 
@@ -48,6 +62,9 @@ wsky_Class *wsky_Class_new(const char *name, wsky_Class *super);
 wsky_Class *wsky_Class_newFromC(const wsky_ClassDef *def, wsky_Class *super);
 void wsky_Class_initMethods(wsky_Class *class, const wsky_ClassDef *def);
 
+/** Gives a new version to the class, unique among all the classes */
+void wsky_Class_updateVersion(wsky_Class *class);
+
 static inline bool wsky_isClass(wsky_Value value) {
   return wsky_getClass(value) == wsky_Class_CLASS;
 }
@@ -78,6 +95,20 @@ wsky_Result wsky_Class_getPrivate(wsky_Class *class,
                                        wsky_Object *self,
                                        const char *attribute);
 
+/** Like wsky_Class_get(), but looks up the method through a cache */
+wsky_Result wsky_Class_getCached(wsky_Class *class, wsky_Object *self,
+                                 const char *attribute,
+                                 wsky_InlineCache *cache);
+
+/**
+ * Like wsky_Class_getPrivate(), but looks up the method and the field
+ * through a cache
+ */
+wsky_Result wsky_Class_getPrivateCached(wsky_Class *class,
+                                        wsky_Object *self,
+                                        const char *attribute,
+                                        wsky_InlineCache *cache);
+
 
 
 wsky_Result wsky_Class_setField(wsky_Class *class, wsky_Object *self,
@@ -97,6 +128,22 @@ wsky_Result wsky_Class_setPrivate(wsky_Class *class,
                                        const char *attribute,
                                        wsky_Value value);
 
+/** Like wsky_Class_set(), but looks up the setter through a cache */
+wsky_Result wsky_Class_setCached(wsky_Class *class, wsky_Object *self,
+                                 const char *attribute,
+                                 wsky_Value value,
+                                 wsky_InlineCache *cache);
+
+/**
+ * Like wsky_Class_setPrivate(), but looks up the setter and the field
+ * through a cache
+ */
+wsky_Result wsky_Class_setPrivateCached(wsky_Class *class,
+                                        wsky_Object *self,
+                                        const char *attribute,
+                                        wsky_Value value,
+                                        wsky_InlineCache *cache);
+
 
 
 /** Finds a method or a getter in this class, not in the superclasses */
@@ -4,6 +4,7 @@
 # include "object.h"
 # include "class_def.h"
 # include "ast.h"
+# include "bytecode.h"
 # include "eval.h"
 
 /**
@@ -27,7 +28,7 @@ typedef struct wsky_Function_s {
   wsky_OBJECT_HEAD
 
   /** The name of the function or NULL if anonymous */
-  char *name;
+  wsky_Symbol name;
 
   /**
    * The 'external' scope where the function is defined, or NULL if
@@ -36,11 +37,17 @@ typedef struct wsky_Function_s {
   wsky_Scope *globalScope;
 
   /**
-   * The duplicated AST node of the function, or NULL if the function
-   * is written in C
+   * The AST node of the function, shared with the tree and the other
+   * functions created from it, or NULL if the function is written in C
    */
   wsky_FunctionNode *node;
 
+  /**
+   * The bytecode of the body, compiled on the first call by the
+   * virtual machine, or NULL
+   */
+  wsky_Bytecode *bytecode;
+
   /** The underlying C method definition */
   wsky_MethodDef cMethod;
 } wsky_Function;
@@ -62,6 +69,23 @@ wsky_Function *wsky_Function_newFromWsky(const char *name,
  */
 wsky_Function *wsky_Function_newFromC(const wsky_MethodDef *def);
 
+/**
+ * Returns the bytecode of a Whiskey function, compiling it if needed.
+ */
+const wsky_Bytecode *wsky_Function_getBytecode(wsky_Function *function);
+
+/**
+ * Creates the scope of a call of a Whiskey function and declares
+ * the parameters in it.
+ *
+ * Raises a ParameterError if the parameter count is invalid.
+ */
+wsky_Result wsky_Function_newCallScope(wsky_Function *function,
+                                       wsky_Class *class,
+                                       wsky_Object *self,
+                                       unsigned parameterCount,
+                                       const wsky_Value *parameters);
+
 /** Calls a function as a method */
 wsky_Result wsky_Function_callSelf(wsky_Function *function,
                                         wsky_Class *class,
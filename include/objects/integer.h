@@ -17,7 +17,7 @@ extern const wsky_ClassDef wsky_Integer_CLASS_DEF;
 extern wsky_Class *wsky_Integer_CLASS;
 
 static inline bool wsky_isInteger(wsky_Value value) {
-  return value.type == wsky_Type_INT;
+  return wsky_Value_getType(value) == wsky_Type_INT;
 }
 
 /**
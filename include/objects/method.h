@@ -15,7 +15,7 @@ typedef struct wsky_Method_s {
   wsky_OBJECT_HEAD
 
   /** The name of the method. */
-  char *name;
+  wsky_Symbol name;
 
   /** The class where the method is defined. */
   wsky_Class *defClass;
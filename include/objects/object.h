@@ -22,6 +22,11 @@
  *
  * `_gcMark`: Used by the garbage collector only.
  *
+ * `_gcOld`: True if the object has survived a collection.
+ *
+ * `_gcRemembered`: True if the object is in the remembered set of the
+ * garbage collector.
+ *
  * `_initialized`: Used by the garbage collector and some strange stuff.
  *
  */
@@ -34,31 +39,69 @@
   bool _gcMark;                                 \
                                                 \
   /** True if the object is initialized */      \
-  bool _initialized;
+  bool _initialized;                            \
+                                                \
+  /** Used by the garbage collector only. */    \
+  bool _gcOld;                                  \
+                                                \
+  /** Used by the garbage collector only. */    \
+  bool _gcRemembered;
 
 
 /**
- * Represents the private fields of an object.
+ * Represents the private fields of an object, declared by its class and
+ * by its non-native superclasses.
  */
 typedef struct wsky_ObjectFields_s {
 
-  /**
-   * The fields of the superclass or NULL if the
-   * superclass is native
-   */
-  struct wsky_ObjectFields_s *parent;
+  /** The shape, which gives the index of each field */
+  const struct wsky_Shape_s *shape;
+
+  /** The values of the fields, or NULL if there is no field */
+  wsky_Value *values;
 
-  /** A dictionnary of the fields */
-  wsky_Dict fields;
+  /** The capacity of the array of values */
+  unsigned capacity;
 
 } wsky_ObjectFields;
 
 
+/** Initializes the fields of an object of the given class */
+void wsky_ObjectFields_init(wsky_ObjectFields *fields,
+                            const wsky_Class *class);
+
 /** For garbage collection */
 void wsky_ObjectFields_acceptGc(wsky_ObjectFields *fields);
 
 void wsky_ObjectFields_free(wsky_ObjectFields *fields);
 
+/**
+ * Returns a pointer to a field or NULL.
+ *
+ * @param class The class which declares the field
+ */
+wsky_Value *wsky_ObjectFields_get(wsky_ObjectFields *fields,
+                                  const wsky_Class *class,
+                                  wsky_Symbol name);
+
+/**
+ * Sets a field, which is added if needed.
+ *
+ * @param class The class which declares the field
+ */
+void wsky_ObjectFields_set(wsky_ObjectFields *fields,
+                           const wsky_Class *class,
+                           wsky_Symbol name,
+                           wsky_Value value);
+
+/**
+ * Adds a field to an object which has the given shape, and returns the
+ * value of the new field, which must be set. The field must be the one
+ * added by the transition from the current shape to the new one.
+ */
+wsky_Value *wsky_ObjectFields_add(wsky_ObjectFields *fields,
+                                  const struct wsky_Shape_s *newShape);
+
 /** For debugging purposes */
 void wsky_ObjectFields_print(wsky_ObjectFields *fields,
                              const wsky_Class *class);
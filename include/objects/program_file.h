@@ -17,6 +17,60 @@ extern const wsky_ClassDef wsky_ProgramFile_CLASS_DEF;
 extern wsky_Class *wsky_ProgramFile_CLASS;
 
 
+/**
+ * The content of a file. It is shared by the file and by the HTML nodes
+ * of its templates, which refer to slices of it and may outlive the
+ * file.
+ *
+ * The files are read, or mapped in memory read-only if the mappings
+ * have been enabled with wsky_FileContent_setMappingEnabled().
+ */
+typedef struct wsky_FileContent_s {
+
+  /** The number of owners */
+  unsigned referenceCount;
+
+  /** The length of the string */
+  size_t length;
+
+  /** The null-terminated string, which is never modified */
+  const char *string;
+
+  /** True if the string is mapped instead of being allocated */
+  bool mapped;
+} wsky_FileContent;
+
+/** Returns a new content with one owner, which takes the string */
+wsky_FileContent *wsky_FileContent_new(char *string, size_t length);
+
+/**
+ * Enables or disables the mapping of the large files loaded afterwards.
+ * The mappings are disabled by default.
+ *
+ * A content lives as long as its file, its cache entry and the functions
+ * defined by the file. If a mapped file is truncated in place meanwhile
+ * (like by `cat > file`), reading its content raises SIGBUS and kills
+ * the process. Enable the mappings only if the files are never
+ * truncated while they are used, for example if they are replaced with
+ * rename().
+ */
+void wsky_FileContent_setMappingEnabled(bool enabled);
+
+bool wsky_FileContent_isMappingEnabled(void);
+
+/**
+ * Loads the content of a file with a single mapping or a single read.
+ * Returns NULL if the file cannot be read or contains a null byte.
+ */
+wsky_FileContent *wsky_FileContent_load(const char *path);
+
+/** Adds an owner to a content and returns it */
+wsky_FileContent *wsky_FileContent_retain(wsky_FileContent *content);
+
+/** Removes an owner from a content, which is freed if it has none */
+void wsky_FileContent_release(wsky_FileContent *content);
+
+
 /**
  * A ProgramFile.
  *
@@ -39,8 +93,11 @@ typedef struct wsky_ProgramFile_s {
    */
   char *directoryPath;
 
-  /** The content of the file or NULL */
-  char *content;
+  /** The content of the file or NULL, the string of `source` */
+  const char *content;
+
+  /** The shared content of the file or NULL */
+  wsky_FileContent *source;
 } wsky_ProgramFile;
 
 
@@ -31,9 +31,21 @@ typedef struct wsky_Scope_s {
   /** The parent scope or NULL */
   struct wsky_Scope_s *parent;
 
-  /** A dictionnary of the variables */
+  /** A dictionnary of the variables declared by name */
   wsky_Dict variables;
 
+  /**
+   * The variables assigned to slots by the resolver. They are stored
+   * in a single block with their names.
+   */
+  wsky_Value *slots;
+
+  /** The names of the slots, NULL if the slot is not declared yet */
+  wsky_Symbol *slotNames;
+
+  /** The number of slots */
+  unsigned slotCount;
+
   /**
    * The current class or NULL.
    * Don't mix up it with `class`. The class of a scope object is
@@ -58,6 +70,12 @@ typedef struct wsky_Scope_s {
 wsky_Scope *wsky_Scope_new(wsky_Scope *parent, wsky_Class *class,
                            wsky_Object *self);
 
+/**
+ * Creates a new Scope with the given number of variable slots.
+ */
+wsky_Scope *wsky_Scope_newWithSlots(wsky_Scope *parent, wsky_Class *class,
+                                    wsky_Object *self, unsigned slotCount);
+
 /**
  * Creates a new root scope.
  *
@@ -88,6 +106,41 @@ void wsky_Scope_print(const wsky_Scope *scope);
 void wsky_Scope_addVariable(wsky_Scope *scope,
                             const char *name, wsky_Value value);
 
+/**
+ * Declares the variable of a slot.
+ */
+void wsky_Scope_declareSlot(wsky_Scope *scope, unsigned slot,
+                            wsky_Symbol name, wsky_Value value);
+
+/**
+ * Returns true if the variable of the slot has been declared.
+ */
+bool wsky_Scope_isSlotDeclared(const wsky_Scope *scope, unsigned slot);
+
+/**
+ * Returns a pointer to the variable of a slot of a parent scope, or NULL
+ * if the variable is not declared yet.
+ *
+ * @param scope The current scope
+ * @param depth The number of scopes to go up (0 for the current one)
+ * @param slot The slot
+ */
+wsky_Value *wsky_Scope_getSlot(wsky_Scope *scope,
+                               unsigned depth, unsigned slot);
+
+/**
+ * Sets the variable of a slot of a parent scope.
+ *
+ * Returns false if the variable is not declared yet.
+ *
+ * @param scope The current scope
+ * @param depth The number of scopes to go up (0 for the current one)
+ * @param slot The slot
+ * @param value The new value
+ */
+bool wsky_Scope_setSlot(wsky_Scope *scope, unsigned depth, unsigned slot,
+                        wsky_Value value);
+
 /**
  * Looks for a variable and return its value.
  * Calls abort() if the variable is not found.
@@ -30,6 +30,26 @@ struct wsky_String_s {
 
 wsky_String *wsky_String_new(const char *cString);
 
+/**
+ * Returns the shared empty string.
+ *
+ * The shared strings must not be modified. They are created the first
+ * time they are needed, and are roots of the garbage collector.
+ */
+wsky_String *wsky_String_getEmpty(void);
+
+/**
+ * Returns the shared string of a boolean, of `null` or of a small
+ * integer, or NULL if the value has none.
+ */
+wsky_String *wsky_String_getCached(wsky_Value value);
+
+/** Visits the shared strings, for the garbage collector */
+void wsky_String_visitCache(void);
+
+/** Forgets the shared strings, once all the objects are deleted */
+void wsky_String_clearCache(void);
+
 static inline bool wsky_isString(wsky_Value value) {
   return wsky_getClass(value) == wsky_String_CLASS;
 }
@@ -40,6 +40,7 @@ wsky_ParserResult wsky_parseTemplate(wsky_TokenList *tokens);
 wsky_ParserResult wsky_parseString(const char *string);
 wsky_ParserResult wsky_parseTemplateString(const char *string);
 wsky_ParserResult wsky_parseFile(wsky_ProgramFile *file);
+wsky_ParserResult wsky_parseTemplateFile(wsky_ProgramFile *file);
 
 /**
  * @}
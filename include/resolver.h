@@ -0,0 +1,35 @@
+#ifndef RESOLVER_H_
+# define RESOLVER_H_
+
+# include "ast.h"
+
+/**
+ * @defgroup resolver resolver
+ * @{
+ *
+ * The resolver assigns slots to the variables declared in the scopes
+ * created by the evaluator (sequences, function calls and `except`
+ * clauses), and resolves the identifiers to (depth, slot) pairs.
+ *
+ * Identifiers which can't be resolved statically, like the ones declared
+ * in the root scope or declared after a function which uses them, keep a
+ * depth of -1 and are looked up by name at runtime.
+ */
+
+/**
+ * Resolves a node evaluated with wsky_evalNode() in a scope whose
+ * variables are declared by name, like a root scope.
+ */
+void wsky_resolveNode(wsky_ASTNode *node);
+
+/**
+ * Resolves a sequence evaluated with wsky_evalSequence() in a scope
+ * whose variables are declared by name, like a root scope.
+ */
+void wsky_resolveSequence(wsky_SequenceNode *node);
+
+/**
+ * @}
+ */
+
+#endif /* !RESOLVER_H_ */
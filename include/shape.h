@@ -0,0 +1,76 @@
+#ifndef SHAPE_H_
+# define SHAPE_H_
+
+# include "value.h"
+# include "symbol.h"
+
+/**
+ * @defgroup Shape Shape
+ * @{
+ *
+ * The layouts of the fields of the objects.
+ *
+ * The fields of an object are stored in an array of values, and its
+ * shape gives the index of each field. A field is identified by its name
+ * and by the class which declares it, because each class has its own
+ * private fields.
+ *
+ * The shapes of the objects of a class form a tree. Its root is the
+ * empty shape of the class, and each child adds a field to its parent.
+ * Objects whose fields have been added in the same order share the same
+ * shape.
+ */
+
+typedef struct wsky_Shape_s wsky_Shape;
+
+/** A shape, which is never modified once created */
+struct wsky_Shape_s {
+
+  /** The shape without the last field, or NULL if the shape is empty */
+  const wsky_Shape *parent;
+
+  /** The class which declares the last field */
+  const wsky_Class *class;
+
+  /** The name of the last field */
+  wsky_Symbol name;
+
+  /** The number of fields, the index of the last one is this count - 1 */
+  unsigned fieldCount;
+
+  /**
+   * Unique among all the shapes, so that a new shape allocated at the
+   * address of a deleted one is not mistaken for it
+   */
+  unsigned id;
+
+  /** The first shape with one more field */
+  wsky_Shape *children;
+
+  /** The next shape with the same parent */
+  wsky_Shape *next;
+};
+
+/** Returns a new empty shape, the root of a tree */
+wsky_Shape *wsky_Shape_newRoot(void);
+
+/** Deletes a tree of shapes, given its root */
+void wsky_Shape_delete(wsky_Shape *root);
+
+/** Returns the index of a field or -1 if the shape does not have it */
+int wsky_Shape_getIndex(const wsky_Shape *shape,
+                        const wsky_Class *class, wsky_Symbol name);
+
+/**
+ * Returns the shape with one more field, which must not be in the given
+ * shape. The shape is created the first time.
+ */
+const wsky_Shape *wsky_Shape_addField(const wsky_Shape *shape,
+                                      const wsky_Class *class,
+                                      wsky_Symbol name);
+
+/**
+ * @}
+ */
+
+#endif /* !SHAPE_H_ */
@@ -23,6 +23,9 @@ typedef struct wsky_StringReader_s {
 
   /** The string to read */
   const char *string;
+
+  /** The length of the string */
+  size_t length;
 } wsky_StringReader;
 
 
@@ -0,0 +1,58 @@
+#ifndef SYMBOL_H_
+# define SYMBOL_H_
+
+# include <stddef.h>
+# include <stdint.h>
+
+/**
+ * @defgroup Symbol Symbol
+ * @{
+ *
+ * The process-wide table of interned strings.
+ *
+ * Two equal symbols are always the same pointer, so they can be compared
+ * with `==`. Symbols are immutable, their hash is cached and they live
+ * until wsky_stop() is called.
+ */
+
+/** An interned string */
+typedef const char *wsky_Symbol;
+
+/**
+ * Returns the symbol equal to the given string, creating it if needed.
+ */
+wsky_Symbol wsky_Symbol_intern(const char *string);
+
+/**
+ * Like wsky_Symbol_intern(), but with a string which is not
+ * null-terminated.
+ */
+wsky_Symbol wsky_Symbol_internLength(const char *string, size_t length);
+
+/**
+ * Returns the symbol equal to the given string or NULL if no such symbol
+ * has been interned yet.
+ *
+ * This is cheap if the given string is already a symbol.
+ */
+wsky_Symbol wsky_Symbol_find(const char *string);
+
+/** Returns the cached hash of a symbol */
+uint32_t wsky_Symbol_getHash(wsky_Symbol symbol);
+
+/** Returns the length of a symbol */
+size_t wsky_Symbol_getLength(wsky_Symbol symbol);
+
+/** Returns the number of interned symbols */
+size_t wsky_Symbol_getCount(void);
+
+/**
+ * Frees all the symbols - called by wsky_stop().
+ */
+void wsky_Symbol_freeAll(void);
+
+/**
+ * @}
+ */
+
+#endif /* !SYMBOL_H_ */
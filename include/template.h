@@ -0,0 +1,206 @@
+#ifndef TEMPLATE_H_
+# define TEMPLATE_H_
+
+# include <stdbool.h>
+# include <stddef.h>
+# include "ast.h"
+# include "result.h"
+
+/**
+ * @defgroup Template Template
+ * @{
+ *
+ * The outputs of the templates.
+ *
+ * The HTML of a template and its printed values are appended to an
+ * output, which is never built by concatenating strings. A buffered
+ * output grows a buffer which holds the whole page. A streamed output
+ * gathers the small pieces in a buffer of fixed size, which is written
+ * to a callback each time it is full. A vectored output gives a list of
+ * slices to its callback, like writev(). The slices refer to its buffer
+ * for the printed values, and to the content of the template for the
+ * HTML, which is not copied.
+ *
+ * The printed values are escaped (see @ref HtmlEscape), the HTML is
+ * written as is.
+ *
+ * While a template is rendered, its output is the current output. The
+ * outputs of nested renderings are stacked.
+ */
+
+/**
+ * A callback which writes some bytes. Returns false on error.
+ *
+ * @param data The user data given with the callback
+ */
+typedef bool (*wsky_TemplateWriter)(void *data,
+                                    const char *bytes, size_t length);
+
+/** Some bytes to write, like a struct iovec */
+typedef struct {
+  const char *bytes;
+  size_t length;
+} wsky_TemplateSlice;
+
+/**
+ * A callback which writes some slices, in order. Returns false on
+ * error.
+ *
+ * @param data The user data given with the callback
+ */
+typedef bool (*wsky_TemplateVectorWriter)(void *data,
+                                          const wsky_TemplateSlice *slices,
+                                          size_t count);
+
+/** The size of the buffer of a streamed or vectored output */
+# define wsky_TemplateOutput_STREAM_BUFFER_SIZE 4096
+
+/** The maximum number of slices given at once by a vectored output */
+# define wsky_TemplateOutput_SLICE_COUNT 64
+
+typedef struct wsky_TemplateOutput_s wsky_TemplateOutput;
+
+/** An output */
+struct wsky_TemplateOutput_s {
+
+  /** The bytes which have not been written yet, not null-terminated */
+  char *buffer;
+
+  /** The number of bytes in the buffer */
+  size_t length;
+
+  /** The size of the buffer */
+  size_t capacity;
+
+  /** The callback of a streamed output, or NULL */
+  wsky_TemplateWriter writer;
+
+  /** The callback of a vectored output, or NULL */
+  wsky_TemplateVectorWriter vectorWriter;
+
+  /** The user data of the callback */
+  void *writerData;
+
+  /** The slices of a vectored output which have not been written yet */
+  wsky_TemplateSlice *slices;
+
+  /** The number of slices */
+  size_t sliceCount;
+
+  /**
+   * The contents of files which are referenced by the slices, retained
+   * until the slices are written
+   */
+  struct wsky_FileContent_s **sources;
+
+  /** The number of sources */
+  size_t sourceCount;
+
+  /** True if the callback has failed, the next bytes are dropped */
+  bool failed;
+
+  /** The output which was current before this one */
+  wsky_TemplateOutput *previous;
+};
+
+/** Initializes an empty buffered output */
+void wsky_TemplateOutput_initBuffer(wsky_TemplateOutput *output);
+
+/** Initializes a streamed output */
+void wsky_TemplateOutput_initStream(wsky_TemplateOutput *output,
+                                    wsky_TemplateWriter writer,
+                                    void *writerData);
+
+/** Initializes a vectored output */
+void wsky_TemplateOutput_initVector(wsky_TemplateOutput *output,
+                                    wsky_TemplateVectorWriter writer,
+                                    void *writerData);
+
+/**
+ * Frees the buffer of an output, without flushing it, and releases the
+ * contents it retains
+ */
+void wsky_TemplateOutput_free(wsky_TemplateOutput *output);
+
+/** Empties a buffered output, keeping its buffer for the next page */
+void wsky_TemplateOutput_clear(wsky_TemplateOutput *output);
+
+/**
+ * Returns the null-terminated content of a buffered output. The string
+ * belongs to the output.
+ */
+const char *wsky_TemplateOutput_getString(wsky_TemplateOutput *output);
+
+/** Appends some bytes to an output */
+void wsky_TemplateOutput_write(wsky_TemplateOutput *output,
+                               const char *bytes, size_t length);
+
+/**
+ * Like wsky_TemplateOutput_write(), with bytes which stay valid until
+ * the output is flushed. A vectored output does not copy them.
+ */
+void wsky_TemplateOutput_writeStatic(wsky_TemplateOutput *output,
+                                     const char *bytes, size_t length);
+
+/** Appends some bytes to an output, escaped as HTML */
+void wsky_TemplateOutput_writeEscaped(wsky_TemplateOutput *output,
+                                      const char *bytes, size_t length);
+
+/**
+ * Like wsky_TemplateOutput_writeStatic(), with a slice of the content of
+ * a file. A vectored output retains the content until it is flushed.
+ */
+void wsky_TemplateOutput_writeSource(wsky_TemplateOutput *output,
+                                     struct wsky_FileContent_s *source,
+                                     size_t offset, size_t length);
+
+/**
+ * Appends a value to an output, escaped as HTML. The booleans, the
+ * numbers and the strings are written without creating a new string.
+ */
+wsky_Result wsky_TemplateOutput_writeValue(wsky_TemplateOutput *output,
+                                           wsky_Value value);
+
+/**
+ * Writes the buffer of a streamed output or the slices of a vectored
+ * output to its callback. Returns false if the callback has failed.
+ */
+bool wsky_TemplateOutput_flush(wsky_TemplateOutput *output);
+
+/**
+ * A vectored callback which writes to a file descriptor with writev().
+ *
+ * @param data A pointer to the file descriptor, an `int`
+ */
+bool wsky_TemplateOutput_writeToDescriptor(void *data,
+                                           const wsky_TemplateSlice *slices,
+                                           size_t count);
+
+
+/** Makes an output the current one */
+void wsky_TemplateOutput_push(wsky_TemplateOutput *output);
+
+/** Restores the previous current output */
+void wsky_TemplateOutput_pop(void);
+
+/** Returns the current output or NULL */
+wsky_TemplateOutput *wsky_TemplateOutput_getCurrent(void);
+
+
+/**
+ * Writes the content of an HTML node to the current output, or raises
+ * an exception if there is none.
+ */
+wsky_Result wsky_Template_writeHtml(const wsky_HtmlNode *node);
+
+/**
+ * Writes a value to the current output, or raises an exception if there
+ * is none.
+ */
+wsky_Result wsky_Template_print(wsky_Value value);
+
+/**
+ * @}
+ */
+
+#endif /* !TEMPLATE_H_ */
@@ -0,0 +1,37 @@
+#ifndef TO_STRING_H_
+# define TO_STRING_H_
+
+# include <stddef.h>
+# include "value.h"
+
+/**
+ * @defgroup ToString ToString
+ * @{
+ *
+ * Formatting of the booleans, the integers and the floats into buffers
+ * given by the caller, without allocation.
+ */
+
+/** The size of a buffer which can hold any formatted primitive value */
+# define wsky_FORMAT_BUFFER_SIZE 32
+
+/**
+ * Formats an integer into a buffer of wsky_FORMAT_BUFFER_SIZE bytes.
+ * Returns the length of the null-terminated string.
+ */
+size_t wsky_formatInt(wsky_int n, char *buffer);
+
+/** Like wsky_formatInt(), with a float */
+size_t wsky_formatFloat(wsky_float n, char *buffer);
+
+/**
+ * Like wsky_formatInt(), with a boolean, an integer or a float. The
+ * value must not be an object.
+ */
+size_t wsky_formatPrimitive(wsky_Value value, char *buffer);
+
+/**
+ * @}
+ */
+
+#endif /* !TO_STRING_H_ */
@@ -50,7 +50,10 @@ typedef struct wsky_Token_s {
   /** The end position of the token */
   wsky_Position end;
 
-  /** The string of the token */
+  /**
+   * The string of the token, or NULL for an HTML token, whose text is
+   * not copied from the content of its file
+   */
   char *string;
 
   /** The type of the token */
@@ -83,7 +86,7 @@ typedef struct wsky_Token_s {
 } wsky_Token;
 
 
-/** Creates a new token */
+/** Creates a new token, with a copy of the string if it is not NULL */
 wsky_Token wsky_Token_create(wsky_Position begin,
                              wsky_Position end,
                              const char *string,
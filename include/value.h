@@ -23,6 +23,109 @@ typedef enum {
   wsky_Type_OBJECT
 } wsky_Type;
 
+# ifdef WSKY_NAN_BOXING
+
+/*
+ * The compact representation, enabled with WSKY_NAN_BOXING.
+ *
+ * A value is a 64-bit word. The floats are stored as they are, and all
+ * the NaNs are the same positive quiet NaN. The other values are
+ * negative quiet NaNs, whose 16 high bits are a tag and whose 48 low
+ * bits are the payload: a boolean, an integer or a pointer.
+ *
+ * The integers are 48-bit, they wrap around on overflow. The pointers
+ * must fit in 48 bits.
+ */
+
+/** The 16 high bits of the boxed values */
+#  define wsky_Value_TAG_MASK      UINT64_C(0xffff000000000000)
+
+/** The 48 low bits of the boxed values */
+#  define wsky_Value_PAYLOAD_MASK  UINT64_C(0x0000ffffffffffff)
+
+/** The smallest tag, the lower words are floats */
+#  define wsky_Value_MIN_TAG       UINT64_C(0xfff9000000000000)
+
+#  define wsky_Value_BOOL_TAG      UINT64_C(0xfff9000000000000)
+#  define wsky_Value_INT_TAG       UINT64_C(0xfffa000000000000)
+#  define wsky_Value_OBJECT_TAG    UINT64_C(0xfffb000000000000)
+
+/** The NaN of the floats */
+#  define wsky_Value_CANONICAL_NAN UINT64_C(0x7ff8000000000000)
+
+/**
+ * A Whiskey value.
+ *
+ * Integers, booleans and floats are not objects, and are not
+ * garbage-collected.
+ * This structure can hold any Whiskey value, whatever its type.
+ */
+typedef struct wsky_Value_s {
+
+  /** A float or a boxed value */
+  uint64_t bits;
+
+} wsky_Value;
+
+/** Returns the type of a value */
+static inline wsky_Type wsky_Value_getType(wsky_Value value) {
+  if (value.bits < wsky_Value_MIN_TAG)
+    return wsky_Type_FLOAT;
+  switch (value.bits & wsky_Value_TAG_MASK) {
+  case wsky_Value_BOOL_TAG:
+    return wsky_Type_BOOL;
+  case wsky_Value_INT_TAG:
+    return wsky_Type_INT;
+  default:
+    return wsky_Type_OBJECT;
+  }
+}
+
+/** Returns the boolean of a value whose type is BOOL */
+static inline bool wsky_Value_toBool(wsky_Value value) {
+  return value.bits & 1;
+}
+
+/** Returns the integer of a value whose type is INT */
+static inline wsky_int wsky_Value_toInt(wsky_Value value) {
+  /* Sign extension of the payload */
+  return (wsky_int)(value.bits << 16) >> 16;
+}
+
+/** Returns the float of a value whose type is FLOAT */
+static inline wsky_float wsky_Value_toFloat(wsky_Value value) {
+  union {uint64_t bits; wsky_float f;} u = {value.bits};
+  return u.f;
+}
+
+/** Returns the object, or NULL, of a value whose type is OBJECT */
+static inline wsky_Object *wsky_Value_toObject(wsky_Value value) {
+  return (wsky_Object *)(uintptr_t)(value.bits & wsky_Value_PAYLOAD_MASK);
+}
+
+/** Creates a new value from a wsky_Object */
+static inline wsky_Value wsky_Value_fromObject(wsky_Object *object) {
+  wsky_Value v = {wsky_Value_OBJECT_TAG | (uint64_t)(uintptr_t)object};
+  return v;
+}
+
+/** Creates a new value from an integer, truncated to 48 bits */
+static inline wsky_Value wsky_Value_fromInt(wsky_int n) {
+  wsky_Value v = {
+    wsky_Value_INT_TAG | ((uint64_t)n & wsky_Value_PAYLOAD_MASK)
+  };
+  return v;
+}
+
+/** Creates a new value from a float */
+static inline wsky_Value wsky_Value_fromFloat(wsky_float n) {
+  union {wsky_float f; uint64_t bits;} u = {n};
+  wsky_Value v = {n != n ? wsky_Value_CANONICAL_NAN : u.bits};
+  return v;
+}
+
+# else
+
 /**
  * A Whiskey value.
  *
@@ -52,19 +155,29 @@ typedef struct wsky_Value_s {
 
 } wsky_Value;
 
+/** Returns the type of a value */
+static inline wsky_Type wsky_Value_getType(wsky_Value value) {
+  return value.type;
+}
 
-/** A predefined value for `true` */
-extern const wsky_Value wsky_Value_TRUE;
+/** Returns the boolean of a value whose type is BOOL */
+static inline bool wsky_Value_toBool(wsky_Value value) {
+  return value.v.boolValue;
+}
 
-/** A predefined return value for `false` */
-extern const wsky_Value wsky_Value_FALSE;
+/** Returns the integer of a value whose type is INT */
+static inline wsky_int wsky_Value_toInt(wsky_Value value) {
+  return value.v.intValue;
+}
 
-/** A predefined return value for `null` */
-extern const wsky_Value wsky_Value_NULL;
+/** Returns the float of a value whose type is FLOAT */
+static inline wsky_float wsky_Value_toFloat(wsky_Value value) {
+  return value.v.floatValue;
+}
 
-/** Creates a new value from a boolean */
-static inline wsky_Value wsky_Value_fromBool(bool n) {
-  return n ? wsky_Value_TRUE : wsky_Value_FALSE;
+/** Returns the object, or NULL, of a value whose type is OBJECT */
+static inline wsky_Object *wsky_Value_toObject(wsky_Value value) {
+  return value.v.objectValue;
 }
 
 /** Creates a new value from a wsky_Object */
@@ -100,6 +213,23 @@ static inline wsky_Value wsky_Value_fromFloat(wsky_float n) {
   return v;
 }
 
+# endif /* WSKY_NAN_BOXING */
+
+
+/** A predefined value for `true` */
+extern const wsky_Value wsky_Value_TRUE;
+
+/** A predefined return value for `false` */
+extern const wsky_Value wsky_Value_FALSE;
+
+/** A predefined return value for `null` */
+extern const wsky_Value wsky_Value_NULL;
+
+/** Creates a new value from a boolean */
+static inline wsky_Value wsky_Value_fromBool(bool n) {
+  return n ? wsky_Value_TRUE : wsky_Value_FALSE;
+}
+
 /** Returns a wsky_Value or NULL */
 wsky_Value *wsky_Value_new(wsky_Value v);
 
@@ -108,7 +238,8 @@ wsky_Value *wsky_Value_new(wsky_Value v);
  * member objectValue is NULL
  */
 static inline bool wsky_isNull(wsky_Value value) {
-  return value.type == wsky_Type_OBJECT && !value.v.objectValue;
+  return wsky_Value_getType(value) == wsky_Type_OBJECT &&
+    !wsky_Value_toObject(value);
 }
 
 /**
@@ -0,0 +1,46 @@
+#ifndef VM_H_
+# define VM_H_
+
+# include "bytecode.h"
+# include "objects/scope.h"
+
+/**
+ * @defgroup vm vm
+ * @{
+ *
+ * The stack-based virtual machine which runs the bytecode.
+ *
+ * The virtual machine is an alternative to the tree-walking evaluator.
+ * When it is enabled, the programs and the bodies of the Whiskey
+ * functions are compiled to bytecode and run by the virtual machine.
+ * Calls between Whiskey functions don't recurse on the C stack.
+ */
+
+/**
+ * Enables or disables the virtual machine.
+ *
+ * It can be called even if wsky_start() has not been called.
+ */
+void wsky_vm_setEnabled(bool enabled);
+
+/** Returns true if the virtual machine is enabled */
+bool wsky_vm_isEnabled(void);
+
+/**
+ * Runs bytecode in the given scope, which must have been pushed with
+ * wsky_eval_pushScope().
+ *
+ * Raises an exception if the stack of the virtual machine overflows.
+ */
+wsky_Result wsky_vm_run(const wsky_Bytecode *bytecode, wsky_Scope *scope);
+
+/**
+ * For the garbage collector.
+ */
+void wsky_vm_visitStack(void);
+
+/**
+ * @}
+ */
+
+#endif /* !VM_H_ */
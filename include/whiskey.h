@@ -10,10 +10,15 @@
  */
 
 # include "ast.h"
+# include "bytecode.h"
 # include "class_def.h"
 # include "dict.h"
 # include "eval.h"
+# include "file_cache.h"
 # include "gc.h"
+# include "handle.h"
+# include "html_escape.h"
+# include "inline_cache.h"
 # include "keyword.h"
 # include "lexer.h"
 # include "memory.h"
@@ -22,10 +27,16 @@
 # include "parser.h"
 # include "path.h"
 # include "position.h"
+# include "resolver.h"
+# include "shape.h"
 # include "string_reader.h"
 # include "string_utils.h"
+# include "symbol.h"
 # include "syntax_error.h"
+# include "template.h"
+# include "to_string.h"
 # include "token.h"
+# include "vm.h"
 
 # include "objects/attribute_error.h"
 # include "objects/boolean.h"
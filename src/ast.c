@@ -161,6 +161,13 @@ void wsky_ASTNode_delete(Node *node) {
   T##Node_free((T##Node *) node); break;
 # define CASE(type, name) case wsky_ASTNodeType_##type: R(name)
 
+  if (node->type == wsky_ASTNodeType_FUNCTION) {
+    FunctionNode *function = (FunctionNode *)node;
+    assert(function->refCount > 0);
+    if (--function->refCount > 0)
+      return;
+  }
+
   switch (node->type) {
 
   case wsky_ASTNodeType_NULL:
@@ -280,7 +287,7 @@ static char *floatNodeToString(const LiteralNode *node) {
   Result stringRv = wsky_toString(value);
   assert(!stringRv.exception);
   assert(wsky_isString(stringRv.v));
-  String *string = (String *)stringRv.v.v.objectValue;
+  String *string = (String *)Value_toObject(stringRv.v);
   return wsky_strdup(string->string);
 }
 
@@ -307,7 +314,9 @@ IdentifierNode *wsky_IdentifierNode_new(const char *name,
   IdentifierNode *node = wsky_safeMalloc(sizeof(IdentifierNode));
   node->type = type;
   node->position = position;
-  node->name = name ? wsky_strdup(name) : NULL;
+  node->name = name ? wsky_Symbol_intern(name) : NULL;
+  node->depth = -1;
+  node->slot = 0;
   return node;
 }
 
@@ -321,11 +330,13 @@ IdentifierNode *wsky_IdentifierNode_newFromToken(const Token *token) {
 }
 
 void IdentifierNode_copy(const IdentifierNode *source, IdentifierNode *new) {
-  new->name = source->name ? wsky_strdup(source->name) : NULL;
+  new->name = source->name;
+  new->depth = source->depth;
+  new->slot = source->slot;
 }
 
 static void IdentifierNode_free(IdentifierNode *node) {
-  wsky_free(node->name);
+  (void) node;
 }
 
 static const char *identifierToString(const IdentifierNode *node) {
@@ -354,23 +365,62 @@ HtmlNode *wsky_HtmlNode_new(const Token *token) {
   if (token->type != wsky_TokenType_HTML)
     return NULL;
 
+  FileContent *source = token->begin.file->source;
+  assert(source);
+  assert((size_t)token->end.index <= source->length);
+
   HtmlNode *node = wsky_safeMalloc(sizeof(HtmlNode));
   node->type = wsky_ASTNodeType_HTML;
   node->position = token->begin;
-  node->content = wsky_strdup(token->string);
+  node->source = wsky_FileContent_retain(source);
+  node->slices = wsky_safeMalloc(sizeof(HtmlSlice));
+  node->slices[0].offset = (size_t)token->begin.index;
+  node->slices[0].length = (size_t)(token->end.index - token->begin.index);
+  node->sliceCount = 1;
   return node;
 }
 
+void wsky_HtmlNode_append(HtmlNode *node, const HtmlNode *next) {
+  assert(node->source == next->source);
+  size_t count = node->sliceCount + next->sliceCount;
+  node->slices = wsky_realloc(node->slices, count * sizeof(HtmlSlice));
+  if (!node->slices)
+    abort();
+  memcpy(node->slices + node->sliceCount, next->slices,
+         next->sliceCount * sizeof(HtmlSlice));
+  node->sliceCount = (unsigned)count;
+}
+
 void HtmlNode_copy(const HtmlNode *source, HtmlNode *new) {
-  new->content = wsky_strdup(source->content);
+  size_t size = source->sliceCount * sizeof(HtmlSlice);
+  new->source = wsky_FileContent_retain(source->source);
+  new->slices = wsky_safeMalloc(size);
+  memcpy(new->slices, source->slices, size);
+  new->sliceCount = source->sliceCount;
 }
 
 static void HtmlNode_free(HtmlNode *node) {
-  wsky_free(node->content);
+  wsky_FileContent_release(node->source);
+  wsky_free(node->slices);
 }
 
 static char *HtmlNode_toString(const HtmlNode *node) {
-  return wsky_asprintf("HTML(%s)", node->content);
+  size_t length = 0;
+  for (unsigned i = 0; i < node->sliceCount; i++)
+    length += node->slices[i].length;
+
+  char *html = wsky_safeMalloc(length + 1);
+  char *end = html;
+  for (unsigned i = 0; i < node->sliceCount; i++) {
+    const HtmlSlice *slice = node->slices + i;
+    memcpy(end, node->source->string + slice->offset, slice->length);
+    end += slice->length;
+  }
+  *end = '\0';
+
+  char *s = wsky_asprintf("HTML(%s)", html);
+  wsky_free(html);
+  return s;
 }
 
 TpltPrintNode *wsky_TpltPrintNode_new(const Token *token,
@@ -559,11 +609,14 @@ SequenceNode *wsky_SequenceNode_new(const wsky_Position *position,
   node->children = children;
   node->position = *position;
   node->program = false;
+  node->slotCount = 0;
   return node;
 }
 
 void SequenceNode_copy(const SequenceNode *source, SequenceNode *new) {
   new->children = wsky_ASTNodeList_copy(source->children);
+  new->program = source->program;
+  new->slotCount = source->slotCount;
 }
 
 static void SequenceNode_free(SequenceNode *node) {
@@ -591,23 +644,32 @@ FunctionNode *wsky_FunctionNode_new(const Token *token,
   node->children = children;
   node->parameters = parameters;
   node->name = NULL;
+  node->slotCount = 0;
+  node->refCount = 1;
   return node;
 }
 
 void wsky_FunctionNode_setName(wsky_FunctionNode *node,
                                const char *newName) {
-  wsky_free(node->name);
-  node->name = wsky_strdup(newName);
+  node->name = wsky_Symbol_intern(newName);
 }
 
 void FunctionNode_copy(const FunctionNode *source, FunctionNode *new) {
-  new->name = source->name ? wsky_strdup(source->name) : NULL;
+  new->name = source->name;
   new->children = wsky_ASTNodeList_copy(source->children);
   new->parameters = wsky_ASTNodeList_copy(source->parameters);
+  new->slotCount = source->slotCount;
+  new->refCount = 1;
+}
+
+FunctionNode *wsky_FunctionNode_retain(const FunctionNode *node) {
+  /* The reference count is the only mutable member of the node */
+  FunctionNode *shared = (FunctionNode *)node;
+  shared->refCount++;
+  return shared;
 }
 
 static void FunctionNode_free(FunctionNode *node) {
-  wsky_free(node->name);
   wsky_ASTNodeList_delete(node->children);
   wsky_ASTNodeList_delete(node->parameters);
 }
@@ -634,21 +696,21 @@ VarNode *wsky_VarNode_new(const Token *token,
   VarNode *node = wsky_safeMalloc(sizeof(VarNode));
   node->type = wsky_ASTNodeType_VAR;
   node->position = token->begin;
-  node->name = wsky_strdup(name);
+  node->name = wsky_Symbol_intern(name);
   node->right = right;
+  node->slot = -1;
   return node;
 }
 
 void VarNode_copy(const VarNode *source, VarNode *new) {
-  new->name = wsky_strdup(source->name);
-  if (source->right)
-    new->right = wsky_ASTNode_copy(source->right);
+  new->name = source->name;
+  new->right = source->right ? wsky_ASTNode_copy(source->right) : NULL;
+  new->slot = source->slot;
 }
 
 static void VarNode_free(VarNode *node) {
   if (node->right)
     wsky_ASTNode_delete(node->right);
-  wsky_free(node->name);
 }
 
 unsigned wsky_ASTNodeList_getCount(const NodeList *list) {
@@ -747,18 +809,19 @@ MemberAccessNode *wsky_MemberAccessNode_new(const Token *token,
   node->type = wsky_ASTNodeType_MEMBER_ACCESS;
   node->position = token->begin;
   node->left = left;
-  node->name = wsky_strdup(name);
+  node->name = wsky_Symbol_intern(name);
+  wsky_InlineCache_init(&node->cache);
   return node;
 }
 
 void MemberAccessNode_copy(const MemberAccessNode *source,
                            MemberAccessNode *new) {
   new->left = wsky_ASTNode_copy(source->left);
-  new->name = wsky_strdup(source->name);
+  new->name = source->name;
+  wsky_InlineCache_init(&new->cache);
 }
 
 static void MemberAccessNode_free(MemberAccessNode *node) {
-  wsky_free(node->name);
   wsky_ASTNode_delete(node->left);
 }
 
@@ -780,15 +843,17 @@ ClassNode *wsky_ClassNode_new(const Token *token,
   ClassNode *node = wsky_safeMalloc(sizeof(ClassNode));
   node->type = wsky_ASTNodeType_CLASS;
   node->position = token->begin;
-  node->name = wsky_strdup(name);
+  node->name = wsky_Symbol_intern(name);
   node->superclass = superclass;
   node->interfaces = interfaces;
   node->children = children;
+  node->slot = -1;
   return node;
 }
 
 void ClassNode_copy(const ClassNode *source, ClassNode *new) {
-  new->name = wsky_strdup(source->name);
+  new->name = source->name;
+  new->slot = source->slot;
   new->superclass = source->superclass ?
     wsky_ASTNode_copy(source->superclass) : NULL;
   new->interfaces = wsky_ASTNodeList_copy(source->interfaces);
@@ -796,7 +861,6 @@ void ClassNode_copy(const ClassNode *source, ClassNode *new) {
 }
 
 static void ClassNode_free(ClassNode *node) {
-  wsky_free(node->name);
   if (node->superclass)
     wsky_ASTNode_delete(node->superclass);
   wsky_ASTNodeList_delete(node->children);
@@ -847,7 +911,7 @@ ClassMemberNode *wsky_ClassMemberNode_new(const Token *token,
   ClassMemberNode *node = wsky_safeMalloc(sizeof(ClassMemberNode));
   node->type = wsky_ASTNodeType_CLASS_MEMBER;
   node->position = token->begin;
-  node->name = name ? wsky_strdup(name) : NULL;
+  node->name = name ? wsky_Symbol_intern(name) : NULL;
   if (right) {
     const char *functionName = name;
     if (flags & wsky_MethodFlags_INIT)
@@ -863,13 +927,12 @@ ClassMemberNode *wsky_ClassMemberNode_new(const Token *token,
 
 void ClassMemberNode_copy(const ClassMemberNode *source,
                           ClassMemberNode *new) {
-  new->name = source->name ? wsky_strdup(source->name) : NULL;
+  new->name = source->name;
   new->right = source->right ? wsky_ASTNode_copy(source->right) : NULL;
   new->flags = source->flags;
 }
 
 static void ClassMemberNode_free(ClassMemberNode *node) {
-  wsky_free(node->name);
   if (node->right)
     wsky_ASTNode_delete(node->right);
 }
@@ -928,12 +991,14 @@ ImportNode *wsky_ImportNode_new(Position position,
   node->position = position;
   node->name = wsky_strdup(name);
   node->level = level;
+  node->slot = -1;
   return node;
 }
 
 void ImportNode_copy(const ImportNode *source, ImportNode *new) {
   new->level = source->level;
   new->name = wsky_strdup(source->name);
+  new->slot = source->slot;
 }
 
 static void ImportNode_free(ImportNode *node) {
@@ -963,18 +1028,19 @@ ExportNode *wsky_ExportNode_new(Position position,
   ExportNode *node = wsky_safeMalloc(sizeof(ExportNode));
   node->type = wsky_ASTNodeType_EXPORT;
   node->position = position;
-  node->name = wsky_strdup(name);
+  node->name = wsky_Symbol_intern(name);
   node->right = right;
+  node->slot = -1;
   return node;
 }
 
 void ExportNode_copy(const ExportNode *source, ExportNode *new) {
-  new->name = wsky_strdup(source->name);
+  new->name = source->name;
   new->right = source->right ? wsky_ASTNode_copy(source->right) : NULL;
+  new->slot = source->slot;
 }
 
 static void ExportNode_free(ExportNode *node) {
-  wsky_free(node->name);
   if (node->right)
     wsky_ASTNode_delete(node->right);
 }
@@ -1063,20 +1129,23 @@ void wsky_ExceptNode_init(ExceptNode *node,
                           NodeList *classes, const char *variable,
                           Node *expression) {
   node->classes = classes;
-  node->variable = variable ? wsky_strdup(variable) : NULL;
+  node->variable = variable ? wsky_Symbol_intern(variable) : NULL;
   node->expression = expression;
+  node->slot = -1;
+  node->slotCount = 0;
 }
 
 static void ExceptNode_copy(const ExceptNode *source, ExceptNode *new) {
   new->classes = wsky_ASTNodeList_copy(source->classes);
-  new->variable = source->variable ? wsky_strdup(source->variable) : NULL;
+  new->variable = source->variable;
   new->expression = wsky_ASTNode_copy(source->expression);
+  new->slot = source->slot;
+  new->slotCount = source->slotCount;
 }
 
 static void ExceptNode_free(ExceptNode *node) {
   wsky_ASTNodeList_delete(node->classes);
   wsky_ASTNode_delete(node->expression);
-  wsky_free(node->variable);
 }
 
 static char *ExceptNode_toString(ExceptNode *node) {
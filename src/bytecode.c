@@ -0,0 +1,597 @@
+#include <assert.h>
+#include "whiskey_private.h"
+
+typedef wsky_Bytecode Bytecode;
+typedef wsky_BytecodeConstant Constant;
+
+#define OP(name) wsky_Opcode_ ## name
+
+
+static const char *const OPCODE_NAMES[] = {
+#define NAME(name, operandCount) #name,
+  wsky_OPCODES(NAME)
+#undef NAME
+};
+
+static const unsigned OPERAND_COUNTS[] = {
+#define COUNT(name, operandCount) operandCount,
+  wsky_OPCODES(COUNT)
+#undef COUNT
+};
+
+const char *wsky_Opcode_toString(wsky_Opcode opcode) {
+  assert(opcode < wsky_Opcode_COUNT);
+  return OPCODE_NAMES[opcode];
+}
+
+unsigned wsky_Opcode_getOperandCount(wsky_Opcode opcode) {
+  assert(opcode < wsky_Opcode_COUNT);
+  return OPERAND_COUNTS[opcode];
+}
+
+
+
+typedef struct {
+  Bytecode *bytecode;
+
+  /** The current number of values on the stack */
+  unsigned stackSize;
+} Compiler;
+
+
+static void emit(Compiler *c, uint32_t word) {
+  Bytecode *b = c->bytecode;
+  if (b->length == b->capacity) {
+    b->capacity = b->capacity ? b->capacity * 2 : 32;
+    b->code = wsky_realloc(b->code, b->capacity * sizeof(uint32_t));
+    if (!b->code)
+      abort();
+  }
+  b->code[b->length++] = word;
+}
+
+static uint32_t addConstant(Compiler *c, Constant constant) {
+  Bytecode *b = c->bytecode;
+  if (b->constantCount == b->constantCapacity) {
+    b->constantCapacity = b->constantCapacity ? b->constantCapacity * 2 : 8;
+    b->constants = wsky_realloc(b->constants,
+                                b->constantCapacity * sizeof(Constant));
+    if (!b->constants)
+      abort();
+  }
+  b->constants[b->constantCount] = constant;
+  return b->constantCount++;
+}
+
+static uint32_t addString(Compiler *c, const char *string) {
+  Constant constant = {.stringValue = string};
+  return addConstant(c, constant);
+}
+
+static uint32_t addNode(Compiler *c, const Node *node) {
+  Constant constant = {.node = node};
+  return addConstant(c, constant);
+}
+
+/** Updates the stack size after an instruction */
+static void adjustStack(Compiler *c, int delta) {
+  assert(delta >= 0 || c->stackSize >= (unsigned)-delta);
+  c->stackSize = (unsigned)((int)c->stackSize + delta);
+  if (c->stackSize > c->bytecode->maxStackSize)
+    c->bytecode->maxStackSize = c->stackSize;
+}
+
+static void emitOp(Compiler *c, wsky_Opcode opcode, int stackDelta) {
+  emit(c, opcode);
+  adjustStack(c, stackDelta);
+}
+
+static void emitOp1(Compiler *c, wsky_Opcode opcode, int stackDelta,
+                    uint32_t operand) {
+  emitOp(c, opcode, stackDelta);
+  emit(c, operand);
+}
+
+/** Emits a jump and returns the offset of its target operand */
+static unsigned emitJump(Compiler *c, wsky_Opcode opcode, int stackDelta) {
+  emitOp1(c, opcode, stackDelta, 0);
+  return c->bytecode->length - 1;
+}
+
+/** Sets the target of a jump to the current offset */
+static void patchJump(Compiler *c, unsigned operandOffset) {
+  c->bytecode->code[operandOffset] = c->bytecode->length;
+}
+
+
+
+static void compileNode(Compiler *c, const Node *node);
+
+static void compileEvalNode(Compiler *c, const Node *node) {
+  emitOp1(c, OP(EVAL_NODE), 1, addNode(c, node));
+}
+
+/** Compiles nodes evaluated in sequence, leaving the last value */
+static void compileNodeList(Compiler *c, const NodeList *list) {
+  if (!list) {
+    emitOp(c, OP(PUSH_NULL), 1);
+    return;
+  }
+  while (list) {
+    compileNode(c, list->node);
+    if (list->next)
+      emitOp(c, OP(POP), -1);
+    list = list->next;
+  }
+}
+
+static void compileLiteral(Compiler *c, const LiteralNode *node) {
+  Constant constant;
+
+  switch (node->type) {
+  case wsky_ASTNodeType_NULL:
+    emitOp(c, OP(PUSH_NULL), 1);
+    return;
+
+  case wsky_ASTNodeType_BOOL:
+    emitOp(c, node->v.boolValue ? OP(PUSH_TRUE) : OP(PUSH_FALSE), 1);
+    return;
+
+  case wsky_ASTNodeType_INT:
+    constant.intValue = node->v.intValue;
+    emitOp1(c, OP(PUSH_INT), 1, addConstant(c, constant));
+    return;
+
+  case wsky_ASTNodeType_FLOAT:
+    constant.floatValue = node->v.floatValue;
+    emitOp1(c, OP(PUSH_FLOAT), 1, addConstant(c, constant));
+    return;
+
+  case wsky_ASTNodeType_STRING:
+    emitOp1(c, OP(PUSH_STRING), 1, addString(c, node->v.stringValue));
+    return;
+
+  default:
+    abort();
+  }
+}
+
+static void compileSequence(Compiler *c, const SequenceNode *node) {
+  emitOp1(c, OP(ENTER_SCOPE), 0, node->slotCount);
+  compileNodeList(c, node->children);
+  emitOp(c, OP(LEAVE_SCOPE), 0);
+}
+
+static void compileOperator(Compiler *c, const OperatorNode *node) {
+  if (node->left) {
+    compileNode(c, node->left);
+    compileNode(c, node->right);
+    emitOp1(c, OP(BINARY), -1, node->operator);
+  } else {
+    compileNode(c, node->right);
+    emitOp1(c, OP(UNARY), 0, node->operator);
+  }
+}
+
+static void compileIdentifier(Compiler *c, const IdentifierNode *node) {
+  uint32_t name = addString(c, node->name);
+  if (node->depth == -1) {
+    emitOp1(c, OP(LOAD_NAME), 1, name);
+    return;
+  }
+  emitOp(c, OP(LOAD_SLOT), 1);
+  emit(c, (uint32_t)node->depth);
+  emit(c, node->slot);
+  emit(c, name);
+}
+
+static void compileDeclaration(Compiler *c, const char *name, int slot) {
+  if (slot == -1) {
+    emitOp1(c, OP(DECLARE_NAME), 0, addString(c, name));
+    return;
+  }
+  emitOp(c, OP(DECLARE_SLOT), 0);
+  emit(c, (uint32_t)slot);
+  emit(c, addString(c, name));
+}
+
+static void compileVar(Compiler *c, const VarNode *node) {
+  if (node->right)
+    compileNode(c, node->right);
+  else
+    emitOp(c, OP(PUSH_NULL), 1);
+  compileDeclaration(c, node->name, node->slot);
+}
+
+static void compileAssignment(Compiler *c, const AssignmentNode *node) {
+  const Node *left = node->left;
+
+  if (left->type == wsky_ASTNodeType_IDENTIFIER) {
+    const IdentifierNode *identifier = (const IdentifierNode *)left;
+    uint32_t name = addString(c, identifier->name);
+    compileNode(c, node->right);
+    if (identifier->depth == -1) {
+      emitOp1(c, OP(STORE_NAME), 0, name);
+      return;
+    }
+    emitOp(c, OP(STORE_SLOT), 0);
+    emit(c, (uint32_t)identifier->depth);
+    emit(c, identifier->slot);
+    emit(c, name);
+
+  } else if (left->type == wsky_ASTNodeType_MEMBER_ACCESS) {
+    const MemberAccessNode *member = (const MemberAccessNode *)left;
+    compileNode(c, node->right);
+    if (member->left->type == wsky_ASTNodeType_SUPER) {
+      emitOp1(c, OP(SET_SUPER_MEMBER), 0, addString(c, member->name));
+      return;
+    }
+    compileNode(c, member->left);
+    emitOp1(c, OP(SET_MEMBER), -1, addNode(c, left));
+
+  } else {
+    compileEvalNode(c, (const Node *)node);
+  }
+}
+
+/** Compiles the parameters and returns their count */
+static unsigned compileParameters(Compiler *c, const NodeList *list) {
+  unsigned count = 0;
+  while (list) {
+    compileNode(c, list->node);
+    count++;
+    list = list->next;
+  }
+  return count;
+}
+
+static void compileCall(Compiler *c, const CallNode *node) {
+  if (node->left->type == wsky_ASTNodeType_SUPER) {
+    unsigned count = compileParameters(c, node->children);
+    emitOp1(c, OP(SUPER_CALL), 1 - (int)count, count);
+    return;
+  }
+  if (node->left->type == wsky_ASTNodeType_MEMBER_ACCESS) {
+    const MemberAccessNode *member = (const MemberAccessNode *)node->left;
+    if (member->left->type != wsky_ASTNodeType_SUPER) {
+      compileNode(c, member->left);
+      emitOp1(c, OP(GET_METHOD), 1, addNode(c, node->left));
+      unsigned count = compileParameters(c, node->children);
+      emitOp1(c, OP(CALL_METHOD), -1 - (int)count, count);
+      return;
+    }
+  }
+  compileNode(c, node->left);
+  unsigned count = compileParameters(c, node->children);
+  emitOp1(c, OP(CALL), -(int)count, count);
+}
+
+static void compileMemberAccess(Compiler *c, const MemberAccessNode *node) {
+  if (node->left->type == wsky_ASTNodeType_SUPER) {
+    emitOp1(c, OP(GET_SUPER_MEMBER), 1, addString(c, node->name));
+    return;
+  }
+  compileNode(c, node->left);
+  emitOp1(c, OP(GET_MEMBER), 0, addNode(c, (const Node *)node));
+}
+
+static void compileIf(Compiler *c, const IfNode *node) {
+  const NodeList *tests = node->tests;
+  const NodeList *expressions = node->expressions;
+
+  unsigned endJumpCount = wsky_ASTNodeList_getCount(tests);
+  unsigned *endJumps = wsky_safeMalloc(endJumpCount * sizeof(unsigned));
+  unsigned i = 0;
+
+  while (tests) {
+    assert(expressions);
+
+    compileNode(c, tests->node);
+    unsigned nextTest = emitJump(c, OP(JUMP_IF_FALSE), -1);
+    compileNode(c, expressions->node);
+    endJumps[i++] = emitJump(c, OP(JUMP), -1);
+    patchJump(c, nextTest);
+
+    expressions = expressions->next;
+    tests = tests->next;
+  }
+
+  if (node->elseNode)
+    compileNode(c, node->elseNode);
+  else
+    emitOp(c, OP(PUSH_NULL), 1);
+
+  for (i = 0; i < endJumpCount; i++)
+    patchJump(c, endJumps[i]);
+  wsky_free(endJumps);
+}
+
+/**
+ * Compiles an `except` clause. The exception is on the stack.
+ *
+ * @return The offset of the operand of the jump to the end of the `try`
+ */
+static unsigned compileExcept(Compiler *c, const ExceptNode *except) {
+  const NodeList *classes = except->classes;
+  unsigned nextClause = 0;
+
+  if (classes) {
+    unsigned matchCount = wsky_ASTNodeList_getCount(classes);
+    unsigned *matches = wsky_safeMalloc(matchCount * sizeof(unsigned));
+    unsigned i = 0;
+    while (classes) {
+      compileNode(c, classes->node);
+      matches[i++] = emitJump(c, OP(EXCEPT_MATCH), -1);
+      classes = classes->next;
+    }
+    nextClause = emitJump(c, OP(JUMP), 0);
+    for (i = 0; i < matchCount; i++)
+      patchJump(c, matches[i]);
+    wsky_free(matches);
+  }
+
+  emitOp1(c, OP(ENTER_SCOPE), 0, except->slotCount);
+  if (except->variable)
+    compileDeclaration(c, except->variable, except->slot);
+  emitOp(c, OP(POP), -1);
+  compileNode(c, except->expression);
+  emitOp(c, OP(LEAVE_SCOPE), 0);
+  unsigned end = emitJump(c, OP(JUMP), 0);
+
+  if (except->classes)
+    patchJump(c, nextClause);
+  return end;
+}
+
+/** Compiles a `try` statement, without its `finally` clause */
+static void compileTryImpl(Compiler *c, const TryNode *node) {
+  unsigned handler = emitJump(c, OP(TRY), 0);
+  unsigned stackSize = c->stackSize;
+
+  compileNode(c, node->try);
+  emitOp(c, OP(END_TRY), 0);
+  if (node->elseNode) {
+    emitOp(c, OP(POP), -1);
+    compileNode(c, node->elseNode);
+  }
+  unsigned tryEnd = emitJump(c, OP(JUMP), 0);
+
+  /* The handler starts with the exception on the stack */
+  patchJump(c, handler);
+  c->stackSize = stackSize;
+  adjustStack(c, 1);
+
+  /* One more element, as there may be no except clause */
+  unsigned *ends = wsky_safeMalloc((node->exceptCount + 1) *
+                                   sizeof(unsigned));
+  for (size_t i = 0; i < node->exceptCount; i++) {
+    ends[i] = compileExcept(c, node->excepts + i);
+    c->stackSize = stackSize + 1;
+  }
+  emitOp(c, OP(RAISE), 0);
+
+  for (size_t i = 0; i < node->exceptCount; i++)
+    patchJump(c, ends[i]);
+  patchJump(c, tryEnd);
+  wsky_free(ends);
+}
+
+static void compileTry(Compiler *c, const TryNode *node) {
+  if (!node->finally) {
+    compileTryImpl(c, node);
+    return;
+  }
+
+  unsigned handler = emitJump(c, OP(TRY), 0);
+  unsigned stackSize = c->stackSize;
+
+  compileTryImpl(c, node);
+  emitOp(c, OP(END_TRY), 0);
+  compileNode(c, node->finally);
+  emitOp(c, OP(POP), -1);
+  unsigned end = emitJump(c, OP(JUMP), 0);
+
+  /* The finally clause is run again if an exception is raised */
+  patchJump(c, handler);
+  c->stackSize = stackSize;
+  adjustStack(c, 1);
+  compileNode(c, node->finally);
+  emitOp(c, OP(POP), -1);
+  emitOp(c, OP(RAISE), 0);
+
+  patchJump(c, end);
+}
+
+static void compileNode(Compiler *c, const Node *node) {
+#define CASE(type) case wsky_ASTNodeType_ ## type
+  switch (node->type) {
+
+  CASE(NULL):
+  CASE(BOOL):
+  CASE(INT):
+  CASE(FLOAT):
+  CASE(STRING):
+    compileLiteral(c, (const LiteralNode *)node);
+    break;
+
+  CASE(SEQUENCE):
+    compileSequence(c, (const SequenceNode *)node);
+    break;
+
+  CASE(UNARY_OPERATOR):
+  CASE(BINARY_OPERATOR):
+    compileOperator(c, (const OperatorNode *)node);
+    break;
+
+  CASE(VAR):
+    compileVar(c, (const VarNode *)node);
+    break;
+
+  CASE(IDENTIFIER):
+    compileIdentifier(c, (const IdentifierNode *)node);
+    break;
+
+  CASE(SELF):
+    emitOp(c, OP(PUSH_SELF), 1);
+    break;
+
+  CASE(SUPERCLASS):
+    emitOp(c, OP(PUSH_SUPERCLASS), 1);
+    break;
+
+  CASE(ASSIGNMENT):
+    compileAssignment(c, (const AssignmentNode *)node);
+    break;
+
+  CASE(FUNCTION):
+    emitOp1(c, OP(MAKE_FUNCTION), 1, addNode(c, node));
+    break;
+
+  CASE(CALL):
+    compileCall(c, (const CallNode *)node);
+    break;
+
+  CASE(MEMBER_ACCESS):
+    compileMemberAccess(c, (const MemberAccessNode *)node);
+    break;
+
+  CASE(IF):
+    compileIf(c, (const IfNode *)node);
+    break;
+
+  CASE(TRY):
+    compileTry(c, (const TryNode *)node);
+    break;
+
+  CASE(HTML):
+    emitOp1(c, OP(WRITE_HTML), 1, addNode(c, node));
+    break;
+
+  CASE(TPLT_PRINT):
+    compileNode(c, ((const TpltPrintNode *)node)->child);
+    emitOp(c, OP(PRINT), 0);
+    break;
+
+  default:
+    /* Classes, imports and exports */
+    compileEvalNode(c, node);
+    break;
+  }
+#undef CASE
+}
+
+
+
+static Bytecode *newBytecode(void) {
+  Bytecode *bytecode = wsky_safeMalloc(sizeof(Bytecode));
+  bytecode->code = NULL;
+  bytecode->length = 0;
+  bytecode->capacity = 0;
+  bytecode->constants = NULL;
+  bytecode->constantCount = 0;
+  bytecode->constantCapacity = 0;
+  bytecode->maxStackSize = 0;
+  return bytecode;
+}
+
+Bytecode *wsky_Bytecode_compile(const Node *node) {
+  Compiler c = {newBytecode(), 0};
+  compileNode(&c, node);
+  emitOp(&c, OP(RETURN), -1);
+  assert(c.stackSize == 0);
+  return c.bytecode;
+}
+
+Bytecode *wsky_Bytecode_compileFunction(const FunctionNode *node) {
+  Compiler c = {newBytecode(), 0};
+  compileNodeList(&c, node->children);
+  emitOp(&c, OP(RETURN), -1);
+  assert(c.stackSize == 0);
+  return c.bytecode;
+}
+
+void wsky_Bytecode_delete(Bytecode *bytecode) {
+  wsky_free(bytecode->code);
+  wsky_free(bytecode->constants);
+  wsky_free(bytecode);
+}
+
+
+
+static void printConstant(const Bytecode *bytecode, wsky_Opcode opcode,
+                          uint32_t index, FILE *output) {
+  const Constant *constant = bytecode->constants + index;
+
+  switch (opcode) {
+  case OP(PUSH_INT):
+    fprintf(output, " (%ld)", (long)constant->intValue);
+    break;
+
+  case OP(PUSH_FLOAT):
+    fprintf(output, " (%g)", (double)constant->floatValue);
+    break;
+
+  case OP(MAKE_FUNCTION):
+  case OP(WRITE_HTML):
+  case OP(EVAL_NODE): {
+    char *string = wsky_ASTNode_toString(constant->node);
+    fprintf(output, " (%s)", string);
+    wsky_free(string);
+    break;
+  }
+
+  case OP(GET_MEMBER):
+  case OP(SET_MEMBER):
+  case OP(GET_METHOD):
+    fprintf(output, " (%s)",
+            ((const MemberAccessNode *)constant->node)->name);
+    break;
+
+  default:
+    fprintf(output, " (%s)", constant->stringValue);
+  }
+}
+
+/** Returns true if the last operand of the opcode is a constant index */
+static bool hasConstantOperand(wsky_Opcode opcode) {
+  switch (opcode) {
+  case OP(PUSH_INT):
+  case OP(PUSH_FLOAT):
+  case OP(PUSH_STRING):
+  case OP(LOAD_SLOT):
+  case OP(LOAD_NAME):
+  case OP(STORE_SLOT):
+  case OP(STORE_NAME):
+  case OP(DECLARE_SLOT):
+  case OP(DECLARE_NAME):
+  case OP(MAKE_FUNCTION):
+  case OP(GET_MEMBER):
+  case OP(GET_SUPER_MEMBER):
+  case OP(SET_MEMBER):
+  case OP(SET_SUPER_MEMBER):
+  case OP(GET_METHOD):
+  case OP(WRITE_HTML):
+  case OP(EVAL_NODE):
+    return true;
+  default:
+    return false;
+  }
+}
+
+void wsky_Bytecode_print(const Bytecode *bytecode, FILE *output) {
+  unsigned offset = 0;
+  while (offset < bytecode->length) {
+    wsky_Opcode opcode = (wsky_Opcode)bytecode->code[offset];
+    unsigned operandCount = wsky_Opcode_getOperandCount(opcode);
+
+    fprintf(output, "%5u  %s", offset, wsky_Opcode_toString(opcode));
+    for (unsigned i = 1; i <= operandCount; i++)
+      fprintf(output, " %u", (unsigned)bytecode->code[offset + i]);
+    if (operandCount && hasConstantOperand(opcode))
+      printConstant(bytecode, opcode,
+                    bytecode->code[offset + operandCount], output);
+    fprintf(output, "\n");
+
+    offset += 1 + operandCount;
+  }
+}
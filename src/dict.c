@@ -2,16 +2,40 @@
 #include "whiskey_private.h"
 
 
+/** Dictionnaries with more entries than this get an index table */
+#define MAX_LINEAR_COUNT 8
+
+/** An empty slot of the index table */
+#define EMPTY_INDEX 0
+
+/** A slot of the index table whose entry has been removed */
+#define REMOVED_INDEX UINT32_MAX
+
+
 typedef struct wsky_DictEntry_s {
-  char *key;
+  /** The key or NULL if the entry has been removed */
+  Symbol key;
+
+  /** A copy of the hash of the key */
+  uint32_t hash;
+
   void *value;
-  struct wsky_DictEntry_s *previous;
-  struct wsky_DictEntry_s *next;
 } Entry;
 
 
+static inline bool Entry_isRemoved(const Entry *entry) {
+  return entry->key == NULL;
+}
+
+
+
 void wsky_Dict_init(Dict *self) {
-  self->first = NULL;
+  self->entries = NULL;
+  self->indices = NULL;
+  self->entryCount = 0;
+  self->entryCapacity = 0;
+  self->removedCount = 0;
+  self->indexCapacity = 0;
 }
 
 Dict *wsky_Dict_new(void) {
@@ -21,14 +45,9 @@ Dict *wsky_Dict_new(void) {
 }
 
 void wsky_Dict_free(Dict *self) {
-  Entry *entry = self->first;
-  while (entry) {
-    Entry *next = entry->next;
-    wsky_free(entry->key);
-    wsky_free(entry);
-    entry = next;
-  }
-  self->first = NULL;
+  wsky_free(self->entries);
+  wsky_free(self->indices);
+  wsky_Dict_init(self);
 }
 
 void wsky_Dict_delete(Dict *self) {
@@ -40,60 +59,144 @@ void wsky_Dict_delete(Dict *self) {
 
 void wsky_Dict_apply(Dict *self,
                      void (*function)(const char *key, void *value)) {
-
-  Entry *entry = self->first;
-  while (entry) {
-    function(entry->key, entry->value);
-    entry = entry->next;
-  }
+  wsky_Dict_applyConst(self, function);
 }
 
 void wsky_Dict_applyConst(const Dict *self,
                           void (*function)(const char *key, void *value)) {
-
-  Entry *entry = self->first;
-  while (entry) {
-    function(entry->key, entry->value);
-    entry = entry->next;
+  for (uint32_t i = 0; i < self->entryCount; i++) {
+    const Entry *entry = self->entries + i;
+    if (!Entry_isRemoved(entry))
+      function(entry->key, entry->value);
   }
 }
 
+size_t wsky_Dict_getCount(const Dict *self) {
+  return self->entryCount - self->removedCount;
+}
+
+
+
+/* Returns the slot of the index table which points to the entry, or
+   the empty slot where it should be inserted */
+static uint32_t *findIndex(const Dict *self, Symbol key, uint32_t hash) {
+  uint32_t mask = self->indexCapacity - 1;
+  uint32_t *firstRemoved = NULL;
+  for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+    uint32_t *index = self->indices + i;
+    if (*index == EMPTY_INDEX)
+      return firstRemoved ? firstRemoved : index;
+    if (*index == REMOVED_INDEX) {
+      if (!firstRemoved)
+        firstRemoved = index;
+      continue;
+    }
+    if (self->entries[*index - 1].key == key)
+      return index;
+  }
+}
 
-static Entry *getEntry(const Dict *self, const char *key) {
-  Entry *entry = self->first;
-  while (entry) {
-    if (strcmp(key, entry->key) == 0) {
-      return entry;
+static Entry *getEntry(const Dict *self, Symbol key) {
+  if (!self->indices) {
+    for (uint32_t i = 0; i < self->entryCount; i++) {
+      Entry *entry = self->entries + i;
+      if (entry->key == key)
+        return entry;
     }
-    entry = entry->next;
+    return NULL;
   }
-  return NULL;
+
+  uint32_t index = *findIndex(self, key, wsky_Symbol_getHash(key));
+  if (index == EMPTY_INDEX || index == REMOVED_INDEX)
+    return NULL;
+  return self->entries + (index - 1);
 }
 
 bool wsky_Dict_contains(const Dict *self, const char *key) {
+  Symbol symbol = wsky_Symbol_find(key);
+  return symbol && getEntry(self, symbol);
+}
+
+bool wsky_Dict_containsSymbol(const Dict *self, Symbol key) {
   return getEntry(self, key) != NULL;
 }
 
-static Entry *newEntry(const char *key, void *value,
-                       Entry *previous, Entry *next) {
-  Entry *entry = wsky_safeMalloc(sizeof(Entry));
-  entry->key = wsky_strdup(key);
-  entry->value = value;
-  entry->previous = previous;
-  entry->next = next;
-  if (previous)
-    previous->next = entry;
-  if (next)
-    next->previous = entry;
-  return entry;
+
+
+/* Removes the removed entries from the entry array */
+static void compactEntries(Dict *self) {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < self->entryCount; i++) {
+    if (!Entry_isRemoved(self->entries + i))
+      self->entries[count++] = self->entries[i];
+  }
+  self->entryCount = count;
+  self->removedCount = 0;
+}
+
+static void rebuildIndices(Dict *self) {
+  uint32_t liveCount = self->entryCount;
+  if (liveCount <= MAX_LINEAR_COUNT) {
+    wsky_free(self->indices);
+    self->indices = NULL;
+    self->indexCapacity = 0;
+    return;
+  }
+
+  uint32_t capacity = 16;
+  while (capacity < liveCount * 2)
+    capacity *= 2;
+
+  if (capacity != self->indexCapacity) {
+    wsky_free(self->indices);
+    self->indices = wsky_safeMalloc(capacity * sizeof(uint32_t));
+    self->indexCapacity = capacity;
+  }
+  memset(self->indices, 0, capacity * sizeof(uint32_t));
+
+  uint32_t mask = capacity - 1;
+  for (uint32_t i = 0; i < self->entryCount; i++) {
+    uint32_t slot = self->entries[i].hash & mask;
+    while (self->indices[slot] != EMPTY_INDEX)
+      slot = (slot + 1) & mask;
+    self->indices[slot] = i + 1;
+  }
 }
 
-static void add(Dict *self, const char *key, void *value) {
-  Entry *entry = newEntry(key, value, NULL, self->first);
-  self->first = entry;
+static void grow(Dict *self) {
+  compactEntries(self);
+
+  if (self->entryCount == self->entryCapacity) {
+    uint32_t capacity = self->entryCapacity ? self->entryCapacity * 2 : 4;
+    self->entries = wsky_realloc(self->entries, capacity * sizeof(Entry));
+    if (!self->entries)
+      abort();
+    self->entryCapacity = capacity;
+  }
+
+  rebuildIndices(self);
 }
 
-void wsky_Dict_set(Dict *self, const char *key, void *value) {
+static void add(Dict *self, Symbol key, void *value) {
+  if (self->entryCount == self->entryCapacity ||
+      (self->indices && (self->entryCount + 1) * 2 > self->indexCapacity) ||
+      (!self->indices && self->entryCount == MAX_LINEAR_COUNT))
+    grow(self);
+
+  uint32_t hash = wsky_Symbol_getHash(key);
+  uint32_t entryIndex = self->entryCount++;
+  Entry *entry = self->entries + entryIndex;
+  entry->key = key;
+  entry->hash = hash;
+  entry->value = value;
+
+  if (self->indices)
+    *findIndex(self, key, hash) = entryIndex + 1;
+  else if (self->entryCount > MAX_LINEAR_COUNT)
+    rebuildIndices(self);
+}
+
+void wsky_Dict_setSymbol(Dict *self, Symbol key, void *value) {
   Entry *entry = getEntry(self, key);
   if (entry) {
     entry->value = value;
@@ -102,29 +205,44 @@ void wsky_Dict_set(Dict *self, const char *key, void *value) {
   }
 }
 
-void *wsky_Dict_get(wsky_Dict *self, const char *key) {
+void wsky_Dict_set(Dict *self, const char *key, void *value) {
+  wsky_Dict_setSymbol(self, wsky_Symbol_intern(key), value);
+}
+
+void *wsky_Dict_getSymbol(const Dict *self, Symbol key) {
   Entry *entry = getEntry(self, key);
   if (!entry)
     return NULL;
   return entry->value;
 }
 
-void *wsky_Dict_remove(wsky_Dict *self, const char *key) {
-  Entry *entry = getEntry(self, key);
-  if (!entry)
+void *wsky_Dict_get(const Dict *self, const char *key) {
+  Symbol symbol = wsky_Symbol_find(key);
+  if (!symbol)
     return NULL;
+  return wsky_Dict_getSymbol(self, symbol);
+}
 
-  Entry *previous = entry->previous;
-  Entry *next = entry->next;
-  if (self->first == entry) {
-    self->first = next;
+void *wsky_Dict_remove(Dict *self, const char *key) {
+  Symbol symbol = wsky_Symbol_find(key);
+  if (!symbol)
+    return NULL;
+
+  Entry *entry;
+  if (self->indices) {
+    uint32_t *index = findIndex(self, symbol, wsky_Symbol_getHash(symbol));
+    if (*index == EMPTY_INDEX || *index == REMOVED_INDEX)
+      return NULL;
+    entry = self->entries + (*index - 1);
+    *index = REMOVED_INDEX;
+  } else {
+    entry = getEntry(self, symbol);
+    if (!entry)
+      return NULL;
   }
-  if (next)
-    next->previous = previous;
-  if (previous)
-    previous->next = next;
+
   void *value = entry->value;
-  wsky_free(entry->key);
-  wsky_free(entry);
+  entry->key = NULL;
+  self->removedCount++;
   return value;
 }
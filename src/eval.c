@@ -1,7 +1,7 @@
 #include <ctype.h>
 #include <assert.h>
 #include <string.h>
-#include "whiskey_private.h"
+#include "eval_private.h"
 
 
 typedef struct {
@@ -122,19 +122,19 @@ static Result evalBinOperatorValues(Value left,
                                          Operator operator,
                                          Value right,
                                          bool reverse) {
-  switch (left.type) {
+  switch (Value_getType(left)) {
   case Type_BOOL:
-    return evalBinOperatorBool(left.v.boolValue, operator, right);
+    return evalBinOperatorBool(Value_toBool(left), operator, right);
 
   case Type_INT:
-    return evalBinOperatorInt(left.v.intValue, operator, right);
+    return evalBinOperatorInt(Value_toInt(left), operator, right);
 
   case Type_FLOAT:
-    return evalBinOperatorFloat(left.v.floatValue, operator, right);
+    return evalBinOperatorFloat(Value_toFloat(left), operator, right);
 
   case Type_OBJECT: {
     const char *method = getBinOperatorMethodName(operator, reverse);
-    Object *object = left.v.objectValue;
+    Object *object = Value_toObject(left);
     return wsky_Object_callMethod1(object, method, right);
   }
   }
@@ -145,15 +145,15 @@ static Result evalBinOperatorValues(Value left,
 static Result evalUnaryOperatorValues(Operator operator,
                                            Value right) {
 
-  switch (right.type) {
+  switch (Value_getType(right)) {
   case Type_BOOL:
-    return evalUnaryOperatorBool(operator, right.v.boolValue);
+    return evalUnaryOperatorBool(operator, Value_toBool(right));
 
   case Type_INT:
-    return evalUnaryOperatorInt(operator, right.v.intValue);
+    return evalUnaryOperatorInt(operator, Value_toInt(right));
 
   case Type_FLOAT:
-    return evalUnaryOperatorFloat(operator, right.v.floatValue);
+    return evalUnaryOperatorFloat(operator, Value_toFloat(right));
 
   default:
     return createUnsupportedUnaryOpError(wsky_Operator_toString(operator),
@@ -192,11 +192,16 @@ static Result evalBinOperator(const Node *leftNode,
   if (leftRV.exception)
     return leftRV;
 
-  Result rightRV = wsky_evalNode(rightNode, scope);
-  if (rightRV.exception)
-    return rightRV;
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  Value *left = wsky_Handle_new(leftRV.v);
 
-  return wsky_doBinaryOperation(leftRV.v, operator, rightRV.v);
+  Result rv = wsky_evalNode(rightNode, scope);
+  if (!rv.exception)
+    rv = wsky_doBinaryOperation(*left, operator, rv.v);
+
+  wsky_HandleScope_close(&handleScope);
+  return rv;
 }
 
 
@@ -246,9 +251,10 @@ Result wsky_evalSequence(const SequenceNode *node,
 
 static Result evalSequence(const SequenceNode *node,
                                 Scope *parentScope) {
-  Scope *innerScope = wsky_Scope_new(parentScope,
-                                     parentScope->defClass,
-                                     parentScope->self);
+  Scope *innerScope = wsky_Scope_newWithSlots(parentScope,
+                                              parentScope->defClass,
+                                              parentScope->self,
+                                              node->slotCount);
   wsky_eval_pushScope(innerScope);
   Result rv = wsky_evalSequence(node, innerScope);
   wsky_eval_popScope();
@@ -262,8 +268,15 @@ static Result createAlreadyDeclaredNameError(const char *name) {
   RAISE_EXCEPTION(e);
 }
 
-static Result declareVariable(const char *name, Value value,
-                                   Scope *scope) {
+Result wsky_eval_declareVariable(Scope *scope, const char *name, int slot,
+                                 Value value) {
+  if (slot != -1) {
+    if (wsky_Scope_isSlotDeclared(scope, (unsigned)slot))
+      return createAlreadyDeclaredNameError(name);
+    wsky_Scope_declareSlot(scope, (unsigned)slot, name, value);
+    RETURN_VALUE(value);
+  }
+
   if (wsky_Scope_containsVariableLocally(scope, name))
     return createAlreadyDeclaredNameError(name);
 
@@ -279,7 +292,7 @@ static Result evalVar(const VarNode *n, Scope *scope) {
       return rv;
     value = rv.v;
   }
-  return declareVariable(n->name, value, scope);
+  return wsky_eval_declareVariable(scope, n->name, n->slot, value);
 }
 
 
@@ -291,15 +304,24 @@ static Result raiseUndeclaredNameError(const char *name) {
 }
 
 
-static Result evalIdentifier(const IdentifierNode *n, Scope *scope) {
-  const char *name = n->name;
+Result wsky_eval_getVariable(Scope *scope, const char *name) {
   if (!wsky_Scope_containsVariable(scope, name))
     return raiseUndeclaredNameError(name);
 
   RETURN_VALUE(wsky_Scope_getVariable(scope, name));
 }
 
-static Result evalSelf(Scope *scope) {
+static Result evalIdentifier(const IdentifierNode *n, Scope *scope) {
+  if (n->depth != -1) {
+    Value *value = wsky_Scope_getSlot(scope, (unsigned)n->depth, n->slot);
+    if (value)
+      RETURN_VALUE(*value);
+  }
+
+  return wsky_eval_getVariable(scope, n->name);
+}
+
+Result wsky_eval_getSelf(Scope *scope) {
   if (!scope->self)
     RAISE_NEW_EXCEPTION("'@' used outside of a class");
   RETURN_OBJECT(scope->self);
@@ -311,8 +333,7 @@ static Result evalSuper(Scope *scope) {
   RAISE_NEW_EXCEPTION("'super' used outside of a member access");
 }
 
-static Result evalSuperclass(Scope *scope) {
-  (void)scope;
+Result wsky_eval_getSuperclass(Scope *scope) {
     if (!scope->self)
       RAISE_NEW_EXCEPTION("'superclass' used outside of a class");
     RETURN_OBJECT((Object *)scope->self->class->super);
@@ -320,14 +341,22 @@ static Result evalSuperclass(Scope *scope) {
 
 
 static Result assignToVariable(Value right,
-                                    const char *name,
+                                    const IdentifierNode *identifier,
                                     Scope *scope) {
+  if (identifier->depth != -1 &&
+      wsky_Scope_setSlot(scope, (unsigned)identifier->depth,
+                         identifier->slot, right))
+    RETURN_VALUE(right);
+
+  return wsky_eval_setVariable(scope, identifier->name, right);
+}
 
+Result wsky_eval_setVariable(Scope *scope, const char *name, Value value) {
   if (!wsky_Scope_containsVariable(scope, name))
     return raiseUndeclaredNameError(name);
 
-  wsky_Scope_setVariable(scope, name, right);
-  RETURN_VALUE(right);
+  wsky_Scope_setVariable(scope, name, value);
+  RETURN_VALUE(value);
 }
 
 static Exception *createImmutableObjectError(Value value) {
@@ -350,7 +379,8 @@ static bool isMutableObject(Object *object) {
 static Result assignToObject(Object *object,
                                   const char *attribute,
                                   Value right,
-                                  Scope *scope) {
+                                  Scope *scope,
+                                  InlineCache *cache) {
   if (!isMutableObject(object)) {
     Exception *e = createImmutableObjectError(Value_fromObject(object));
     RAISE_EXCEPTION(e);
@@ -361,37 +391,49 @@ static Result assignToObject(Object *object,
 
   bool privateAccess = object == scope->self;
   if (object && privateAccess)
-    return wsky_Class_setPrivate(scope->defClass, object,
-                                 attribute, right);
+    return wsky_Class_setPrivateCached(scope->defClass, object,
+                                       attribute, right, cache);
   else
-    return wsky_Class_set(wsky_Object_getClass(object), object,
-                          attribute, right);
+    return wsky_Class_setCached(wsky_Object_getClass(object), object,
+                                attribute, right, cache);
 }
 
-static Result assignToMember(Node *leftNode,
-                                  const char *attribute,
+Result wsky_eval_setSuperMember(Scope *scope, const char *attribute,
+                                Value right) {
+  if (!scope->defClass)
+    RAISE_NEW_EXCEPTION("'super' used outside of a class");
+  if (!scope->defClass->super)
+    RAISE_NEW_EXCEPTION("No superclass");
+  Object *object = scope->self;
+  return wsky_Class_set(scope->defClass->super, object,
+                        attribute, right);
+}
+
+Result wsky_eval_setMember(Scope *scope, Value left, const char *attribute,
+                           Value right, InlineCache *cache) {
+  if (Value_getType(left) != Type_OBJECT)
+    RAISE_EXCEPTION(createImmutableObjectError(left));
+
+  return assignToObject(Value_toObject(left), attribute, right, scope, cache);
+}
+
+static Result assignToMember(MemberAccessNode *member,
                                   Value right,
                                   Scope *scope) {
-  if (leftNode->type == wsky_ASTNodeType_SUPER) {
-    if (!scope->defClass)
-      RAISE_NEW_EXCEPTION("'super' used outside of a class");
-    if (!scope->defClass->super)
-      RAISE_NEW_EXCEPTION("No superclass");
-    Object *object = scope->self;
-    return wsky_Class_set(scope->defClass->super, object,
-                          attribute, right);
-  }
+  if (member->left->type == wsky_ASTNodeType_SUPER)
+    return wsky_eval_setSuperMember(scope, member->name, right);
 
-  Result rv = wsky_evalNode(leftNode, scope);
-  if (rv.exception)
-    return rv;
-
-  if (rv.v.type != Type_OBJECT)
-    RAISE_EXCEPTION(createImmutableObjectError(rv.v));
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  Value *rightHandle = wsky_Handle_new(right);
 
-  Object *object = rv.v.v.objectValue;
+  Result rv = wsky_evalNode(member->left, scope);
+  if (!rv.exception)
+    rv = wsky_eval_setMember(scope, rv.v, member->name, *rightHandle,
+                             &member->cache);
 
-  return assignToObject(object, attribute, right, scope);
+  wsky_HandleScope_close(&handleScope);
+  return rv;
 }
 
 static Result evalAssignment(const AssignmentNode *n,
@@ -405,11 +447,11 @@ static Result evalAssignment(const AssignmentNode *n,
 
   if (leftNode->type == wsky_ASTNodeType_IDENTIFIER) {
     IdentifierNode *id = (IdentifierNode *) leftNode;
-    return assignToVariable(right.v, id->name, scope);
+    return assignToVariable(right.v, id, scope);
   }
   if (leftNode->type == wsky_ASTNodeType_MEMBER_ACCESS) {
     MemberAccessNode *member = (MemberAccessNode *) leftNode;
-    return assignToMember(member->left, member->name, right.v, scope);
+    return assignToMember(member, right.v, scope);
   }
 
   RAISE_NEW_EXCEPTION("Not assignable expression");
@@ -422,14 +464,14 @@ static Result evalFunction(const FunctionNode *n, Scope *scope) {
 }
 
 
+/**
+ * Evaluates the parameters of a call into an array of handles, which are
+ * then passed to the callee without being copied.
+ */
 static Result evalParameters(Value *values,
-                                  unsigned valueCount,
+                                  unsigned paramCount,
                                   const NodeList *nodes,
                                   Scope *scope) {
-  unsigned paramCount = wsky_ASTNodeList_getCount(nodes);
-  if (paramCount > valueCount)
-    RAISE_NEW_EXCEPTION("Too many parameters");
-
   for (unsigned i = 0; i < paramCount; i++) {
     Result rv = wsky_evalNode(nodes->node, scope);
     if (rv.exception)
@@ -442,18 +484,11 @@ static Result evalParameters(Value *values,
 }
 
 
-static Result callMethod(Object *instanceMethod_,
-                              unsigned parameterCount,
-                              Value *parameters) {
-  InstanceMethod *instanceMethod;
-  instanceMethod = (InstanceMethod *) instanceMethod_;
-  Method *method = instanceMethod->method;
-
-  Value self = instanceMethod->self;
-
-  if (self.type == Type_OBJECT && self.v.objectValue) {
+Result wsky_eval_callMethod(Method *method, Value self,
+                            unsigned parameterCount, Value *parameters) {
+  if (Value_getType(self) == Type_OBJECT && Value_toObject(self)) {
     return wsky_Method_call(method,
-                            self.v.objectValue,
+                            Value_toObject(self),
                             parameterCount,
                             parameters);
   }
@@ -464,6 +499,15 @@ static Result callMethod(Object *instanceMethod_,
                                parameters);
 }
 
+static Result callMethod(Object *instanceMethod_,
+                              unsigned parameterCount,
+                              Value *parameters) {
+  InstanceMethod *instanceMethod;
+  instanceMethod = (InstanceMethod *) instanceMethod_;
+  return wsky_eval_callMethod(instanceMethod->method, instanceMethod->self,
+                              parameterCount, parameters);
+}
+
 static inline Result callClass(Class *class,
                                     unsigned parameterCount,
                                     Value *parameters) {
@@ -483,82 +527,147 @@ static Exception *createNotCallableError(Value value) {
   return e;
 }
 
-static Result evalSuperCall(const CallNode *callNode, Scope *scope) {
+Result wsky_eval_callSuper(Scope *scope,
+                           unsigned parameterCount, Value *parameters) {
     Class *class = scope->defClass;
     if (!class)
       RAISE_NEW_EXCEPTION("'super' used outside of a class");
     if (!class->super)
       RAISE_NEW_EXCEPTION("No superclass");
 
-    Value parameters[32];
-
-    Result rv = evalParameters(parameters, 32,
-                                    callNode->children, scope);
+    Object *self = scope->self;
+    Result rv = wsky_Method_call(class->super->constructor, self,
+                                 parameterCount, parameters);
     if (rv.exception)
       return rv;
+    RETURN_OBJECT(self);
+}
 
+static Result evalSuperCall(const CallNode *callNode, Scope *scope) {
+    if (!scope->defClass)
+      RAISE_NEW_EXCEPTION("'super' used outside of a class");
+    if (!scope->defClass->super)
+      RAISE_NEW_EXCEPTION("No superclass");
+
+    HandleScope handleScope;
+    wsky_HandleScope_open(&handleScope);
     unsigned paramCount = wsky_ASTNodeList_getCount(callNode->children);
+    Value *parameters = wsky_Handle_newArray(paramCount);
 
-    Object *self = scope->self;
-    rv = wsky_Method_call(class->super->constructor, self,
-                                      paramCount, parameters);
-    if (rv.exception)
-      return rv;
-    RETURN_OBJECT(self);
+    Result rv = evalParameters(parameters, paramCount,
+                                    callNode->children, scope);
+    if (!rv.exception)
+      rv = wsky_eval_callSuper(scope, paramCount, parameters);
+
+    wsky_HandleScope_close(&handleScope);
+    return rv;
 }
 
-static Result evalCall(const CallNode *callNode, Scope *scope) {
-  if (callNode->left->type == wsky_ASTNodeType_SUPER)
-    return evalSuperCall(callNode, scope);
+Result wsky_eval_call(Value callee,
+                      unsigned parameterCount, Value *parameters) {
+  if (Value_getType(callee) != Type_OBJECT) {
+    RAISE_EXCEPTION(createNotCallableError(callee));
+  }
 
-  Result rv = wsky_evalNode(callNode->left, scope);
+  if (wsky_isFunction(callee)) {
+    Object *function = Value_toObject(callee);
+    return wsky_Function_call((Function *) function,
+                              parameterCount, parameters);
+
+  } else if (wsky_isInstanceMethod(callee)) {
+    Object *instMethod = Value_toObject(callee);
+    return callMethod(instMethod, parameterCount, parameters);
+
+  } else if (wsky_isClass(callee)) {
+    Class *class = (Class *)Value_toObject(callee);
+    return callClass(class, parameterCount, parameters);
+  }
+
+  RAISE_EXCEPTION(createNotCallableError(callee));
+}
+
+/**
+ * Evaluates `left.attribute(parameters...)`. The method is called
+ * without creating an InstanceMethod.
+ */
+static Result evalMethodCall(const CallNode *callNode, Scope *scope) {
+  const MemberAccessNode *member = (const MemberAccessNode *)callNode->left;
+  InlineCache *cache = wsky_eval_getMemberCache(member);
+
+  Result rv = wsky_evalNode(member->left, scope);
   if (rv.exception)
     return rv;
 
-  Value parameters[32];
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  Value *self = wsky_Handle_new(rv.v);
+  Value *callee = NULL;
 
-  Result prv = evalParameters(parameters, 32,
-                                   callNode->children, scope);
-  if (prv.exception)
-    return prv;
+  Method *method = wsky_eval_findMethod(scope, *self, member->name, cache);
+  if (!method) {
+    rv = wsky_eval_getMember(scope, *self, member->name, cache);
+    if (rv.exception) {
+      wsky_HandleScope_close(&handleScope);
+      return rv;
+    }
+    callee = wsky_Handle_new(rv.v);
+  }
 
   unsigned paramCount = wsky_ASTNodeList_getCount(callNode->children);
+  Value *parameters = wsky_Handle_newArray(paramCount);
 
-  if (rv.v.type != Type_OBJECT) {
-    RAISE_EXCEPTION(createNotCallableError(rv.v));
+  rv = evalParameters(parameters, paramCount, callNode->children, scope);
+  if (!rv.exception) {
+    if (method)
+      rv = wsky_eval_callMethod(method, *self, paramCount, parameters);
+    else
+      rv = wsky_eval_call(*callee, paramCount, parameters);
   }
 
-  if (wsky_isFunction(rv.v)) {
-    Object *function = rv.v.v.objectValue;
-    rv = wsky_Function_call((Function *) function,
-                            paramCount, parameters);
-
-  } else if (wsky_isInstanceMethod(rv.v)) {
-    Object *instMethod = rv.v.v.objectValue;
-    rv = callMethod(instMethod, paramCount, parameters);
+  wsky_HandleScope_close(&handleScope);
+  return rv;
+}
 
-  } else if (wsky_isClass(rv.v)) {
-    Class *class = (Class *)rv.v.v.objectValue;
-    rv = callClass(class, paramCount, parameters);
+static Result evalCall(const CallNode *callNode, Scope *scope) {
+  if (callNode->left->type == wsky_ASTNodeType_SUPER)
+    return evalSuperCall(callNode, scope);
 
-  } else {
-    RAISE_EXCEPTION(createNotCallableError(rv.v));
+  if (callNode->left->type == wsky_ASTNodeType_MEMBER_ACCESS) {
+    const MemberAccessNode *member;
+    member = (const MemberAccessNode *)callNode->left;
+    if (member->left->type != wsky_ASTNodeType_SUPER)
+      return evalMethodCall(callNode, scope);
   }
 
+  Result rv = wsky_evalNode(callNode->left, scope);
+  if (rv.exception)
+    return rv;
+
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  Value *callee = wsky_Handle_new(rv.v);
+  unsigned paramCount = wsky_ASTNodeList_getCount(callNode->children);
+  Value *parameters = wsky_Handle_newArray(paramCount);
+
+  rv = evalParameters(parameters, paramCount, callNode->children, scope);
+  if (!rv.exception)
+    rv = wsky_eval_call(*callee, paramCount, parameters);
+
+  wsky_HandleScope_close(&handleScope);
   return rv;
 }
 
 static Result getFallbackMember(Class *class, Value self,
                                      const char *attribute) {
   if (class == wsky_Module_CLASS) {
-    assert(self.type == Type_OBJECT);
+    assert(Value_getType(self) == Type_OBJECT);
 
-    Module *module = (Module *)self.v.objectValue;
+    Module *module = (Module *)Value_toObject(self);
     Value *member = wsky_Dict_get(&module->members, attribute);
     if (member)
       RETURN_VALUE(*member);
   } else if (class == wsky_Structure_CLASS) {
-    return wsky_Structure_get((Structure *)self.v.objectValue,
+    return wsky_Structure_get((Structure *)Value_toObject(self),
                               attribute);
   }
 
@@ -566,10 +675,12 @@ static Result getFallbackMember(Class *class, Value self,
 }
 
 static Result getMemberOfNativeClass(Value self,
-                                          const char *attribute) {
+                                          const char *attribute,
+                                          InlineCache *cache) {
   Class *class = wsky_getClass(self);
 
-  Method *method = wsky_Class_findMethodOrGetter(class, attribute);
+  Method *method = wsky_InlineCache_findMethodOrGetter(cache, class,
+                                                       attribute);
   if (!method)
     return getFallbackMember(class, self, attribute);
 
@@ -577,7 +688,7 @@ static Result getMemberOfNativeClass(Value self,
     if (method->flags & wsky_MethodFlags_VALUE)
       return wsky_Method_callValue0(method, self);
     else
-      return wsky_Method_call0(method, self.v.objectValue);
+      return wsky_Method_call0(method, Value_toObject(self));
   }
 
   InstanceMethod *im = wsky_InstanceMethod_new(method, self);
@@ -585,39 +696,74 @@ static Result getMemberOfNativeClass(Value self,
 }
 
 static Result getAttribute(Object *object, const char *attribute,
-                                Scope *scope) {
+                                Scope *scope, InlineCache *cache) {
   bool privateAccess = object == scope->self;
   if (object && privateAccess)
-    return wsky_Class_getPrivate(scope->defClass, object, attribute);
+    return wsky_Class_getPrivateCached(scope->defClass, object, attribute,
+                                       cache);
   else
-    return wsky_Class_get(wsky_Object_getClass(object), object,
-                          attribute);
+    return wsky_Class_getCached(wsky_Object_getClass(object), object,
+                                attribute, cache);
+}
+
+Result wsky_eval_getSuperMember(Scope *scope, const char *attribute) {
+  if (!scope->defClass)
+    RAISE_NEW_EXCEPTION("'super' used outside of a class");
+  if (!scope->defClass->super)
+    RAISE_NEW_EXCEPTION("No superclass");
+  Object *object = scope->self;
+  return wsky_Class_get(scope->defClass->super, object, attribute);
+}
+
+Result wsky_eval_getMember(Scope *scope, Value left, const char *attribute,
+                           InlineCache *cache) {
+  if (Value_getType(left) != Type_OBJECT)
+    return getMemberOfNativeClass(left, attribute, cache);
+
+  Object *object = Value_toObject(left);
+
+  if (wsky_Object_getClass(object)->native)
+    return getMemberOfNativeClass(left, attribute, cache);
+
+  return getAttribute(object, attribute, scope, cache);
+}
+
+Method *wsky_eval_findMethod(Scope *scope, Value left,
+                             const char *attribute, InlineCache *cache) {
+  Class *class = wsky_getClass(left);
+  bool publicAccess = false;
+
+  if (!class->native) {
+    Object *object = Value_toObject(left);
+    if (object == scope->self) {
+      class = scope->defClass;
+      if (!wsky_Object_isA(object, class))
+        return NULL;
+    } else {
+      publicAccess = true;
+    }
+  }
+
+  Method *method = wsky_InlineCache_findMethodOrGetter(cache, class,
+                                                       attribute);
+  if (!method || (method->flags & wsky_MethodFlags_GET))
+    return NULL;
+  if (publicAccess && !(method->flags & wsky_MethodFlags_PUBLIC))
+    return NULL;
+  return method;
 }
 
 static Result evalMemberAccess(const MemberAccessNode *dotNode,
                                     Scope *scope) {
-  if (dotNode->left->type == wsky_ASTNodeType_SUPER) {
-    if (!scope->defClass)
-      RAISE_NEW_EXCEPTION("'super' used outside of a class");
-    if (!scope->defClass->super)
-      RAISE_NEW_EXCEPTION("No superclass");
-    Object *object = scope->self;
-    return wsky_Class_get(scope->defClass->super, object, dotNode->name);
-  }
+  if (dotNode->left->type == wsky_ASTNodeType_SUPER)
+    return wsky_eval_getSuperMember(scope, dotNode->name);
 
   Result rv = wsky_evalNode(dotNode->left, scope);
   if (rv.exception)
     return rv;
 
-  if (rv.v.type != Type_OBJECT)
-    return getMemberOfNativeClass(rv.v, dotNode->name);
-
-  Object *object = rv.v.v.objectValue;
-
-  if (wsky_Object_getClass(object)->native)
-    return getMemberOfNativeClass(rv.v, dotNode->name);
-
-  return getAttribute(object, dotNode->name, scope);
+  return wsky_eval_getMember(scope, rv.v, dotNode->name,
+                             wsky_eval_getMemberCache(dotNode));
 }
 
 
@@ -631,7 +777,7 @@ static Result evalClassMember(Class *class,
     if (rv.exception)
       return rv;
     assert(wsky_isFunction(rv.v));
-    right = (Function *)rv.v.v.objectValue;
+    right = (Function *)Value_toObject(rv.v);
   } else {
     assert((memberNode->flags & wsky_MethodFlags_SET) ||
            (memberNode->flags & wsky_MethodFlags_GET));
@@ -652,6 +798,7 @@ static void addMethodToClass(Class *class, Method *method) {
   MethodFlags flags = method->flags;
 
   assert(!class->native);
+  wsky_GC_writeBarrierObject(class, method);
 
   if (flags & wsky_MethodFlags_INIT)
     class->constructor = method;
@@ -659,6 +806,7 @@ static void addMethodToClass(Class *class, Method *method) {
     wsky_Dict_set(class->setters, method->name, method);
   else
     wsky_Dict_set(class->methods, method->name, method);
+  wsky_Class_updateVersion(class);
 }
 
 
@@ -693,7 +841,7 @@ static Result createClass(const ClassNode *classNode,
   if (!wsky_isClass(rv.v))
     RAISE_NEW_PARAMETER_ERROR("Invalid superclass");
 
-  Class *super = (Class *)rv.v.v.objectValue;
+  Class *super = (Class *)Value_toObject(rv.v);
   if (super->final)
     RAISE_NEW_PARAMETER_ERROR("Cannot extend a final class");
 
@@ -708,7 +856,7 @@ static Result evalClass(const ClassNode *classNode, Scope *scope) {
   Result rv = createClass(classNode, scope);
   if (rv.exception)
     return rv;
-  Class *class = (Class *)rv.v.v.objectValue;
+  Class *class = (Class *)Value_toObject(rv.v);
 
   for (NodeList *list = classNode->children; list; list = list->next) {
     Node *node = list->node;
@@ -717,14 +865,17 @@ static Result evalClass(const ClassNode *classNode, Scope *scope) {
     rv = evalClassMember(class, member, scope);
     if (rv.exception)
       return rv;
-    addMethodToClass(class, (Method *)rv.v.v.objectValue);
+    addMethodToClass(class, (Method *)Value_toObject(rv.v));
   }
 
-  if (!class->constructor)
+  if (!class->constructor) {
     class->constructor = createDefaultConstructor(class);
+    wsky_GC_writeBarrierObject(class, class->constructor);
+  }
 
   Value classValue = Value_fromObject((Object *)class);
-  return declareVariable(class->name, classValue, scope);
+  return wsky_eval_declareVariable(scope, class->name, classNode->slot,
+                                   classValue);
 }
 
 
@@ -815,7 +966,7 @@ static Result evalImport(const ImportNode *node, Scope *scope) {
         wsky_free(targetPath);
         return rv;
       }
-      module = (Module *)rv.v.v.objectValue;
+      module = (Module *)Value_toObject(rv.v);
     }
     wsky_free(targetPath);
 
@@ -824,9 +975,11 @@ static Result evalImport(const ImportNode *node, Scope *scope) {
   if (!module)
     return raiseNoModuleNamed(node->name);
 
-  return declareVariable(module->name,
-                         Value_fromObject((Object *)module),
-                         scope);
+  int slot = node->slot;
+  if (slot != -1 && strcmp(module->name, node->name) != 0)
+    slot = -1;
+  return wsky_eval_declareVariable(scope, module->name, slot,
+                                   Value_fromObject((Object *)module));
 }
 
 
@@ -838,7 +991,7 @@ static Result evalExport(const ExportNode *node, Scope *scope) {
     if (rv.exception)
       return rv;
     value = rv.v;
-    declareVariable(node->name, value, scope);
+    wsky_eval_declareVariable(scope, node->name, node->slot, value);
   } else {
     if (!wsky_Scope_containsVariable(scope, node->name))
       return raiseUndeclaredNameError(node->name);
@@ -851,6 +1004,14 @@ static Result evalExport(const ExportNode *node, Scope *scope) {
 }
 
 
+static Result evalTemplatePrint(const TpltPrintNode *node, Scope *scope) {
+  Result rv = wsky_evalNode(node->child, scope);
+  if (rv.exception)
+    return rv;
+  return wsky_Template_print(rv.v);
+}
+
+
 static Result evalIf(const IfNode *node, Scope *scope) {
   NodeList *tests = node->tests;
   NodeList *expressions = node->expressions;
@@ -862,7 +1023,7 @@ static Result evalIf(const IfNode *node, Scope *scope) {
       return rv;
     if (!wsky_isBoolean(rv.v))
       RAISE_NEW_TYPE_ERROR("Expected a Boolean");
-    if (rv.v.v.boolValue)
+    if (Value_toBool(rv.v))
       return wsky_evalNode(expressions->node, scope);
 
     expressions = expressions->next;
@@ -876,6 +1037,20 @@ static Result evalIf(const IfNode *node, Scope *scope) {
 }
 
 
+Result wsky_eval_matchException(Exception *exception, Value class_) {
+  if (!wsky_isClass(class_))
+    RAISE_NEW_TYPE_ERROR("Not an Exception");
+
+  Class *class = (Class *)Value_toObject(class_);
+  if (class != wsky_Exception_CLASS)
+    {
+      if (!wsky_Class_isSuperclassOf(wsky_Exception_CLASS, class))
+        RAISE_NEW_TYPE_ERROR("Not an Exception");
+    }
+
+  RETURN_BOOL(wsky_Object_isA((Object *)exception, class));
+}
+
 static Result isCorrespondingExcept(const ExceptNode *except,
                                          Exception *exception,
                                          Scope *scope) {
@@ -888,18 +1063,9 @@ static Result isCorrespondingExcept(const ExceptNode *except,
     if (rv.exception)
       return rv;
 
-    if (!wsky_isClass(rv.v))
-      RAISE_NEW_TYPE_ERROR("Not an Exception");
-
-    Class *class = (Class *)rv.v.v.objectValue;
-    if (class != wsky_Exception_CLASS)
-      {
-        if (!wsky_Class_isSuperclassOf(wsky_Exception_CLASS, class))
-          RAISE_NEW_TYPE_ERROR("Not an Exception");
-      }
-
-    if (wsky_Object_isA((Object *)exception, class))
-      RETURN_TRUE;
+    rv = wsky_eval_matchException(exception, rv.v);
+    if (rv.exception || Value_toBool(rv.v))
+      return rv;
 
     classes = classes->next;
   }
@@ -911,15 +1077,17 @@ static Result evalExcept(Exception *exception,
                               const ExceptNode *except,
                               Scope *scope) {
 
-  Scope *innerScope = wsky_Scope_new(scope, scope->defClass, scope->self);
+  Scope *innerScope = wsky_Scope_newWithSlots(scope,
+                                              scope->defClass, scope->self,
+                                              except->slotCount);
 
   wsky_eval_pushScope(innerScope);
 
   if (except->variable) {
     Result rv;
-    rv = declareVariable(except->variable,
-                         wsky_Value_fromObject((Object *)exception),
-                         innerScope);
+    rv = wsky_eval_declareVariable(innerScope,
+                                   except->variable, except->slot,
+                                   wsky_Value_fromObject((Object *)exception));
     if (rv.exception)
       return rv;
   }
@@ -942,24 +1110,38 @@ static Result evalTryImpl(const TryNode *tryNode, Scope *scope) {
 
   Exception *exception = rv.exception;
 
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  wsky_Handle_new(Value_fromObject((Object *)exception));
+
   for (size_t i = 0; i < tryNode->exceptCount; i++) {
     ExceptNode *except = tryNode->excepts + i;
-    rv = isCorrespondingExcept(except, exception, scope);
-    if (rv.exception)
-      return rv;
-
-    if (rv.v.v.boolValue)
-      return evalExcept(exception, except, scope);
+    Result crv = isCorrespondingExcept(except, exception, scope);
+    if (crv.exception || Value_toBool(crv.v)) {
+      rv = crv.exception ? crv : evalExcept(exception, except, scope);
+      break;
+    }
   }
 
-  RAISE_EXCEPTION(exception);
+  wsky_HandleScope_close(&handleScope);
+  return rv;
 }
 
 static Result evalTry(const TryNode *tryNode, Scope *scope) {
   Result rv = evalTryImpl(tryNode, scope);
 
   if (tryNode->finally) {
+    HandleScope handleScope;
+    wsky_HandleScope_open(&handleScope);
+    Value *value = wsky_Handle_new(rv.v);
+    Value *exception = wsky_Handle_new(
+      Value_fromObject((Object *)rv.exception));
+
     Result frv = wsky_evalNode(tryNode->finally, scope);
+    rv.v = *value;
+    rv.exception = (Exception *)Value_toObject(*exception);
+
+    wsky_HandleScope_close(&handleScope);
     if (frv.exception)
       return frv;
   }
@@ -988,8 +1170,12 @@ Result wsky_evalNode(const Node *node, Scope *scope) {
   CASE(SEQUENCE):
     return evalSequence((const SequenceNode *) node, scope);
 
-  CASE(STRING):
-    RETURN_C_STRING(TO_LITERAL_NODE(node)->v.stringValue);
+  CASE(STRING): {
+    const char *string = TO_LITERAL_NODE(node)->v.stringValue;
+    if (!*string)
+      RETURN_OBJECT((Object *)wsky_String_getEmpty());
+    RETURN_C_STRING(string);
+  }
 
   CASE(UNARY_OPERATOR):
   CASE(BINARY_OPERATOR):
@@ -1002,13 +1188,13 @@ Result wsky_evalNode(const Node *node, Scope *scope) {
     return evalIdentifier((const IdentifierNode *) node, scope);
 
   CASE(SELF):
-    return evalSelf(scope);
+    return wsky_eval_getSelf(scope);
 
   CASE(SUPER):
     return evalSuper(scope);
 
   CASE(SUPERCLASS):
-    return evalSuperclass(scope);
+    return wsky_eval_getSuperclass(scope);
 
   CASE(ASSIGNMENT):
     return evalAssignment((const AssignmentNode *) node, scope);
@@ -1037,6 +1223,12 @@ Result wsky_evalNode(const Node *node, Scope *scope) {
   CASE(TRY):
     return evalTry((const TryNode *) node, scope);
 
+  CASE(HTML):
+    return wsky_Template_writeHtml((const HtmlNode *) node);
+
+  CASE(TPLT_PRINT):
+    return evalTemplatePrint((const TpltPrintNode *) node, scope);
+
   default:
     fprintf(stderr,
             "wsky_evalNode(): Unsupported node type %d\n",
@@ -1055,11 +1247,21 @@ static Result raiseSyntaxError(ParserResult pr) {
   RAISE_EXCEPTION((Exception *)e);
 }
 
+/** Flushes the output of a template after its evaluation */
+static Result flushTemplateOutput(Result rv, TemplateOutput *output) {
+  if (!wsky_TemplateOutput_flush(output) && !rv.exception)
+    RAISE_NEW_EXCEPTION("Cannot write the output of the template");
+  return rv;
+}
+
 /**
  * @param pr The parser result
  * @param scope The scope or NULL
+ * @param output The output of a template or NULL. It is flushed before
+ * the AST is deleted, because it may refer to its HTML.
  */
-static Result evalFromParserResult(ParserResult pr, Scope *scope) {
+static Result evalFromParserResult(ParserResult pr, Scope *scope,
+                                   TemplateOutput *output) {
   if (!pr.success)
     return raiseSyntaxError(pr);
 
@@ -1067,8 +1269,23 @@ static Result evalFromParserResult(ParserResult pr, Scope *scope) {
     scope = wsky_Scope_newRoot(wsky_Module_newMain());
 
   wsky_eval_pushScope(scope);
+  if (output)
+    wsky_TemplateOutput_push(output);
+
+  wsky_resolveNode(pr.node);
+  Result rv;
+  if (wsky_vm_isEnabled()) {
+    wsky_Bytecode *bytecode = wsky_Bytecode_compile(pr.node);
+    rv = wsky_vm_run(bytecode, scope);
+    wsky_Bytecode_delete(bytecode);
+  } else {
+    rv = wsky_evalNode(pr.node, scope);
+  }
 
-  Result rv = wsky_evalNode(pr.node, scope);
+  if (output) {
+    wsky_TemplateOutput_pop();
+    rv = flushTemplateOutput(rv, output);
+  }
   wsky_ASTNode_delete(pr.node);
 
   wsky_eval_popScope();
@@ -1078,17 +1295,119 @@ static Result evalFromParserResult(ParserResult pr, Scope *scope) {
 
 
 Result wsky_evalString(const char *source, Scope *scope) {
-  return evalFromParserResult(wsky_parseString(source), scope);
+  return evalFromParserResult(wsky_parseString(source), scope, NULL);
+}
+
+
+/**
+ * Returns the retained cache entry of a file, and the file. The file is
+ * read and parsed if it is not in the cache or if it has changed.
+ */
+static Result getCachedFile(const char *filePath, bool template,
+                            CachedFile **entryPointer) {
+  char *absolutePath = wsky_path_getAbsolutePath(filePath);
+  if (!absolutePath)
+    RAISE_NEW_EXCEPTION("Invalid path");
+
+  FileStamp stamp;
+  if (!wsky_FileStamp_read(&stamp, absolutePath)) {
+    wsky_free(absolutePath);
+    RAISE_NEW_EXCEPTION("IO error");
+  }
+
+  CachedFile *entry = wsky_FileCache_find(absolutePath, template, &stamp);
+  if (!entry) {
+    Result rv = wsky_ProgramFile_new(absolutePath);
+    if (rv.exception) {
+      wsky_free(absolutePath);
+      return rv;
+    }
+
+    ProgramFile *file = (ProgramFile *)Value_toObject(rv.v);
+    ParserResult pr = (template ?
+                       wsky_parseTemplateFile(file) : wsky_parseFile(file));
+    if (!pr.success) {
+      wsky_free(absolutePath);
+      return raiseSyntaxError(pr);
+    }
+
+    wsky_resolveNode(pr.node);
+    entry = wsky_FileCache_add(file, template, &stamp, pr.node);
+  }
+  wsky_free(absolutePath);
+
+  wsky_FileCache_retain(entry);
+  *entryPointer = entry;
+  RETURN_OBJECT((Object *)entry->file);
 }
 
+/**
+ * Evaluates the program of a cache entry.
+ *
+ * @param scope The scope or NULL
+ */
+static Result evalCachedFile(CachedFile *entry, Scope *scope) {
+  if (!scope)
+    scope = wsky_Scope_newRoot(wsky_Module_newMain());
+
+  wsky_eval_pushScope(scope);
+
+  Result rv;
+  if (wsky_vm_isEnabled()) {
+    if (!entry->bytecode)
+      entry->bytecode = wsky_Bytecode_compile(entry->node);
+    rv = wsky_vm_run(entry->bytecode, scope);
+  } else {
+    rv = wsky_evalNode(entry->node, scope);
+  }
+
+  wsky_eval_popScope();
+
+  return rv;
+}
 
 Result wsky_evalFile(const char *filePath, Scope *scope) {
-  Result rv = wsky_ProgramFile_new(filePath);
+  CachedFile *entry;
+  Result rv = getCachedFile(filePath, false, &entry);
   if (rv.exception)
     return rv;
 
-  ProgramFile *file = (ProgramFile *)rv.v.v.objectValue;
-  return evalFromParserResult(wsky_parseFile(file), scope);
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  wsky_Handle_new(rv.v);
+
+  rv = evalCachedFile(entry, scope);
+
+  wsky_FileCache_release(entry);
+  wsky_HandleScope_close(&handleScope);
+  return rv;
+}
+
+Result wsky_evalTemplateString(const char *source, Scope *scope,
+                               TemplateOutput *output) {
+  return evalFromParserResult(wsky_parseTemplateString(source),
+                              scope, output);
+}
+
+Result wsky_evalTemplateFile(const char *filePath, Scope *scope,
+                             TemplateOutput *output) {
+  CachedFile *entry;
+  Result rv = getCachedFile(filePath, true, &entry);
+  if (rv.exception)
+    return rv;
+
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  wsky_Handle_new(rv.v);
+
+  wsky_TemplateOutput_push(output);
+  rv = evalCachedFile(entry, scope);
+  wsky_TemplateOutput_pop();
+  rv = flushTemplateOutput(rv, output);
+
+  wsky_FileCache_release(entry);
+  wsky_HandleScope_close(&handleScope);
+  return rv;
 }
 
 static bool isIdentifierStartChar(char c) {
@@ -1109,22 +1428,31 @@ static bool isValidIdentifier(const char *string) {
 }
 
 Result wsky_evalModuleFile(const char *filePath) {
-  Result rv = wsky_ProgramFile_new(filePath);
+  CachedFile *entry;
+  Result rv = getCachedFile(filePath, false, &entry);
   if (rv.exception)
     return rv;
 
-  ProgramFile *file = (ProgramFile *)rv.v.v.objectValue;
+  ProgramFile *file = entry->file;
   char *name = wsky_path_removeExtension(file->name);
   if (!isValidIdentifier(name)) {
     wsky_free(name);
+    wsky_FileCache_release(entry);
     RAISE_NEW_EXCEPTION("Invalid module file name");
   }
 
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  wsky_Handle_new(rv.v);
+
   Module *module = wsky_Module_new(name, false, file);
   wsky_free(name);
 
   Scope *scope = wsky_Scope_newRoot(module);
-  rv = evalFromParserResult(wsky_parseFile(file), scope);
+  rv = evalCachedFile(entry, scope);
+
+  wsky_FileCache_release(entry);
+  wsky_HandleScope_close(&handleScope);
   if (rv.exception)
     return rv;
 
@@ -3,14 +3,14 @@
 
 static Result boolAnd(bool left, Value right) {
   if (isBool(right)) {
-    RETURN_BOOL(left && right.v.intValue);
+    RETURN_BOOL(left && Value_toInt(right));
   }
   RETURN_NOT_IMPL("and");
 }
 
 static Result boolOr(bool left, Value right) {
   if (isBool(right)) {
-    RETURN_BOOL(left || right.v.boolValue);
+    RETURN_BOOL(left || Value_toBool(right));
   }
   RETURN_NOT_IMPL("or");
 }
@@ -18,14 +18,14 @@ static Result boolOr(bool left, Value right) {
 
 static Result boolEquals(bool left, Value right) {
   if (isBool(right)) {
-    RETURN_BOOL(left == right.v.intValue);
+    RETURN_BOOL(left == Value_toInt(right));
   }
   RETURN_NOT_IMPL("==");
 }
 
 static Result boolNotEquals(bool left, Value right) {
   if (isBool(right)) {
-    RETURN_BOOL(left != right.v.boolValue);
+    RETURN_BOOL(left != Value_toBool(right));
   }
   RETURN_NOT_IMPL("!=");
 }
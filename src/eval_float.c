@@ -4,10 +4,10 @@
 #define OP_TEMPLATE(op, opName)                                         \
   static Result float##opName(wsky_float left, Value right) {      \
     if (isInt(right)) {                                                 \
-      RETURN_FLOAT(left op right.v.intValue);                      \
+      RETURN_FLOAT(left op Value_toInt(right));                      \
     }                                                                   \
     if (isFloat(right)) {                                               \
-      RETURN_FLOAT(left op right.v.floatValue);                    \
+      RETURN_FLOAT(left op Value_toFloat(right));                    \
     }                                                                   \
     RETURN_NOT_IMPL(#op);                                               \
   }
@@ -23,10 +23,10 @@ OP_TEMPLATE(/, Slash)
 #define OP_TEMPLATE(op, opName)                                         \
   static Result float##opName(wsky_float left, Value right) {      \
     if (isInt(right)) {                                                 \
-      RETURN_BOOL(left op right.v.intValue);                       \
+      RETURN_BOOL(left op Value_toInt(right));                       \
     }                                                                   \
     if (isFloat(right)) {                                               \
-      RETURN_BOOL(left op right.v.floatValue);                     \
+      RETURN_BOOL(left op Value_toFloat(right));                     \
     }                                                                   \
     RETURN_NOT_IMPL(#op);                                               \
   }
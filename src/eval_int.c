@@ -5,10 +5,10 @@
 #define OP_TEMPLATE(op, opName)                                 \
   static Result int##opName(wsky_int left, Value right) {  \
     if (isInt(right)) {                                         \
-      RETURN_INT(left op right.v.intValue);                     \
+      RETURN_INT(left op Value_toInt(right));                     \
     }                                                           \
     if (isFloat(right)) {                                       \
-      RETURN_FLOAT(left op right.v.floatValue);                 \
+      RETURN_FLOAT(left op Value_toFloat(right));                 \
     }                                                           \
     RETURN_NOT_IMPL(#op);                                       \
   }
@@ -19,13 +19,13 @@ OP_TEMPLATE(*, Star)
 
 static Result intSlash(wsky_int left, Value right) {
   if (isInt(right)) {
-    wsky_int divisor = right.v.intValue;
+    wsky_int divisor = Value_toInt(right);
     if (divisor == 0)
       RAISE_EXCEPTION((Exception *)wsky_ZeroDivisionError_new());
     RETURN_INT(left / divisor);
   }
   if (isFloat(right)) {
-    RETURN_FLOAT(left / right.v.floatValue);
+    RETURN_FLOAT(left / Value_toFloat(right));
   }
   RETURN_NOT_IMPL("/");
 }
@@ -37,10 +37,10 @@ static Result intSlash(wsky_int left, Value right) {
 #define OP_TEMPLATE(op, opName)                                 \
   static Result int##opName(wsky_int left, Value right) {  \
     if (isInt(right)) {                                         \
-      RETURN_BOOL(left op right.v.intValue);                    \
+      RETURN_BOOL(left op Value_toInt(right));                    \
     }                                                           \
     if (isFloat(right)) {                                       \
-      RETURN_BOOL(left op right.v.floatValue);                  \
+      RETURN_BOOL(left op Value_toFloat(right));                  \
     }                                                           \
     RETURN_NOT_IMPL(#op);                                       \
   }
@@ -53,7 +53,7 @@ OP_TEMPLATE(>, GT)
 #define OP_TEMPLATE(op, opName)                                 \
   static Result int##opName(wsky_int left, Value right) {  \
     if (isInt(right)) {                                         \
-      RETURN_BOOL(left op right.v.intValue);                    \
+      RETURN_BOOL(left op Value_toInt(right));                    \
     }                                                           \
     RETURN_NOT_IMPL(#op);                                       \
   }
@@ -76,13 +76,13 @@ static Result evalBinOperatorInt(wsky_int left,
 
   case wsky_Operator_EQUALS:
     if (isInt(right)) {
-      RETURN_BOOL(left == right.v.intValue);
+      RETURN_BOOL(left == Value_toInt(right));
     }
     RETURN_NOT_IMPL(wsky_Operator_toString(operator));
 
   case wsky_Operator_NOT_EQUALS:
     if (isInt(right)) {
-      RETURN_BOOL(left != right.v.intValue);
+      RETURN_BOOL(left != Value_toInt(right));
     }
     RETURN_NOT_IMPL(wsky_Operator_toString(operator));
 
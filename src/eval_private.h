@@ -0,0 +1,81 @@
+#ifndef EVAL_PRIVATE_H
+# define EVAL_PRIVATE_H
+
+# include "whiskey_private.h"
+
+/*
+ * The value-level operations of the evaluator, shared by the tree-walking
+ * evaluator and the virtual machine.
+ */
+
+/**
+ * Declares a variable in the given scope.
+ *
+ * @param slot The slot of the variable or -1 to declare it by name
+ */
+Result wsky_eval_declareVariable(Scope *scope, const char *name, int slot,
+                                 Value value);
+
+/** Returns the value of a variable looked up by name */
+Result wsky_eval_getVariable(Scope *scope, const char *name);
+
+/** Assigns a variable looked up by name */
+Result wsky_eval_setVariable(Scope *scope, const char *name, Value value);
+
+/** Returns the value of `@` */
+Result wsky_eval_getSelf(Scope *scope);
+
+/** Returns the value of `superclass` */
+Result wsky_eval_getSuperclass(Scope *scope);
+
+/**
+ * Returns the inline cache of a member access node. The cache is the
+ * only mutable member of the node.
+ */
+static inline InlineCache *wsky_eval_getMemberCache(
+  const MemberAccessNode *node) {
+  return (InlineCache *)&node->cache;
+}
+
+/** Returns `left.attribute`, looking up the methods through a cache */
+Result wsky_eval_getMember(Scope *scope, Value left, const char *attribute,
+                           InlineCache *cache);
+
+/**
+ * Returns the method called by `left.attribute(...)`, looking it up
+ * through a cache, or NULL if the member is not a method. Then the
+ * member must be got with wsky_eval_getMember(), which raises the errors.
+ */
+Method *wsky_eval_findMethod(Scope *scope, Value left, const char *attribute,
+                             InlineCache *cache);
+
+/** Returns `super.attribute` */
+Result wsky_eval_getSuperMember(Scope *scope, const char *attribute);
+
+/** Evaluates `left.attribute = right`, with the cache of the left node */
+Result wsky_eval_setMember(Scope *scope, Value left, const char *attribute,
+                           Value right, InlineCache *cache);
+
+/** Evaluates `super.attribute = right` */
+Result wsky_eval_setSuperMember(Scope *scope, const char *attribute,
+                                Value right);
+
+/** Calls a function, a method or a class */
+Result wsky_eval_call(Value callee,
+                      unsigned parameterCount, Value *parameters);
+
+/** Calls a method with the given `self` */
+Result wsky_eval_callMethod(Method *method, Value self,
+                            unsigned parameterCount, Value *parameters);
+
+/** Evaluates `super(parameters...)` */
+Result wsky_eval_callSuper(Scope *scope,
+                           unsigned parameterCount, Value *parameters);
+
+/**
+ * Returns true if the exception is an instance of the given class.
+ * Raises a TypeError if the class is not an exception class.
+ */
+Result wsky_eval_matchException(Exception *exception, Value class);
+
+#endif /* EVAL_PRIVATE_H */
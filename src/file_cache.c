@@ -0,0 +1,180 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "whiskey_private.h"
+
+
+/** The most recently used entry */
+static CachedFile *first = NULL;
+
+/** The least recently used entry */
+static CachedFile *last = NULL;
+
+static size_t size = 0;
+static size_t capacity = wsky_FileCache_DEFAULT_CAPACITY;
+
+static size_t hitCount = 0;
+static size_t missCount = 0;
+
+
+bool wsky_FileStamp_read(FileStamp *stamp, const char *path) {
+  struct stat st;
+  if (stat(path, &st))
+    return false;
+  stamp->modificationTime = (int64_t)st.st_mtim.tv_sec * 1000000000 +
+    st.st_mtim.tv_nsec;
+  stamp->size = (int64_t)st.st_size;
+  stamp->inode = (uint64_t)st.st_ino;
+  stamp->device = (uint64_t)st.st_dev;
+  return true;
+}
+
+static bool FileStamp_equals(const FileStamp *a, const FileStamp *b) {
+  return a->modificationTime == b->modificationTime &&
+    a->size == b->size &&
+    a->inode == b->inode &&
+    a->device == b->device;
+}
+
+
+static void deleteEntry(CachedFile *entry) {
+  if (entry->bytecode)
+    wsky_Bytecode_delete(entry->bytecode);
+  wsky_ASTNode_delete(entry->node);
+  wsky_free(entry);
+}
+
+static void unlinkEntry(CachedFile *entry) {
+  if (entry->previous)
+    entry->previous->next = entry->next;
+  else
+    first = entry->next;
+  if (entry->next)
+    entry->next->previous = entry->previous;
+  else
+    last = entry->previous;
+  entry->previous = NULL;
+  entry->next = NULL;
+}
+
+static void pushFirst(CachedFile *entry) {
+  entry->next = first;
+  if (first)
+    first->previous = entry;
+  else
+    last = entry;
+  first = entry;
+}
+
+static void removeEntry(CachedFile *entry) {
+  unlinkEntry(entry);
+  size--;
+  entry->removed = true;
+  if (!entry->useCount)
+    deleteEntry(entry);
+}
+
+/** Removes the least recently used entries */
+static void shrink(size_t maxSize) {
+  CachedFile *entry = last;
+  while (size > maxSize && entry) {
+    CachedFile *previous = entry->previous;
+    removeEntry(entry);
+    entry = previous;
+  }
+}
+
+
+CachedFile *wsky_FileCache_find(const char *absolutePath, bool template,
+                                const FileStamp *stamp) {
+  for (CachedFile *entry = first; entry; entry = entry->next) {
+    if (entry->template != template ||
+        strcmp(entry->file->absolutePath, absolutePath) != 0)
+      continue;
+
+    if (!FileStamp_equals(&entry->stamp, stamp)) {
+      removeEntry(entry);
+      break;
+    }
+
+    hitCount++;
+    if (entry != first) {
+      unlinkEntry(entry);
+      pushFirst(entry);
+    }
+    return entry;
+  }
+
+  missCount++;
+  return NULL;
+}
+
+CachedFile *wsky_FileCache_add(ProgramFile *file, bool template,
+                               const FileStamp *stamp, Node *node) {
+  assert(file->absolutePath);
+
+  CachedFile *entry = wsky_safeMalloc(sizeof(CachedFile));
+  entry->file = file;
+  entry->template = template;
+  entry->stamp = *stamp;
+  entry->node = node;
+  entry->bytecode = NULL;
+  entry->useCount = 0;
+  entry->previous = NULL;
+  entry->next = NULL;
+
+  if (!capacity) {
+    entry->removed = true;
+    return entry;
+  }
+
+  shrink(capacity - 1);
+  entry->removed = false;
+  pushFirst(entry);
+  size++;
+  return entry;
+}
+
+void wsky_FileCache_retain(CachedFile *entry) {
+  entry->useCount++;
+}
+
+void wsky_FileCache_release(CachedFile *entry) {
+  assert(entry->useCount);
+  entry->useCount--;
+  if (!entry->useCount && entry->removed)
+    deleteEntry(entry);
+}
+
+
+void wsky_FileCache_setCapacity(size_t capacity_) {
+  capacity = capacity_;
+  shrink(capacity);
+}
+
+size_t wsky_FileCache_getCapacity(void) {
+  return capacity;
+}
+
+size_t wsky_FileCache_getSize(void) {
+  return size;
+}
+
+size_t wsky_FileCache_getHitCount(void) {
+  return hitCount;
+}
+
+size_t wsky_FileCache_getMissCount(void) {
+  return missCount;
+}
+
+void wsky_FileCache_clear(void) {
+  shrink(0);
+}
+
+void wsky_FileCache_visit(void) {
+  for (CachedFile *entry = first; entry; entry = entry->next)
+    wsky_GC_visitObject(entry->file);
+}
@@ -1,6 +1,7 @@
 #include <setjmp.h>
 #include <assert.h>
 #include <string.h>
+#include <time.h>
 #include "heaps.h"
 
 
@@ -8,24 +9,199 @@ void wsky_GC_unmarkAll(void) {
   wsky_heaps_unmark();
 }
 
-void wsky_GC_visitObject(void *objectVoid) {
-  Object *object = (Object *) objectVoid;
+static wsky_GC_Stats stats;
+
+
+/*
+ * The mark stack contains the gray objects: the marked objects whose
+ * children have not been visited yet.
+ *
+ * If the stack is full, the object stays marked without being pushed
+ * and the overflow flag is set. The heaps are then rescanned to visit
+ * the children of all marked objects.
+ */
+
+typedef struct {
+  Object **objects;
+  size_t count;
+  size_t capacity;
+  size_t limit;
+  bool overflowed;
+} MarkStack;
+
+static MarkStack markStack = {
+  .objects = NULL,
+  .count = 0,
+  .capacity = 0,
+  .limit = wsky_GC_DEFAULT_MARK_STACK_LIMIT,
+  .overflowed = false,
+};
+
+static bool MarkStack_grow(void) {
+  if (markStack.capacity >= markStack.limit)
+    return false;
+  size_t capacity = markStack.capacity ? markStack.capacity * 2 : 256;
+  if (capacity > markStack.limit)
+    capacity = markStack.limit;
+  Object **objects = wsky_realloc(markStack.objects,
+                                  capacity * sizeof(Object *));
+  if (!objects)
+    return false;
+  markStack.objects = objects;
+  markStack.capacity = capacity;
+  return true;
+}
+
+static void MarkStack_push(Object *object) {
+  if (markStack.count == markStack.capacity && !MarkStack_grow()) {
+    markStack.overflowed = true;
+    return;
+  }
+  markStack.objects[markStack.count++] = object;
+}
+
+static void MarkStack_free(void) {
+  wsky_free(markStack.objects);
+  markStack.objects = NULL;
+  markStack.count = 0;
+  markStack.capacity = 0;
+}
+
+/** Visits the children of the gray objects until the stack is empty */
+static void drainMarkStack(void) {
+  while (markStack.count)
+    wsky_Class_acceptGC(markStack.objects[--markStack.count]);
+}
+
+static void rescanMarkedObject(Object *object) {
+  if (object->_initialized) {
+    wsky_Class_acceptGC(object);
+    drainMarkStack();
+  }
+}
+
+/** True during a minor collection */
+static bool minorCollection = false;
+
+/** Visits the children of all gray objects, overflowed ones included */
+static void processMarkStack(void) {
+  drainMarkStack();
+  while (markStack.overflowed) {
+    stats.markStackOverflowCount++;
+    markStack.overflowed = false;
+    if (minorCollection)
+      wsky_heaps_forEachMarkedYoungObject(rescanMarkedObject);
+    else
+      wsky_heaps_forEachMarkedObject(rescanMarkedObject);
+  }
+}
+
+void wsky_GC_setMarkStackLimit(size_t limit) {
+  assert(limit > 0);
+  markStack.limit = limit;
+  MarkStack_free();
+}
+
+size_t wsky_GC_getMarkStackLimit(void) {
+  return markStack.limit;
+}
+
+
+/** The objects marked by the current collection */
+static size_t markedObjectCount = 0;
+static size_t markedBytes = 0;
+
+static void markObject(Object *object) {
   if (!object)
     return;
 
   assert(wsky_heaps_contains(object));
 
-  if (object->_gcMark)
+  if (object->_gcMark || (minorCollection && object->_gcOld))
     return;
   object->_gcMark = true;
+  markedObjectCount++;
+  markedBytes += wsky_heaps_getSlotSize(object);
 
   if (object->_initialized)
-    wsky_Class_acceptGC(object);
+    MarkStack_push(object);
+}
+
+
+
+/*
+ * The remembered set contains the old objects which may reference young
+ * objects. They are added by the write barrier.
+ */
+
+typedef struct {
+  Object **objects;
+  size_t count;
+  size_t capacity;
+} RememberedSet;
+
+static RememberedSet rememberedSet = {NULL, 0, 0};
+
+void wsky_GC_remember(Object *object) {
+  assert(object->_gcOld);
+  if (object->_gcRemembered)
+    return;
+  if (rememberedSet.count == rememberedSet.capacity) {
+    size_t capacity = rememberedSet.capacity ?
+      rememberedSet.capacity * 2 : 256;
+    Object **objects = wsky_realloc(rememberedSet.objects,
+                                    capacity * sizeof(Object *));
+    if (!objects)
+      abort();
+    rememberedSet.objects = objects;
+    rememberedSet.capacity = capacity;
+  }
+  object->_gcRemembered = true;
+  rememberedSet.objects[rememberedSet.count++] = object;
 }
 
-void wsky_GC_visitValue(Value value) {
-  if (value.type == Type_OBJECT) {
-    wsky_GC_visitObject(value.v.objectValue);
+static void visitRememberedSet(void) {
+  for (size_t i = 0; i < rememberedSet.count; i++) {
+    Object *object = rememberedSet.objects[i];
+    if (object->_initialized)
+      wsky_Class_acceptGC(object);
+  }
+}
+
+/** Must be called before the sweep */
+static void clearRememberedSet(void) {
+  for (size_t i = 0; i < rememberedSet.count; i++)
+    rememberedSet.objects[i]->_gcRemembered = false;
+  rememberedSet.count = 0;
+}
+
+static void RememberedSet_free(void) {
+  wsky_free(rememberedSet.objects);
+  rememberedSet.objects = NULL;
+  rememberedSet.count = 0;
+  rememberedSet.capacity = 0;
+}
+
+
+/** True while the references are updated after a compaction */
+static bool updatingReferences = false;
+
+void wsky_GC_visitObjectImpl(void *reference) {
+  Object **object = (Object **)reference;
+  if (updatingReferences) {
+    if (*object)
+      *object = wsky_heaps_getNewAddress(*object);
+    return;
+  }
+  markObject(*object);
+}
+
+void wsky_GC_visitValueImpl(Value *value) {
+  if (Value_getType(*value) == Type_OBJECT) {
+    Object *object = Value_toObject(*value);
+    wsky_GC_visitObject(object);
+    /* The object may have been moved */
+    *value = Value_fromObject(object);
   }
 }
 
@@ -46,20 +222,49 @@ static void visitModules(void) {
 static void visitBuiltins(void) {
   visitBuiltinClasses();
   visitModules();
+  wsky_String_visitCache();
+  wsky_FileCache_visit();
+}
+
+/*
+ * The ambiguous roots are the words of the C stack and the registers.
+ * They are visited with one of these functions.
+ */
+
+typedef void (*AmbiguousRootVisitor)(void *pointer);
+
+/** Returns the pointer of a word which may be a boxed value */
+static inline void *unboxAmbiguousRoot(void *word) {
+#ifdef WSKY_NAN_BOXING
+  uint64_t bits = (uint64_t)(uintptr_t)word;
+  if ((bits & wsky_Value_TAG_MASK) == wsky_Value_OBJECT_TAG)
+    return (void *)(uintptr_t)(bits & wsky_Value_PAYLOAD_MASK);
+#endif
+  return word;
+}
+
+static void markAmbiguousRoot(void *pointer) {
+  if (wsky_heaps_contains(pointer)) {
+    assert(((Object *)pointer)->class);
+    markObject((Object *)pointer);
+  }
+}
+
+/** The objects referenced by ambiguous roots cannot be moved */
+static void pinAmbiguousRoot(void *pointer) {
+  wsky_heaps_pin(pointer);
 }
 
 #define OBJECTS_ALIGNED_ON_STACK
 
 #ifdef OBJECTS_ALIGNED_ON_STACK
 
-static void visitObjectArray(void *pointers_, size_t size) {
+static void visitObjectArray(void *pointers_, size_t size,
+                             AmbiguousRootVisitor visitor) {
   Object **pointers = (Object **)pointers_;
   ptrdiff_t s = (ptrdiff_t)size;
   while (s > 0) {
-    if (wsky_heaps_contains(*pointers)) {
-      assert((*pointers)->class);
-      wsky_GC_visitObject(*pointers);
-    }
+    visitor(unboxAmbiguousRoot(*pointers));
     pointers++;
     s -= sizeof(Object *);
   }
@@ -67,31 +272,29 @@ static void visitObjectArray(void *pointers_, size_t size) {
 
 #else
 
-static void visitObjectArray(void *pointers_, size_t size) {
+static void visitObjectArray(void *pointers_, size_t size,
+                             AmbiguousRootVisitor visitor) {
   char *pointers = (char *)pointers_;
   while (size--) {
-    Object *object = *(Object **)pointers;
-    if (wsky_heaps_contains(object)) {
-      assert(object->class);
-      wsky_GC_visitObject(object);
-    }
+    visitor(unboxAmbiguousRoot(*(Object **)pointers));
     pointers++;
   }
 }
 
 #endif
 
-static void visitObjectPointers(void *start, void *end) {
+static void visitObjectPointers(void *start, void *end,
+                                AmbiguousRootVisitor visitor) {
   if (start > end) {
     void *tmp = start;
     start = end;
     end = tmp;
   }
   size_t size = (size_t)((char *)end - (char *)start + 1);
-  visitObjectArray(start, size);
+  visitObjectArray(start, size, visitor);
 }
 
-static void visitRegisters(void) {
+static void visitRegisters(AmbiguousRootVisitor visitor) {
   /* All registers must be saved into jmp_buf. */
   jmp_buf registers;
   setjmp(registers);
@@ -100,12 +303,12 @@ static void visitRegisters(void) {
   size_t count = sizeof(jmp_buf) / sizeof(Object **);
   visitObjectArray((Object **) registers, count);
   */
-  visitObjectArray((Object **) registers, sizeof(jmp_buf));
+  visitObjectArray((Object **) registers, sizeof(jmp_buf), visitor);
 }
 
 static void *stackStart = NULL;
 
-static void visitStack(void) {
+static void visitStack(AmbiguousRootVisitor visitor) {
   assert(stackStart);
   void *op = NULL;
   void **stackEnd = &op;
@@ -114,37 +317,190 @@ static void visitStack(void) {
   assert(wsky_heaps_contains(wsky_Object_CLASS));
   assert(wsky_heaps_contains(wsky_Exception_CLASS));
   assert(wsky_heaps_contains(wsky_String_CLASS));
-  visitObjectPointers(stackStart, (void *)stackEnd);
+  visitObjectPointers(stackStart, (void *)stackEnd, visitor);
 }
 
 
+static bool stressed = false;
+
+static bool compacting = false;
+
+static double growthFactor = wsky_GC_DEFAULT_GROWTH_FACTOR;
+static size_t minimumThreshold = wsky_GC_DEFAULT_MINIMUM_THRESHOLD;
+
+/** The allocated bytes which trigger the next collection */
+static size_t threshold = wsky_GC_DEFAULT_MINIMUM_THRESHOLD;
+
+/** The bytes of the old objects which trigger the next full collection */
+static size_t majorThreshold = wsky_GC_DEFAULT_MINIMUM_THRESHOLD;
+
+/** The bytes used by the objects which survived the last full collection */
+static size_t majorLiveBytes = 0;
+
+
 void wsky_GC_initImpl(void *stackStart_) {
   stackStart = stackStart_;
+  memset(&stats, 0, sizeof stats);
+  threshold = minimumThreshold;
+  majorThreshold = minimumThreshold;
+  majorLiveBytes = 0;
 }
 
 
 
-void wsky_GC_collect(void) {
+static bool precise = false;
+
+/** True if a collection has been requested in precise mode */
+static bool collectionPending = false;
+
+void wsky_GC_setPrecise(bool precise_) {
+  precise = precise_;
+}
+
+bool wsky_GC_isPrecise(void) {
+  return precise;
+}
+
+static void visitPreciseRoots(void) {
   visitBuiltins();
-  visitRegisters();
-  visitStack();
-  wsky_heaps_deleteUnmarkedObjects();
+  wsky_eval_visitScopeStack();
+  wsky_vm_visitStack();
+  wsky_Handle_visitAll();
 }
 
-void wsky_GC_autoCollect(void) {
+static void visitRoots(void) {
+  visitPreciseRoots();
+  if (!precise) {
+    visitRegisters(markAmbiguousRoot);
+    visitStack(markAmbiguousRoot);
+  }
+}
+
+static void resetMarkCounters(void) {
+  markedObjectCount = 0;
+  markedBytes = 0;
+}
+
+void wsky_GC_collect(void) {
+  wsky_GC_finishSweep();
+  minorCollection = false;
+  resetMarkCounters();
   wsky_GC_unmarkAll();
-  wsky_eval_visitScopeStack();
+  visitRoots();
+  processMarkStack();
+  clearRememberedSet();
+  wsky_heaps_deleteUnmarkedObjects();
+
+  stats.liveObjectCount = markedObjectCount;
+  stats.liveBytes = markedBytes;
+}
+
+void wsky_GC_collectYoung(void) {
+  minorCollection = true;
+  resetMarkCounters();
+  visitRoots();
+  visitRememberedSet();
+  processMarkStack();
+  clearRememberedSet();
+  wsky_heaps_deleteUnmarkedYoungObjects();
+  minorCollection = false;
+
+  /* The marked objects have been promoted */
+  stats.liveObjectCount += markedObjectCount;
+  stats.liveBytes += markedBytes;
+}
+
+static void updateReferences(Object *object) {
+  if (object->_initialized)
+    wsky_Class_acceptGC(object);
+}
+
+/** Compacts the heaps after a full collection */
+static void compact(void) {
+  wsky_GC_finishSweep();
+  visitRegisters(pinAmbiguousRoot);
+  visitStack(pinAmbiguousRoot);
+
+  size_t movedObjectCount = wsky_heaps_compact();
+
+  updatingReferences = true;
+  visitPreciseRoots();
+  wsky_heaps_forEachMarkedObject(updateReferences);
+  updatingReferences = false;
+
+  wsky_heaps_releaseEvacuatedPages();
+  stats.compactionCount++;
+  stats.movedObjectCount += movedObjectCount;
+}
+
+void wsky_GC_compact(void) {
   wsky_GC_collect();
+  compact();
+}
+
+bool wsky_GC_sweep(size_t pageCount) {
+  return wsky_heaps_sweep(pageCount);
+}
+
+void wsky_GC_finishSweep(void) {
+  wsky_heaps_sweep((size_t)-1);
+}
+
+static size_t computeThreshold(size_t liveBytes) {
+  double next = (double)liveBytes * growthFactor;
+  return next > (double)minimumThreshold ? (size_t)next : minimumThreshold;
+}
+
+static void updateThreshold(size_t liveBytes) {
+  threshold = computeThreshold(liveBytes);
+  majorThreshold = computeThreshold(majorLiveBytes);
+  wsky_heaps_setRetainedSize(threshold);
+}
+
+/** In stress mode, one collection out of this number is a full one */
+#define STRESS_MAJOR_PERIOD 8
+
+static bool isMajorCollectionNeeded(void) {
+  if (stressed)
+    return stats.collectionCount % STRESS_MAJOR_PERIOD == 0;
+  return stats.liveBytes >= majorThreshold;
+}
+
+void wsky_GC_autoCollect(void) {
+  clock_t start = clock();
+
+  bool major = isMajorCollectionNeeded();
+  if (major) {
+    wsky_GC_collect();
+    if (compacting)
+      compact();
+  } else {
+    wsky_GC_collectYoung();
+    stats.minorCollectionCount++;
+  }
+
+  double pauseTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+  stats.collectionCount++;
+  stats.totalPauseTime += pauseTime;
+  stats.lastPauseTime = pauseTime;
+  if (pauseTime > stats.maxPauseTime)
+    stats.maxPauseTime = pauseTime;
+
+  if (major)
+    majorLiveBytes = stats.liveBytes;
+  updateThreshold(stats.liveBytes);
 }
 
 void wsky_GC_deleteAll(void) {
+  wsky_GC_finishSweep();
   wsky_GC_unmarkAll();
   wsky_heaps_deleteUnmarkedObjects();
+  wsky_GC_finishSweep();
   wsky_heaps_free();
+  MarkStack_free();
+  RememberedSet_free();
 }
 
-static bool stressed = false;
-
 void wsky_GC_setStressed(bool stressed_) {
   stressed = stressed_;
 }
@@ -153,8 +509,55 @@ bool wsky_GC_isStressed(void) {
   return stressed;
 }
 
+void wsky_GC_setCompacting(bool compacting_) {
+  compacting = compacting_;
+}
+
+bool wsky_GC_isCompacting(void) {
+  return compacting;
+}
+
 void wsky_GC_requestCollection(void) {
-  if (wsky_GC_isStressed()) {
+  size_t bytes = stats.liveBytes + wsky_heaps_getYoungBytes();
+  if (wsky_GC_isStressed() || bytes >= threshold) {
+    if (precise)
+      collectionPending = true;
+    else
+      wsky_GC_autoCollect();
+  }
+}
+
+void wsky_GC_safepoint(void) {
+  if (collectionPending) {
+    collectionPending = false;
     wsky_GC_autoCollect();
   }
 }
+
+void wsky_GC_setGrowthFactor(double factor) {
+  assert(factor > 1.0);
+  growthFactor = factor;
+  updateThreshold(stats.liveBytes);
+}
+
+double wsky_GC_getGrowthFactor(void) {
+  return growthFactor;
+}
+
+void wsky_GC_setMinimumThreshold(size_t bytes) {
+  minimumThreshold = bytes;
+  updateThreshold(stats.liveBytes);
+}
+
+size_t wsky_GC_getMinimumThreshold(void) {
+  return minimumThreshold;
+}
+
+void wsky_GC_getStats(wsky_GC_Stats *stats_) {
+  *stats_ = stats;
+  stats_->objectCount = wsky_heaps_getObjectCount();
+  stats_->allocatedBytes = wsky_heaps_getAllocatedBytes();
+  stats_->heapSize = wsky_heaps_getSize();
+  stats_->threshold = threshold;
+  stats_->unsweptPageCount = wsky_heaps_getUnsweptPageCount();
+}
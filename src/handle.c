@@ -0,0 +1,101 @@
+#include <assert.h>
+#include "whiskey_private.h"
+
+
+/** The number of handles of the chunks, unless a larger array is needed */
+#define CHUNK_CAPACITY 256
+
+typedef struct wsky_HandleChunk_s {
+  struct wsky_HandleChunk_s *previous;
+  size_t capacity;
+  size_t count;
+  Value values[];
+} Chunk;
+
+
+/** The current chunk of the shadow stack */
+static Chunk *current = NULL;
+
+/** A released chunk, kept to avoid allocating a new one at each call */
+static Chunk *spare = NULL;
+
+
+static Chunk *newChunk(size_t minimumCapacity) {
+  if (spare && spare->capacity >= minimumCapacity) {
+    Chunk *chunk = spare;
+    spare = NULL;
+    return chunk;
+  }
+  size_t capacity = CHUNK_CAPACITY;
+  if (minimumCapacity > capacity)
+    capacity = minimumCapacity;
+  Chunk *chunk = wsky_safeMalloc(sizeof(Chunk) + capacity * sizeof(Value));
+  chunk->capacity = capacity;
+  return chunk;
+}
+
+static void releaseChunk(Chunk *chunk) {
+  if (!spare || spare->capacity < chunk->capacity) {
+    wsky_free(spare);
+    spare = chunk;
+  } else {
+    wsky_free(chunk);
+  }
+}
+
+
+void wsky_HandleScope_open(wsky_HandleScope *scope) {
+  scope->chunk = current;
+  scope->count = current ? current->count : 0;
+}
+
+void wsky_HandleScope_close(wsky_HandleScope *scope) {
+  while (current != scope->chunk) {
+    assert(current);
+    Chunk *previous = current->previous;
+    releaseChunk(current);
+    current = previous;
+  }
+  if (current) {
+    assert(current->count >= scope->count);
+    current->count = scope->count;
+  }
+}
+
+
+Value *wsky_Handle_newArray(size_t count) {
+  if (!current || current->capacity - current->count < count) {
+    Chunk *chunk = newChunk(count);
+    chunk->previous = current;
+    chunk->count = 0;
+    current = chunk;
+  }
+  Value *values = current->values + current->count;
+  current->count += count;
+  for (size_t i = 0; i < count; i++)
+    values[i] = Value_NULL;
+  return values;
+}
+
+Value *wsky_Handle_new(Value value) {
+  Value *handle = wsky_Handle_newArray(1);
+  *handle = value;
+  return handle;
+}
+
+
+void wsky_Handle_visitAll(void) {
+  for (Chunk *chunk = current; chunk; chunk = chunk->previous)
+    for (size_t i = 0; i < chunk->count; i++)
+      wsky_GC_visitValue(chunk->values[i]);
+}
+
+void wsky_Handle_freeAll(void) {
+  while (current) {
+    Chunk *previous = current->previous;
+    wsky_free(current);
+    current = previous;
+  }
+  wsky_free(spare);
+  spare = NULL;
+}
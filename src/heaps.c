@@ -1,4 +1,5 @@
 #include <string.h>
+#include <stdint.h>
 #include <stdarg.h>
 #include <assert.h>
 #include "heaps.h"
@@ -19,45 +20,21 @@ static inline void heapsLog(const char *string, ...) {
 }
 #endif
 
-typedef union ObjectUnion_u {
-
-  struct {
-    wsky_OBJECT_HEAD
-    union ObjectUnion_u *next;
-   } free;
-
-  AttributeError        attributeError;
-  Class                 class;
-  Exception             exception;
-  Function              function;
-  ImportError           importError;
-  InstanceMethod        instanceMethod;
-  Method                method;
-  Module                module;
-  NameError             nameError;
-  NotImplementedError   notImplementedError;
-  Object                object;
-  ParameterError        parameterError;
-  ProgramFile           programFile;
-  Scope                 scope;
-  String                string;
-  Structure             structure;
-  SyntaxErrorEx         syntaxError;
-  TypeError             typeError;
-  ValueError            valueError;
-  ZeroDivisionError     zeroDivisionError;
-
-} ObjectUnion;
-
-static inline bool ObjectUnion_isFree(const ObjectUnion *u) {
-  return u->free.class == NULL;
-}
-
-static inline void ObjectUnion_markAsFree(ObjectUnion *u) {
-  u->free.class = NULL;
-}
-
-static void deleteObject(Object *object) {
+/** A free slot of a heap */
+typedef struct FreeSlot_s {
+  wsky_OBJECT_HEAD
+
+  /** The next free slot of the same size class */
+  struct FreeSlot_s *next;
+} FreeSlot;
+
+typedef struct SizeClass_s SizeClass;
+typedef struct Page_s Page;
+
+static void freeSlot(Page *page, Object *object);
+
+/** Calls the destructors of an object, without freeing its slot */
+static void destroyObject(Object *object) {
   wsky_Class *class = object->class;
   assert(class);
   heapsLog("Destroying a %s at %p\n", class->name, (void *) object);
@@ -74,93 +51,403 @@ static void deleteObject(Object *object) {
   if (!object->class->native) {
     wsky_ObjectFields_free(&object->fields);
   }
+}
 
-  wsky_heaps_freeObject(object);
+static void deleteObject(Page *page, Object *object) {
+  destroyObject(object);
+  freeSlot(page, object);
 }
 
-static void ObjectUnion_delete(ObjectUnion *object) {
-  assert(!ObjectUnion_isFree(object));
-  assert(!object->object._gcMark);
-  deleteObject(&object->object);
+
+
+/*
+ * The heaps are made of pages of PAGE_SIZE bytes, aligned on PAGE_SIZE.
+ * All the slots of a page have the same size, and a bitmap tells which
+ * ones are allocated.
+ *
+ * Objects are allocated in slots whose size is the smallest size class
+ * large enough. Each size class has its own heaps and free list.
+ *
+ * The sweep after a full collection is lazy: the pages are swept when
+ * the free list of their size class is empty, or by wsky_heaps_sweep().
+ *
+ * The heaps which stay empty after EMPTY_HEAP_RELEASE_DELAY full sweeps
+ * are released, unless the remaining heaps would be smaller than the
+ * retained size or than twice the bytes allocated at the peak of these
+ * sweeps, since the heaps grow by doubling.
+ *
+ * A compaction moves the objects of the sparse pages to the other pages
+ * of their size class, and releases the heaps which become empty.
+ */
+
+#define PAGE_SHIFT 14
+#define PAGE_SIZE ((size_t)1 << PAGE_SHIFT)
+
+/** The sizes of the slots */
+static const size_t SLOT_SIZES[] = {32, 64, 128, 256};
+
+#define SIZE_CLASS_COUNT (sizeof SLOT_SIZES / sizeof SLOT_SIZES[0])
+
+#define MAX_SLOTS_PER_PAGE (PAGE_SIZE / 32)
+#define BITMAP_WORD_COUNT (MAX_SLOTS_PER_PAGE / 64)
+
+
+struct SizeClass_s {
+
+  /** The size of the slots */
+  size_t        slotSize;
+
+  /** The base 2 logarithm of the size of the slots */
+  unsigned      slotShift;
+
+  /** The number of pages of the next heap */
+  size_t        heapPageCount;
+
+  FreeSlot      *freeSlots;
+
+  /** The pages which have not been swept since the last full collection */
+  Page          *unsweptPages;
+
+};
+
+
+struct Page_s {
+
+  /** The first slot, aligned on PAGE_SIZE */
+  char          *objects;
+
+  SizeClass     *sizeClass;
+
+  /** A bit per slot, set if the slot is allocated */
+  uint64_t      allocated[BITMAP_WORD_COUNT];
+
+  /** The next page to sweep of the same size class */
+  Page          *nextUnswept;
+
+  /** True if an ambiguous root references an object of the page */
+  bool          pinned;
+
+  /** True if the objects of the page have been moved by a compaction */
+  bool          evacuated;
+
+};
+
+
+static inline size_t Page_getSlotCount(const Page *page) {
+  return PAGE_SIZE >> page->sizeClass->slotShift;
 }
 
+static inline Object *Page_getObject(const Page *page, size_t index) {
+  return (Object *)(page->objects + (index << page->sizeClass->slotShift));
+}
 
+static inline size_t Page_getIndex(const Page *page, const void *object) {
+  size_t offset = (size_t)((const char *)object - page->objects);
+  return offset >> page->sizeClass->slotShift;
+}
 
-typedef struct Heap_s {
+static inline bool Page_isAllocated(const Page *page, size_t index) {
+  return (page->allocated[index / 64] >> (index % 64)) & 1;
+}
 
-  ObjectUnion   *objects;
-  size_t        count;
-  struct Heap_s *next;
+static inline void Page_setAllocated(Page *page, size_t index) {
+  page->allocated[index / 64] |= (uint64_t)1 << (index % 64);
+}
 
-} Heap;
+static inline void Page_clearAllocated(Page *page, size_t index) {
+  page->allocated[index / 64] &= ~((uint64_t)1 << (index % 64));
+}
 
+/**
+ * Calls a function on each allocated object of a page.
+ * The function may free the object.
+ */
+static void Page_forEachObject(Page *page,
+                               void (*function)(Page *, Object *)) {
+  size_t wordCount = Page_getSlotCount(page) / 64;
+  if (wordCount == 0)
+    wordCount = 1;
+  for (size_t w = 0; w < wordCount; w++) {
+    uint64_t word = page->allocated[w];
+    while (word) {
+      unsigned bit = 0;
+      while (!((word >> bit) & 1))
+        bit++;
+      word &= ~((uint64_t)1 << bit);
+      function(page, Page_getObject(page, w * 64 + bit));
+    }
+  }
+}
+
+/** Calls a function on each free slot of a page, from the last one */
+static void Page_forEachFreeSlot(Page *page,
+                                 void (*function)(Page *, Object *)) {
+  for (size_t i = Page_getSlotCount(page); i-- > 0;)
+    if (!Page_isAllocated(page, i))
+      function(page, Page_getObject(page, i));
+}
+
+static bool Page_isEmpty(const Page *page) {
+  for (size_t w = 0; w < BITMAP_WORD_COUNT; w++)
+    if (page->allocated[w])
+      return false;
+  return true;
+}
+
+static size_t Page_getObjectCount(const Page *page) {
+  size_t count = 0;
+  for (size_t w = 0; w < BITMAP_WORD_COUNT; w++)
+    for (uint64_t word = page->allocated[w]; word; word &= word - 1)
+      count++;
+  return count;
+}
 
-#define INITIAL_HEAP_SIZE 8
 
 
-static void heaps_addToFreeObjectList(ObjectUnion *object);
+/*
+ * The page table maps the page numbers (the addresses shifted by
+ * PAGE_SHIFT) to the pages, with open addressing and linear probing.
+ */
 
+typedef struct {
+  uintptr_t     pageNumber;
+  Page          *page;
+} PageTableEntry;
 
-static void Heap_init(Heap *heap, size_t heapSize, Heap *next) {
-  heap->objects = wsky_safeMalloc(heapSize * sizeof(ObjectUnion));
-  heap->count = heapSize;
-  for (size_t i = 0; i < heapSize; i++) {
-    ObjectUnion *object = heap->objects + i;
-    ObjectUnion_markAsFree(object);
-    heaps_addToFreeObjectList(object);
+typedef struct {
+  PageTableEntry *entries;
+
+  /** A power of two */
+  size_t        capacity;
+
+  size_t        count;
+} PageTable;
+
+static PageTable pageTable = {NULL, 0, 0};
+
+static inline size_t hashPageNumber(uintptr_t pageNumber, size_t capacity) {
+  /* Fibonacci hashing */
+  uint64_t hash = (uint64_t)pageNumber * UINT64_C(0x9E3779B97F4A7C15);
+  return (size_t)(hash >> 32) & (capacity - 1);
+}
+
+static Page *PageTable_get(uintptr_t pageNumber) {
+  if (!pageTable.count)
+    return NULL;
+  size_t mask = pageTable.capacity - 1;
+  size_t i = hashPageNumber(pageNumber, pageTable.capacity);
+  while (pageTable.entries[i].page) {
+    if (pageTable.entries[i].pageNumber == pageNumber)
+      return pageTable.entries[i].page;
+    i = (i + 1) & mask;
   }
-  heap->next = next;
+  return NULL;
 }
 
-static Heap *Heap_new(size_t objectCount, Heap *next) {
-  Heap *heap = wsky_safeMalloc(sizeof(Heap));
-  Heap_init(heap, objectCount, next);
-  return heap;
+static void PageTable_insert(PageTableEntry *entries, size_t capacity,
+                             uintptr_t pageNumber, Page *page) {
+  size_t i = hashPageNumber(pageNumber, capacity);
+  while (entries[i].page)
+    i = (i + 1) & (capacity - 1);
+  entries[i].pageNumber = pageNumber;
+  entries[i].page = page;
 }
 
-static bool Heap_areAllObjectsFreed(const Heap *heap) {
-  for (size_t i = 0; i < heap->count; i++) {
-    ObjectUnion *object = heap->objects + i;
-    if (ObjectUnion_isFree(object))
-      return true;
+static void PageTable_grow(void) {
+  size_t capacity = pageTable.capacity ? pageTable.capacity * 2 : 64;
+  PageTableEntry *entries = wsky_safeMalloc(capacity * sizeof(PageTableEntry));
+  memset(entries, 0, capacity * sizeof(PageTableEntry));
+  for (size_t i = 0; i < pageTable.capacity; i++) {
+    PageTableEntry *entry = pageTable.entries + i;
+    if (entry->page)
+      PageTable_insert(entries, capacity, entry->pageNumber, entry->page);
   }
-  return false;
+  wsky_free(pageTable.entries);
+  pageTable.entries = entries;
+  pageTable.capacity = capacity;
+}
+
+static void PageTable_add(Page *page) {
+  if ((pageTable.count + 1) * 2 > pageTable.capacity)
+    PageTable_grow();
+  uintptr_t pageNumber = (uintptr_t)page->objects >> PAGE_SHIFT;
+  PageTable_insert(pageTable.entries, pageTable.capacity, pageNumber, page);
+  pageTable.count++;
 }
 
-static void Heap_unmark(Heap *heap) {
-  for (size_t i = 0; i < heap->count; i++) {
-    ObjectUnion *object = heap->objects + i;
-    if (!ObjectUnion_isFree(object))
-      object->object._gcMark = false;
+/** Removes a page, with backward shift deletion */
+static void PageTable_remove(const Page *page) {
+  uintptr_t pageNumber = (uintptr_t)page->objects >> PAGE_SHIFT;
+  size_t mask = pageTable.capacity - 1;
+  size_t i = hashPageNumber(pageNumber, pageTable.capacity);
+  while (pageTable.entries[i].page != page) {
+    assert(pageTable.entries[i].page);
+    i = (i + 1) & mask;
+  }
+
+  for (size_t j = (i + 1) & mask; pageTable.entries[j].page;
+       j = (j + 1) & mask) {
+    size_t home = hashPageNumber(pageTable.entries[j].pageNumber,
+                                 pageTable.capacity);
+    /* The entry can fill the hole if its home is not in (i, j] */
+    bool between = i < j ? (i < home && home <= j) : (i < home || home <= j);
+    if (!between) {
+      pageTable.entries[i] = pageTable.entries[j];
+      i = j;
+    }
   }
+  pageTable.entries[i].pageNumber = 0;
+  pageTable.entries[i].page = NULL;
+  pageTable.count--;
 }
 
-static void Heap_deleteUnmarkedObjects(Heap *heap) {
-  for (size_t i = 0; i < heap->count; i++) {
-    ObjectUnion *object = heap->objects + i;
-    if (!ObjectUnion_isFree(object) && !object->object._gcMark)
-      ObjectUnion_delete(object);
+static void PageTable_free(void) {
+  wsky_free(pageTable.entries);
+  pageTable.entries = NULL;
+  pageTable.capacity = 0;
+  pageTable.count = 0;
+}
+
+/** Returns the page which contains the given address or NULL */
+static inline Page *getPage(const void *pointer) {
+  return PageTable_get((uintptr_t)pointer >> PAGE_SHIFT);
+}
+
+
+
+/**
+ * The number of consecutive full sweeps after which an empty heap is
+ * released. An empty heap is kept for a while, in case the program
+ * allocates as much again.
+ */
+#define EMPTY_HEAP_RELEASE_DELAY 2
+
+/** A block of consecutive pages */
+typedef struct Heap_s {
+
+  /** The allocated memory, which contains the aligned pages */
+  void          *memory;
+
+  Page          *pages;
+  size_t        pageCount;
+
+  /** The number of consecutive full sweeps which found the heap empty */
+  unsigned      emptySweepCount;
+
+  struct Heap_s *next;
+
+} Heap;
+
+
+static void SizeClass_addFreeSlot(SizeClass *sizeClass, Object *object) {
+  FreeSlot *slot = (FreeSlot *)object;
+  slot->next = sizeClass->freeSlots;
+  sizeClass->freeSlots = slot;
+}
+
+static void addFreeSlot(Page *page, Object *object) {
+  SizeClass_addFreeSlot(page->sizeClass, object);
+}
+
+static void Page_init(Page *page, SizeClass *sizeClass, char *objects) {
+  page->objects = objects;
+  page->sizeClass = sizeClass;
+  page->nextUnswept = NULL;
+  page->pinned = false;
+  page->evacuated = false;
+  memset(page->allocated, 0, sizeof page->allocated);
+
+  Page_forEachFreeSlot(page, addFreeSlot);
+  PageTable_add(page);
+}
+
+static Heap *Heap_new(SizeClass *sizeClass, size_t pageCount, Heap *next) {
+  Heap *heap = wsky_safeMalloc(sizeof(Heap));
+
+  /* One more page to align the pages */
+  heap->memory = wsky_allocatePages((pageCount + 1) * PAGE_SIZE);
+  if (!heap->memory) {
+    fprintf(stderr, "heaps: cannot allocate a heap of %lu pages\n",
+            (unsigned long)pageCount);
+    abort();
   }
+  uintptr_t address = (uintptr_t)heap->memory;
+  address = (address + PAGE_SIZE - 1) & ~(uintptr_t)(PAGE_SIZE - 1);
+  char *objects = (char *)address;
+
+  heap->pages = wsky_safeMalloc(pageCount * sizeof(Page));
+  heap->pageCount = pageCount;
+  heap->emptySweepCount = 0;
+  for (size_t i = pageCount; i-- > 0;)
+    Page_init(heap->pages + i, sizeClass, objects + i * PAGE_SIZE);
+
+  heap->next = next;
+  return heap;
 }
 
 static void Heap_delete(Heap *heap) {
-  assert(Heap_areAllObjectsFreed(heap));
-  wsky_free(heap->objects);
+  for (size_t i = 0; i < heap->pageCount; i++)
+    assert(Page_isEmpty(heap->pages + i));
+  wsky_free(heap->pages);
+  wsky_freePages(heap->memory, (heap->pageCount + 1) * PAGE_SIZE);
   wsky_free(heap);
 }
 
+static bool Heap_isEmpty(const Heap *heap) {
+  for (size_t i = 0; i < heap->pageCount; i++)
+    if (!Page_isEmpty(heap->pages + i))
+      return false;
+  return true;
+}
+
 
 
 typedef struct {
 
   Heap          *heaps;
 
-  size_t        heapSize;
+  SizeClass     sizeClasses[SIZE_CLASS_COUNT];
 
   void          *lowestAddress;
   void          *highestAddress;
 
-  ObjectUnion   *freeObjects;
+  /** The size of all heaps, in bytes */
+  size_t        capacity;
+
+  /** The size below which the empty heaps are not released */
+  size_t        retainedSize;
+
+  /**
+   * The largest retained size or twice the allocated bytes since the end
+   * of the previous full sweep, and between the two previous ones
+   */
+  size_t        recentPeakSize;
+  size_t        previousPeakSize;
+
+  /** The number of allocated objects, reachable or not */
+  size_t        objectCount;
+
+  /** The bytes used by the slots of the allocated objects */
+  size_t        allocatedBytes;
+
+  /** The objects allocated since the previous collection */
+  Object        **youngObjects;
+  size_t        youngObjectCount;
+  size_t        youngObjectCapacity;
+
+  /** The bytes used by the slots of the young objects */
+  size_t        youngBytes;
+
+  /** The number of pages to sweep */
+  size_t        unsweptPageCount;
+
+  /**
+   * The unreachable classes found by the sweep. They are deleted when the
+   * sweep is over, because the destructors of their instances need them.
+   */
+  Object        **deadClasses;
+  size_t        deadClassCount;
+  size_t        deadClassCapacity;
 
 } Heaps;
 
@@ -170,66 +457,624 @@ static Heaps heaps = {
   .lowestAddress = NULL,
   .highestAddress = NULL,
 
-  .heapSize = INITIAL_HEAP_SIZE,
+  .capacity = 0,
+  .retainedSize = 0,
+  .recentPeakSize = 0,
+  .previousPeakSize = 0,
+  .objectCount = 0,
+  .allocatedBytes = 0,
+
+  .youngObjects = NULL,
+  .youngObjectCount = 0,
+  .youngObjectCapacity = 0,
+  .youngBytes = 0,
 
-  .freeObjects = NULL,
+  .unsweptPageCount = 0,
+
+  .deadClasses = NULL,
+  .deadClassCount = 0,
+  .deadClassCapacity = 0,
 };
 
-static void heaps_addHeap(void) {
-  heapsLog("Add heap of size %lu\n", (unsigned long)heaps.heapSize);
-  Heap *heap = Heap_new(heaps.heapSize, heaps.heaps);
-  heaps.heaps = heap;
-  heaps.heapSize *= 2;
+static void initSizeClasses(void) {
+  for (size_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+    SizeClass *sizeClass = heaps.sizeClasses + i;
+    sizeClass->slotSize = SLOT_SIZES[i];
+    sizeClass->slotShift = 0;
+    while (((size_t)1 << sizeClass->slotShift) < SLOT_SIZES[i])
+      sizeClass->slotShift++;
+    sizeClass->heapPageCount = 1;
+    sizeClass->freeSlots = NULL;
+    sizeClass->unsweptPages = NULL;
+  }
+}
+
+/** Returns the smallest size class large enough */
+static SizeClass *getSizeClass(size_t objectSize) {
+  assert(objectSize >= sizeof(FreeSlot));
+  if (!heaps.sizeClasses[0].slotSize)
+    initSizeClasses();
+
+  for (size_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+    if (objectSize <= SLOT_SIZES[i])
+      return heaps.sizeClasses + i;
+  }
+  fprintf(stderr, "heaps: no size class for objects of %lu bytes\n",
+          (unsigned long)objectSize);
+  abort();
+}
 
-  if (!heaps.lowestAddress || (void *)heap->objects < heaps.lowestAddress)
-    heaps.lowestAddress = heap->objects;
+/** Extends the bounds of the heaps to include the given heap */
+static void heaps_extendBounds(const Heap *heap) {
+  void *first = heap->pages[0].objects;
+  void *last = heap->pages[heap->pageCount - 1].objects + PAGE_SIZE - 1;
+  if (!heaps.lowestAddress || first < heaps.lowestAddress)
+    heaps.lowestAddress = first;
 
-  if (!heaps.highestAddress || (void *)heap->objects > heaps.highestAddress)
-    heaps.highestAddress = heap->objects + heap->count - 1;
-  assert(heaps.highestAddress > heaps.lowestAddress);
+  if (!heaps.highestAddress || last > heaps.highestAddress)
+    heaps.highestAddress = last;
 }
 
-static void heaps_addToFreeObjectList(ObjectUnion *object) {
-  object->free.next = heaps.freeObjects;
-  heaps.freeObjects = object;
+static void heaps_recomputeBounds(void) {
+  heaps.lowestAddress = NULL;
+  heaps.highestAddress = NULL;
+  for (Heap *heap = heaps.heaps; heap; heap = heap->next)
+    heaps_extendBounds(heap);
 }
 
-Object *wsky_heaps_allocateObject(const char *className) {
-  if (heaps.freeObjects) {
-    ObjectUnion *object = heaps.freeObjects;
-    heaps.freeObjects = object->free.next;
-    heapsLog("Allocating a %s at %p\n", className, (void *)&object->object);
-    return &object->object;
+static void heaps_addHeap(SizeClass *sizeClass) {
+  heapsLog("Add heap of %lu pages for %lu-byte slots\n",
+           (unsigned long)sizeClass->heapPageCount,
+           (unsigned long)sizeClass->slotSize);
+  Heap *heap = Heap_new(sizeClass, sizeClass->heapPageCount, heaps.heaps);
+  heaps.heaps = heap;
+  heaps.capacity += heap->pageCount * PAGE_SIZE;
+  sizeClass->heapPageCount *= 2;
+  heaps_extendBounds(heap);
+}
+
+/**
+ * Unlinks an empty heap and returns its memory to the system. The bounds
+ * and the free lists must be updated afterwards.
+ */
+static void heaps_removeHeap(Heap **link) {
+  Heap *heap = *link;
+  SizeClass *sizeClass = heap->pages[0].sizeClass;
+  heapsLog("Release heap of %lu pages for %lu-byte slots\n",
+           (unsigned long)heap->pageCount,
+           (unsigned long)sizeClass->slotSize);
+  if (sizeClass->heapPageCount > 1)
+    sizeClass->heapPageCount /= 2;
+  *link = heap->next;
+  for (size_t i = 0; i < heap->pageCount; i++)
+    PageTable_remove(heap->pages + i);
+  heaps.capacity -= heap->pageCount * PAGE_SIZE;
+  Heap_delete(heap);
+}
+
+/**
+ * Refills the free lists from the bitmaps. The slots of the empty heaps
+ * are allocated last, so that they have a chance to stay empty until
+ * they are released.
+ */
+static void heaps_rebuildFreeLists(void) {
+  for (size_t i = 0; i < SIZE_CLASS_COUNT; i++)
+    heaps.sizeClasses[i].freeSlots = NULL;
+  for (int emptyHeaps = 1; emptyHeaps >= 0; emptyHeaps--) {
+    for (Heap *heap = heaps.heaps; heap; heap = heap->next) {
+      if ((heap->emptySweepCount > 0) != emptyHeaps)
+        continue;
+      for (size_t i = 0; i < heap->pageCount; i++)
+        Page_forEachFreeSlot(heap->pages + i, addFreeSlot);
+    }
+  }
+}
+
+/** Called when a full sweep is over */
+static void heaps_releaseEmptyHeaps(void) {
+  size_t retainedSize = heaps.recentPeakSize;
+  if (heaps.previousPeakSize > retainedSize)
+    retainedSize = heaps.previousPeakSize;
+  heaps.previousPeakSize = heaps.recentPeakSize;
+  heaps.recentPeakSize = heaps.retainedSize;
+
+  bool emptyHeapFound = false;
+  bool released = false;
+  Heap **link = &heaps.heaps;
+  while (*link) {
+    Heap *heap = *link;
+    if (!Heap_isEmpty(heap)) {
+      heap->emptySweepCount = 0;
+      link = &heap->next;
+      continue;
+    }
+    emptyHeapFound = true;
+    size_t heapSize = heap->pageCount * PAGE_SIZE;
+    if (++heap->emptySweepCount < EMPTY_HEAP_RELEASE_DELAY ||
+        heaps.capacity - heapSize < retainedSize) {
+      link = &heap->next;
+      continue;
+    }
+    heaps_removeHeap(link);
+    released = true;
   }
 
-  heaps_addHeap();
-  assert(heaps.freeObjects);
-  return wsky_heaps_allocateObject(className);
+  if (released)
+    heaps_recomputeBounds();
+  if (emptyHeapFound)
+    heaps_rebuildFreeLists();
 }
 
-void wsky_heaps_freeObject(Object *object_) {
-  ObjectUnion *object = (ObjectUnion *)object_;
-  ObjectUnion_markAsFree(object);
-  heaps_addToFreeObjectList(object);
+static void addYoungObject(Object *object) {
+  if (heaps.youngObjectCount == heaps.youngObjectCapacity) {
+    size_t capacity = heaps.youngObjectCapacity ?
+      heaps.youngObjectCapacity * 2 : 1024;
+    Object **objects = wsky_realloc(heaps.youngObjects,
+                                    capacity * sizeof(Object *));
+    if (!objects)
+      abort();
+    heaps.youngObjects = objects;
+    heaps.youngObjectCapacity = capacity;
+  }
+  heaps.youngObjects[heaps.youngObjectCount++] = object;
 }
 
-void wsky_heaps_unmark(void) {
-  Heap *heap = heaps.heaps;
-  while (heap) {
-    Heap_unmark(heap);
-    heap = heap->next;
+static void Page_sweep(Page *page);
+
+Object *wsky_heaps_allocateObject(size_t objectSize, const char *className) {
+  SizeClass *sizeClass = getSizeClass(objectSize);
+  while (!sizeClass->freeSlots && sizeClass->unsweptPages) {
+    Page *page = sizeClass->unsweptPages;
+    sizeClass->unsweptPages = page->nextUnswept;
+    Page_sweep(page);
+  }
+  if (!sizeClass->freeSlots) {
+    heaps_addHeap(sizeClass);
+    assert(sizeClass->freeSlots);
   }
+
+  FreeSlot *slot = sizeClass->freeSlots;
+  sizeClass->freeSlots = slot->next;
+
+  Page *page = getPage(slot);
+  assert(page && page->sizeClass == sizeClass);
+  size_t index = Page_getIndex(page, slot);
+  assert(!Page_isAllocated(page, index));
+  Page_setAllocated(page, index);
+
+  Object *object = (Object *)slot;
+  object->_gcMark = false;
+  object->_gcOld = false;
+  object->_gcRemembered = false;
+  addYoungObject(object);
+
+  heaps.objectCount++;
+  heaps.allocatedBytes += sizeClass->slotSize;
+  if (heaps.allocatedBytes * 2 > heaps.recentPeakSize)
+    heaps.recentPeakSize = heaps.allocatedBytes * 2;
+  heaps.youngBytes += sizeClass->slotSize;
+  heapsLog("Allocating a %s at %p\n", className, (void *)slot);
+  return object;
 }
 
-void wsky_heaps_deleteUnmarkedObjects(void) {
+/** Frees a slot without adding it to the free list */
+static void releaseSlot(Page *page, Object *object) {
+  SizeClass *sizeClass = page->sizeClass;
+  if (!object->_gcOld)
+    heaps.youngBytes -= sizeClass->slotSize;
+  Page_clearAllocated(page, Page_getIndex(page, object));
+  assert(heaps.objectCount > 0);
+  heaps.objectCount--;
+  heaps.allocatedBytes -= sizeClass->slotSize;
+}
+
+static void freeSlot(Page *page, Object *object) {
+  releaseSlot(page, object);
+  SizeClass_addFreeSlot(page->sizeClass, object);
+}
+
+void wsky_heaps_freeObject(Object *object) {
+  Page *page = getPage(object);
+  assert(page);
+  freeSlot(page, object);
+}
+
+size_t wsky_heaps_getObjectCount(void) {
+  return heaps.objectCount;
+}
+
+size_t wsky_heaps_getAllocatedBytes(void) {
+  return heaps.allocatedBytes;
+}
+
+size_t wsky_heaps_getYoungBytes(void) {
+  return heaps.youngBytes;
+}
+
+size_t wsky_heaps_getSlotSize(const Object *object) {
+  Page *page = getPage(object);
+  assert(page);
+  return page->sizeClass->slotSize;
+}
+
+size_t wsky_heaps_getSize(void) {
+  return heaps.capacity;
+}
+
+void wsky_heaps_setRetainedSize(size_t size) {
+  heaps.retainedSize = size;
+  if (size > heaps.recentPeakSize)
+    heaps.recentPeakSize = size;
+}
+
+/** Calls a function on each allocated object */
+static void forEachObject(void (*function)(Page *, Object *)) {
   Heap *heap = heaps.heaps;
   while (heap) {
     Heap *next = heap->next;
-    Heap_deleteUnmarkedObjects(heap);
+    for (size_t i = 0; i < heap->pageCount; i++)
+      Page_forEachObject(heap->pages + i, function);
     heap = next;
   }
 }
 
+static void unmarkObject(Page *page, Object *object) {
+  (void)page;
+  object->_gcMark = false;
+}
+
+void wsky_heaps_unmark(void) {
+  assert(!heaps.unsweptPageCount);
+  forEachObject(unmarkObject);
+}
+
+/** Makes a surviving object old */
+static void promote(Object *object) {
+  if (object->_gcOld)
+    return;
+  object->_gcOld = true;
+  heaps.youngBytes -= getPage(object)->sizeClass->slotSize;
+
+  /* Its fields may not have been visited yet */
+  if (!object->_initialized)
+    wsky_GC_remember(object);
+}
+
+static void clearYoungObjects(void) {
+  heaps.youngObjectCount = 0;
+}
+
+static void deleteObjectIfUnmarked(Page *page, Object *object) {
+  if (!object->_gcMark)
+    deleteObject(page, object);
+  else
+    promote(object);
+}
+
+static void addDeadClass(Object *class) {
+  if (heaps.deadClassCount == heaps.deadClassCapacity) {
+    size_t capacity = heaps.deadClassCapacity ?
+      heaps.deadClassCapacity * 2 : 16;
+    Object **classes = wsky_realloc(heaps.deadClasses,
+                                    capacity * sizeof(Object *));
+    if (!classes)
+      abort();
+    heaps.deadClasses = classes;
+    heaps.deadClassCapacity = capacity;
+  }
+  heaps.deadClasses[heaps.deadClassCount++] = class;
+}
+
+static void deleteDeadClasses(void) {
+  for (size_t i = 0; i < heaps.deadClassCount; i++) {
+    Object *class = heaps.deadClasses[i];
+    deleteObject(getPage(class), class);
+  }
+  heaps.deadClassCount = 0;
+}
+
+static void sweepObject(Page *page, Object *object) {
+  if (object->_gcMark)
+    return;
+  if (object->class == wsky_Class_CLASS) {
+    addDeadClass(object);
+    return;
+  }
+  destroyObject(object);
+  releaseSlot(page, object);
+}
+
+/** Deletes the unmarked objects of a page and refills the free list */
+static void Page_sweep(Page *page) {
+  Page_forEachObject(page, sweepObject);
+  Page_forEachFreeSlot(page, addFreeSlot);
+  assert(heaps.unsweptPageCount > 0);
+  heaps.unsweptPageCount--;
+  if (!heaps.unsweptPageCount) {
+    deleteDeadClasses();
+    heaps_releaseEmptyHeaps();
+  }
+}
+
+/**
+ * Promotes the young objects. The unreachable ones are made old too:
+ * they are deleted by the sweep.
+ */
+static void promoteYoungObjects(void) {
+  for (size_t i = 0; i < heaps.youngObjectCount; i++) {
+    Object *object = heaps.youngObjects[i];
+    Page *page = getPage(object);
+    if (!Page_isAllocated(page, Page_getIndex(page, object)))
+      continue;
+    if (object->_gcMark)
+      promote(object);
+    else
+      object->_gcOld = true;
+  }
+  clearYoungObjects();
+  heaps.youngBytes = 0;
+}
+
+void wsky_heaps_deleteUnmarkedObjects(void) {
+  assert(!heaps.unsweptPageCount);
+  promoteYoungObjects();
+
+  for (size_t i = 0; i < SIZE_CLASS_COUNT; i++)
+    heaps.sizeClasses[i].freeSlots = NULL;
+
+  for (Heap *heap = heaps.heaps; heap; heap = heap->next) {
+    for (size_t i = 0; i < heap->pageCount; i++) {
+      Page *page = heap->pages + i;
+      page->nextUnswept = page->sizeClass->unsweptPages;
+      page->sizeClass->unsweptPages = page;
+      heaps.unsweptPageCount++;
+    }
+  }
+}
+
+bool wsky_heaps_sweep(size_t pageCount) {
+  for (size_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+    SizeClass *sizeClass = heaps.sizeClasses + i;
+    while (pageCount && sizeClass->unsweptPages) {
+      Page *page = sizeClass->unsweptPages;
+      sizeClass->unsweptPages = page->nextUnswept;
+      Page_sweep(page);
+      pageCount--;
+    }
+  }
+  return !heaps.unsweptPageCount;
+}
+
+size_t wsky_heaps_getUnsweptPageCount(void) {
+  return heaps.unsweptPageCount;
+}
+
+/**
+ * Returns the page of a young object, or NULL if the object has been
+ * freed or promoted since it has been added to the young objects.
+ */
+static Page *getYoungObjectPage(Object *object) {
+  Page *page = getPage(object);
+  if (!Page_isAllocated(page, Page_getIndex(page, object)))
+    return NULL;
+  if (object->_gcOld)
+    return NULL;
+  return page;
+}
+
+void wsky_heaps_deleteUnmarkedYoungObjects(void) {
+  for (size_t i = 0; i < heaps.youngObjectCount; i++) {
+    Object *object = heaps.youngObjects[i];
+    Page *page = getYoungObjectPage(object);
+    if (page)
+      deleteObjectIfUnmarked(page, object);
+  }
+  clearYoungObjects();
+}
+
+void wsky_heaps_forEachMarkedYoungObject(void (*function)(Object *)) {
+  for (size_t i = 0; i < heaps.youngObjectCount; i++) {
+    Object *object = heaps.youngObjects[i];
+    if (getYoungObjectPage(object) && object->_gcMark)
+      function(object);
+  }
+}
+
+static void (*markedObjectFunction)(Object *);
+
+static void callIfMarked(Page *page, Object *object) {
+  (void)page;
+  if (object->_gcMark)
+    markedObjectFunction(object);
+}
+
+void wsky_heaps_forEachMarkedObject(void (*function)(Object *)) {
+  markedObjectFunction = function;
+  forEachObject(callIfMarked);
+}
+
+
+
+/*
+ * The compaction is mostly-copying: the pages which contain an object
+ * referenced by an ambiguous root are pinned, the other sparse pages are
+ * evacuated. The old slot of a moved object keeps its new address until
+ * the references are updated.
+ */
+
+typedef struct {
+  wsky_OBJECT_HEAD
+
+  Object *newAddress;
+} MovedObject;
+
+/** The number of pages of a size class and their objects */
+typedef struct {
+  Page          *page;
+  size_t        objectCount;
+} PageUsage;
+
+void wsky_heaps_pin(void *pointer) {
+  if ((char *)pointer < (char *)heaps.lowestAddress ||
+      (char *)pointer > (char *)heaps.highestAddress)
+    return;
+  Page *page = getPage(pointer);
+  if (page && Page_isAllocated(page, Page_getIndex(page, pointer)))
+    page->pinned = true;
+}
+
+/**
+ * Returns true if an object can be moved. The classes, the modules, the
+ * methods and the program files are referenced from memory which is not
+ * visited by the garbage collector, like the global variables, the module
+ * list, the dictionaries of methods or the AST. The uninitialized objects
+ * are referenced from the C stack.
+ */
+static bool isMovable(const Object *object) {
+  Class *class = object->class;
+  return object->_initialized &&
+    class != wsky_Class_CLASS &&
+    class != wsky_Module_CLASS &&
+    class != wsky_Method_CLASS &&
+    class != wsky_ProgramFile_CLASS;
+}
+
+static bool Page_isMovable(const Page *page) {
+  if (page->pinned)
+    return false;
+  for (size_t i = 0; i < Page_getSlotCount(page); i++)
+    if (Page_isAllocated(page, i) && !isMovable(Page_getObject(page, i)))
+      return false;
+  return true;
+}
+
+static int comparePageUsages(const void *a_, const void *b_) {
+  const PageUsage *a = (const PageUsage *)a_;
+  const PageUsage *b = (const PageUsage *)b_;
+  if (a->objectCount != b->objectCount)
+    return a->objectCount < b->objectCount ? -1 : 1;
+  return 0;
+}
+
+/**
+ * Chooses the pages to evacuate, from the sparsest one, while the free
+ * slots of the other pages can hold their objects.
+ *
+ * @param usages The movable pages, sorted by object count
+ * @param freeSlotCount The free slots of all the pages of the size class
+ */
+static void selectEvacuatedPages(SizeClass *sizeClass,
+                                 PageUsage *usages, size_t count,
+                                 size_t freeSlotCount) {
+  size_t slotCount = PAGE_SIZE >> sizeClass->slotShift;
+  size_t movedCount = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t objectCount = usages[i].objectCount;
+    if (objectCount * 2 > slotCount)
+      break;
+    freeSlotCount -= slotCount - objectCount;
+    if (movedCount + objectCount > freeSlotCount)
+      break;
+    movedCount += objectCount;
+    usages[i].page->evacuated = true;
+  }
+}
+
+static size_t movedObjectCount = 0;
+
+static void moveObject(Page *page, Object *object) {
+  assert(object->_gcOld);
+  SizeClass *sizeClass = page->sizeClass;
+  FreeSlot *slot = sizeClass->freeSlots;
+  assert(slot);
+  sizeClass->freeSlots = slot->next;
+
+  Page *target = getPage(slot);
+  assert(!target->evacuated);
+  Page_setAllocated(target, Page_getIndex(target, slot));
+  memcpy(slot, object, sizeClass->slotSize);
+
+  Page_clearAllocated(page, Page_getIndex(page, object));
+  ((MovedObject *)object)->newAddress = (Object *)slot;
+  movedObjectCount++;
+}
+
+static void SizeClass_compact(SizeClass *sizeClass, PageUsage *usages) {
+  size_t count = 0;
+  size_t freeSlotCount = 0;
+  for (Heap *heap = heaps.heaps; heap; heap = heap->next) {
+    if (heap->pages[0].sizeClass != sizeClass)
+      continue;
+    for (size_t i = 0; i < heap->pageCount; i++) {
+      Page *page = heap->pages + i;
+      size_t objectCount = Page_getObjectCount(page);
+      freeSlotCount += Page_getSlotCount(page) - objectCount;
+      if (Page_isMovable(page)) {
+        usages[count].page = page;
+        usages[count].objectCount = objectCount;
+        count++;
+      }
+    }
+  }
+
+  qsort(usages, count, sizeof(PageUsage), comparePageUsages);
+  selectEvacuatedPages(sizeClass, usages, count, freeSlotCount);
+
+  /* The objects are moved to the pages which are not evacuated */
+  sizeClass->freeSlots = NULL;
+  for (Heap *heap = heaps.heaps; heap; heap = heap->next) {
+    if (heap->pages[0].sizeClass != sizeClass)
+      continue;
+    for (size_t i = 0; i < heap->pageCount; i++)
+      if (!heap->pages[i].evacuated)
+        Page_forEachFreeSlot(heap->pages + i, addFreeSlot);
+  }
+
+  for (size_t i = 0; i < count && usages[i].page->evacuated; i++)
+    Page_forEachObject(usages[i].page, moveObject);
+}
+
+size_t wsky_heaps_compact(void) {
+  assert(!heaps.unsweptPageCount);
+  assert(!heaps.youngObjectCount);
+  size_t pageCount = heaps.capacity / PAGE_SIZE;
+  if (!pageCount)
+    return 0;
+
+  PageUsage *usages = wsky_safeMalloc(pageCount * sizeof(PageUsage));
+  movedObjectCount = 0;
+  for (size_t i = 0; i < SIZE_CLASS_COUNT; i++)
+    SizeClass_compact(heaps.sizeClasses + i, usages);
+  wsky_free(usages);
+  return movedObjectCount;
+}
+
+Object *wsky_heaps_getNewAddress(Object *object) {
+  Page *page = getPage(object);
+  if (!page || !page->evacuated)
+    return object;
+  return ((MovedObject *)object)->newAddress;
+}
+
+void wsky_heaps_releaseEvacuatedPages(void) {
+  Heap **link = &heaps.heaps;
+  while (*link) {
+    Heap *heap = *link;
+    for (size_t i = 0; i < heap->pageCount; i++) {
+      heap->pages[i].pinned = false;
+      heap->pages[i].evacuated = false;
+    }
+
+    if (Heap_isEmpty(heap))
+      heaps_removeHeap(link);
+    else
+      link = &heap->next;
+  }
+
+  heaps_recomputeBounds();
+  heaps_rebuildFreeLists();
+}
+
 
 void wsky_heaps_free(void) {
   Heap *heap = heaps.heaps;
@@ -238,32 +1083,41 @@ void wsky_heaps_free(void) {
     Heap_delete(heap);
     heap = next;
   }
+  PageTable_free();
+  assert(!heaps.unsweptPageCount);
+  assert(!heaps.deadClassCount);
+  wsky_free(heaps.deadClasses);
+  heaps.deadClasses = NULL;
+  heaps.deadClassCapacity = 0;
+  wsky_free(heaps.youngObjects);
+  heaps.youngObjects = NULL;
+  heaps.youngObjectCount = 0;
+  heaps.youngObjectCapacity = 0;
+  heaps.youngBytes = 0;
+  heaps.heaps = NULL;
+  initSizeClasses();
+  heaps.lowestAddress = NULL;
+  heaps.highestAddress = NULL;
+  heaps.capacity = 0;
+  heaps.objectCount = 0;
+  heaps.allocatedBytes = 0;
+  heaps.recentPeakSize = 0;
+  heaps.previousPeakSize = 0;
 }
 
 
-static inline bool isAlignedWithHeap(void *pointer, const Heap *heap) {
-  char *objects = (char *)heap->objects;
-  assert(pointer >= (void *)objects);
-  return ((size_t)((char *)pointer - objects) % sizeof(ObjectUnion)) == 0;
-}
-
 bool wsky_heaps_contains(void *pointer_) {
   char *pointer = (char *)pointer_;
   if (pointer < (char *)heaps.lowestAddress ||
       pointer > (char *)heaps.highestAddress)
     return false;
 
-  Heap *heap = heaps.heaps;
-  while (heap) {
-    ObjectUnion *objects = heap->objects;
-    if (pointer >= (char *)objects &&
-        pointer < (char *)(objects + heap->count)) {
-      if (isAlignedWithHeap(pointer_, heap)) {
-        if (!ObjectUnion_isFree((ObjectUnion *)pointer_))
-          return true;
-      }
-    }
-    heap = heap->next;
-  }
-  return false;
+  Page *page = getPage(pointer);
+  if (!page)
+    return false;
+
+  size_t offset = (uintptr_t)pointer & (PAGE_SIZE - 1);
+  if (offset & (page->sizeClass->slotSize - 1))
+    return false;
+  return Page_isAllocated(page, offset >> page->sizeClass->slotShift);
 }
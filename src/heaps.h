@@ -10,16 +10,98 @@ bool wsky_heaps_contains(void *pointer);
  *
  * Never returns NULL.
  *
+ * @param objectSize The size of the object, at most 256 bytes.
  * @param className The class name, for debugging purposes only.
  */
-Object *wsky_heaps_allocateObject(const char *className);
+Object *wsky_heaps_allocateObject(size_t objectSize, const char *className);
 
 void wsky_heaps_unmark(void);
 
+/**
+ * Deletes the unmarked objects and promotes the other ones.
+ *
+ * The sweep is lazy: the pages are swept when their size class runs out
+ * of free slots, or by wsky_heaps_sweep().
+ */
 void wsky_heaps_deleteUnmarkedObjects(void);
 
+/**
+ * Sweeps at most the given number of pages.
+ *
+ * Returns true if all pages have been swept.
+ */
+bool wsky_heaps_sweep(size_t pageCount);
+
+/** Returns the number of pages which have not been swept yet */
+size_t wsky_heaps_getUnsweptPageCount(void);
+
+/** Calls a function on each marked object */
+void wsky_heaps_forEachMarkedObject(void (*function)(Object *));
+
+/**
+ * Deletes the unmarked objects allocated since the previous collection
+ * and promotes the other ones.
+ */
+void wsky_heaps_deleteUnmarkedYoungObjects(void);
+
+/**
+ * Calls a function on each marked object allocated since the previous
+ * collection.
+ */
+void wsky_heaps_forEachMarkedYoungObject(void (*function)(Object *));
+
+/**
+ * Pins the page which contains the given address, if it is in an
+ * allocated slot. A pinned page is not evacuated by the next compaction.
+ */
+void wsky_heaps_pin(void *pointer);
+
+/**
+ * Moves the objects of the sparse pages which are not pinned.
+ *
+ * Must be called after a full collection, when all the pages have been
+ * swept. The references must then be updated with
+ * wsky_heaps_getNewAddress(), before wsky_heaps_releaseEvacuatedPages().
+ *
+ * Returns the number of moved objects.
+ */
+size_t wsky_heaps_compact(void);
+
+/** Returns the new address of an object moved by the compaction */
+Object *wsky_heaps_getNewAddress(Object *object);
+
+/**
+ * Releases the heaps emptied by the compaction and unpins the pages.
+ */
+void wsky_heaps_releaseEvacuatedPages(void);
+
 void wsky_heaps_freeObject(Object *object);
 
+/** Returns the number of allocated objects, reachable or not */
+size_t wsky_heaps_getObjectCount(void);
+
+/** Returns the number of bytes used by the allocated objects */
+size_t wsky_heaps_getAllocatedBytes(void);
+
+/**
+ * Returns the number of bytes used by the objects allocated since the
+ * previous collection.
+ */
+size_t wsky_heaps_getYoungBytes(void);
+
+/** Returns the size of the slot of an object */
+size_t wsky_heaps_getSlotSize(const Object *object);
+
+/** Returns the size of all heaps, in bytes */
+size_t wsky_heaps_getSize(void);
+
+/**
+ * Sets the size below which the empty heaps are not released, in bytes.
+ * The garbage collector retains the bytes allocated before its next
+ * collection.
+ */
+void wsky_heaps_setRetainedSize(size_t size);
+
 /**
  * Frees everything.
  */
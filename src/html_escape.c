@@ -0,0 +1,169 @@
+#include <stdbool.h>
+#include <string.h>
+#include "whiskey_private.h"
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+
+typedef struct {
+  const char *string;
+  size_t length;
+} Entity;
+
+# define ENTITY(string) {(string), sizeof(string) - 1}
+
+/** The entities of the special bytes, the others have none */
+static const Entity ENTITIES[256] = {
+  ['<'] = ENTITY("&lt;"),
+  ['>'] = ENTITY("&gt;"),
+  ['&'] = ENTITY("&amp;"),
+  ['"'] = ENTITY("&quot;"),
+  ['\''] = ENTITY("&#39;"),
+};
+
+# undef ENTITY
+
+
+#ifdef __SSE2__
+
+/** Returns the index of the lowest bit set */
+static inline size_t getFirstBit(unsigned mask) {
+# ifdef __GNUC__
+  return (size_t)__builtin_ctz(mask);
+# else
+  size_t i = 0;
+  while (!(mask & 1)) {
+    mask >>= 1;
+    i++;
+  }
+  return i;
+# endif
+}
+
+/** Returns a mask of the special bytes among 16 ones */
+static inline unsigned findSpecial16(const char *bytes) {
+  __m128i v = _mm_loadu_si128((const __m128i *)bytes);
+  __m128i special = _mm_or_si128(
+    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('<')),
+                 _mm_cmpeq_epi8(v, _mm_set1_epi8('>'))),
+    _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('&')),
+                              _mm_cmpeq_epi8(v, _mm_set1_epi8('"'))),
+                 _mm_cmpeq_epi8(v, _mm_set1_epi8('\''))));
+  return (unsigned)_mm_movemask_epi8(special);
+}
+
+#endif /* __SSE2__ */
+
+#ifdef __AVX2__
+
+/** Returns a mask of the special bytes among 32 ones */
+static inline unsigned findSpecial32(const char *bytes) {
+  __m256i v = _mm256_loadu_si256((const __m256i *)bytes);
+  __m256i special = _mm256_or_si256(
+    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('<')),
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('>'))),
+    _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('&')),
+                                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))),
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\''))));
+  return (unsigned)_mm256_movemask_epi8(special);
+}
+
+#endif /* __AVX2__ */
+
+
+static inline size_t findSpecial(const char *bytes, size_t length) {
+  size_t i = 0;
+
+#ifdef __SSE2__
+  /* The runs are short in markup, their first bytes are tested alone */
+  size_t prefixLength = length < 8 ? length : 8;
+  for (; i < prefixLength; i++)
+    if (ENTITIES[(unsigned char)bytes[i]].string)
+      return i;
+#endif
+
+#ifdef __AVX2__
+  for (; i + 32 <= length; i += 32) {
+    unsigned mask = findSpecial32(bytes + i);
+    if (mask)
+      return i + getFirstBit(mask);
+  }
+#endif
+
+#ifdef __SSE2__
+  for (; i + 16 <= length; i += 16) {
+    unsigned mask = findSpecial16(bytes + i);
+    if (mask)
+      return i + getFirstBit(mask);
+  }
+#endif
+
+  for (; i < length; i++)
+    if (ENTITIES[(unsigned char)bytes[i]].string)
+      return i;
+  return length;
+}
+
+size_t wsky_html_findSpecial(const char *bytes, size_t length) {
+  return findSpecial(bytes, length);
+}
+
+const char *wsky_html_getEntity(char c, size_t *length) {
+  const Entity *entity = ENTITIES + (unsigned char)c;
+  *length = entity->length;
+  return entity->string;
+}
+
+size_t wsky_html_getEscapedLength(const char *bytes, size_t length) {
+  size_t escapedLength = 0;
+  while (length) {
+    size_t run = findSpecial(bytes, length);
+    escapedLength += run;
+    if (run == length)
+      break;
+    escapedLength += ENTITIES[(unsigned char)bytes[run]].length;
+    bytes += run + 1;
+    length -= run + 1;
+  }
+  return escapedLength;
+}
+
+/** Copies some bytes, without calling memcpy() for the short runs */
+static inline void copyRun(char *dest, const char *bytes, size_t length) {
+  if (length > 16) {
+    memcpy(dest, bytes, length);
+    return;
+  }
+  for (size_t i = 0; i < length; i++)
+    dest[i] = bytes[i];
+}
+
+char *wsky_html_escape(char *dest, const char *bytes, size_t length) {
+  while (length) {
+    size_t run = findSpecial(bytes, length);
+    copyRun(dest, bytes, run);
+    dest += run;
+    if (run == length)
+      break;
+    const Entity *entity = ENTITIES + (unsigned char)bytes[run];
+    copyRun(dest, entity->string, entity->length);
+    dest += entity->length;
+    bytes += run + 1;
+    length -= run + 1;
+  }
+  return dest;
+}
+
+const char *wsky_html_getScannerName(void) {
+#if defined(__AVX2__)
+  return "avx2";
+#elif defined(__SSE2__)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,109 @@
+#include <string.h>
+#include "whiskey_private.h"
+
+
+static size_t hitCount = 0;
+static size_t missCount = 0;
+
+
+void wsky_InlineCache_init(InlineCache *cache) {
+  memset(cache, 0, sizeof(InlineCache));
+}
+
+static Method *findMethod(InlineCache *cache, Class *class,
+                          const char *name,
+                          Method *(*find)(Class *, const char *)) {
+  for (unsigned i = 0; i < wsky_InlineCache_SIZE; i++) {
+    InlineCacheEntry *entry = cache->entries + i;
+    if (entry->class == class && entry->version == class->version) {
+      hitCount++;
+      return entry->method;
+    }
+  }
+  missCount++;
+
+  Method *method = find(class, name);
+
+  InlineCacheEntry *entry = cache->entries + cache->next;
+  cache->next = (cache->next + 1) % wsky_InlineCache_SIZE;
+  entry->class = class;
+  entry->version = class->version;
+  entry->method = method;
+  return method;
+}
+
+Method *wsky_InlineCache_findMethodOrGetter(InlineCache *cache,
+                                            Class *class,
+                                            const char *name) {
+  return findMethod(cache, class, name, wsky_Class_findMethodOrGetter);
+}
+
+Method *wsky_InlineCache_findSetter(InlineCache *cache,
+                                    Class *class,
+                                    const char *name) {
+  return findMethod(cache, class, name, wsky_Class_findSetter);
+}
+
+static bool isFieldCached(const FieldCache *cache,
+                          const ObjectFields *fields, const Class *class) {
+  return cache->shapeId == fields->shape->id && cache->class == class;
+}
+
+Value *wsky_InlineCache_getField(InlineCache *cache, ObjectFields *fields,
+                                 const Class *class, const char *name) {
+  FieldCache *field = &cache->field;
+  if (isFieldCached(field, fields, class)) {
+    hitCount++;
+    return fields->values + field->index;
+  }
+  missCount++;
+
+  Symbol symbol = wsky_Symbol_find(name);
+  if (!symbol)
+    return NULL;
+  int index = wsky_Shape_getIndex(fields->shape, class, symbol);
+  if (index == -1)
+    return NULL;
+
+  field->shapeId = fields->shape->id;
+  field->class = class;
+  field->newShape = fields->shape;
+  field->index = (unsigned)index;
+  return fields->values + index;
+}
+
+void wsky_InlineCache_setField(InlineCache *cache, ObjectFields *fields,
+                               const Class *class, const char *name,
+                               Value value) {
+  FieldCache *field = &cache->field;
+  if (isFieldCached(field, fields, class)) {
+    hitCount++;
+  } else {
+    missCount++;
+    const Shape *shape = fields->shape;
+    Symbol symbol = wsky_Symbol_intern(name);
+    int index = wsky_Shape_getIndex(shape, class, symbol);
+    field->shapeId = shape->id;
+    field->class = class;
+    if (index == -1) {
+      field->newShape = wsky_Shape_addField(shape, class, symbol);
+      field->index = shape->fieldCount;
+    } else {
+      field->newShape = shape;
+      field->index = (unsigned)index;
+    }
+  }
+
+  if (field->newShape != fields->shape)
+    *wsky_ObjectFields_add(fields, field->newShape) = value;
+  else
+    fields->values[field->index] = value;
+}
+
+size_t wsky_InlineCache_getHitCount(void) {
+  return hitCount;
+}
+
+size_t wsky_InlineCache_getMissCount(void) {
+  return missCount;
+}
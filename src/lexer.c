@@ -784,7 +784,11 @@ static TokenResult lexHtml(StringReader *reader) {
   }
   if (begin.index == reader->position.index)
     return TokenResult_NULL;
-  return createTokenResult(reader, begin, wsky_TokenType_HTML);
+
+  /* The HTML is a slice of the content of the file, it is not copied */
+  Token token = wsky_Token_create(begin, reader->position, NULL,
+                                  wsky_TokenType_HTML);
+  return createResultFromToken(token);
 }
 
 
@@ -9,8 +9,12 @@ int main(int argc, char **argv)
   printf("Whiskey\n");
 
   bool debugMode = false;
-  if (argc >= 2 && strcmp(argv[1], "--debug") == 0)
-    debugMode = true;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--debug") == 0)
+      debugMode = true;
+    else if (strcmp(argv[i], "--vm") == 0)
+      wsky_vm_setEnabled(true);
+  }
   wsky_repl(debugMode);
   return 0;
 }
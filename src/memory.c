@@ -1,5 +1,13 @@
+#define _DEFAULT_SOURCE
 #include "whiskey.h"
 
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+# if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#  define MAP_ANONYMOUS MAP_ANON
+# endif
+#endif
+
 void *wsky__safeMallocImpl(size_t size, const char *file, int line) {
   void *data = wsky_malloc(size);
   if (data)
@@ -10,3 +18,22 @@ void *wsky__safeMallocImpl(size_t size, const char *file, int line) {
           file, line);
   abort();
 }
+
+void *wsky_allocatePages(size_t size) {
+#ifdef HAVE_MMAP
+  void *pages = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return pages == MAP_FAILED ? NULL : pages;
+#else
+  return wsky_malloc(size);
+#endif
+}
+
+void wsky_freePages(void *pages, size_t size) {
+#ifdef HAVE_MMAP
+  munmap(pages, size);
+#else
+  (void)size;
+  wsky_free(pages);
+#endif
+}
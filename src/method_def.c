@@ -1,4 +1,3 @@
-#include <string.h>
 #include <assert.h>
 #include "whiskey_private.h"
 
@@ -7,21 +6,22 @@ static Result wsky_MethodDef_callImpl(const MethodDef *method,
                                            Object *object,
                                            unsigned parameterCount,
                                            const Value *constParams) {
-  Value parameters[64];
-  memcpy(parameters, constParams, sizeof(Value) * parameterCount);
-
   wsky_Method0 m = (wsky_Method0)method->function;
 
   if (method->parameterCount == -1) {
     return ((wsky_VariadicMethod) m)(object,
                                      parameterCount,
-                                     parameters);
+                                     constParams);
   } else {
     if ((int) parameterCount != method->parameterCount) {
       RAISE_NEW_PARAMETER_ERROR("Invalid parameter count");
     }
   }
 
+  /* The parameters are passed in place, the native methods do not
+     modify them */
+  Value *parameters = (Value *)constParams;
+
   switch (method->parameterCount) {
   case 0:
     return ((wsky_Method0) m)(object);
@@ -50,6 +50,33 @@ static Result wsky_MethodDef_callImpl(const MethodDef *method,
                               parameters + 2,
                               parameters + 3,
                               parameters + 4);
+  case 6:
+    return ((wsky_Method6) m)(object,
+                              parameters,
+                              parameters + 1,
+                              parameters + 2,
+                              parameters + 3,
+                              parameters + 4,
+                              parameters + 5);
+  case 7:
+    return ((wsky_Method7) m)(object,
+                              parameters,
+                              parameters + 1,
+                              parameters + 2,
+                              parameters + 3,
+                              parameters + 4,
+                              parameters + 5,
+                              parameters + 6);
+  case 8:
+    return ((wsky_Method8) m)(object,
+                              parameters,
+                              parameters + 1,
+                              parameters + 2,
+                              parameters + 3,
+                              parameters + 4,
+                              parameters + 5,
+                              parameters + 6,
+                              parameters + 7);
   default:
     fprintf(stderr, "wsky_Method_call(): Too many parameters\n");
     abort();
@@ -18,10 +18,10 @@ static Result getNaN(Object *self) {
 static Result valueToFloat(Value value, wsky_float *result) {
   *result = 0.0f;
   if (wsky_isFloat(value)) {
-    *result = value.v.floatValue;
+    *result = Value_toFloat(value);
     RETURN_NULL;
   } else if (wsky_isInteger(value)) {
-    *result = value.v.intValue;
+    *result = Value_toInt(value);
     RETURN_NULL;
   }
   RAISE_NEW_PARAMETER_ERROR("Expected a number");
@@ -63,7 +63,7 @@ static Result wsky_sign(Object *self, Value *number) {
   (void)self;
 
   if (wsky_isInteger(*number))
-    return integerSign(number->v.intValue);
+    return integerSign(Value_toInt(*number));
 
   wsky_float nb;
   Result rv = valueToFloat(*number, &nb);
@@ -90,7 +90,7 @@ static Result wsky_abs(Object *self, Value *number) {
   (void)self;
 
   if (wsky_isInteger(*number))
-    return absInteger(number->v.intValue);
+    return absInteger(Value_toInt(*number));
 
   wsky_float nb;
   Result rv = valueToFloat(*number, &nb);
@@ -238,20 +238,24 @@ static Result max(Object *self,
   if (parameterCount == 0)
     RAISE_NEW_PARAMETER_ERROR("Expected at least one parameter");
 
-  Value largest = parameters[0];
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  Value *largest = wsky_Handle_new(parameters[0]);
 
+  Result rv = Result_NULL;
   for (unsigned i = 1; i < parameterCount; i++) {
     Value value = parameters[i];
-    Result rv = wsky_doBinaryOperation(value,
-                                            wsky_Operator_GT,
-                                            largest);
+    rv = wsky_doBinaryOperation(value, wsky_Operator_GT, *largest);
     if (rv.exception)
-      return rv;
-    if (wsky_isBoolean(rv.v) && rv.v.v.boolValue)
-      largest = value;
+      break;
+    if (wsky_isBoolean(rv.v) && Value_toBool(rv.v))
+      *largest = value;
   }
 
-  RETURN_VALUE(largest);
+  if (!rv.exception)
+    rv = Result_fromValue(*largest);
+  wsky_HandleScope_close(&handleScope);
+  return rv;
 }
 
 static Result min(Object *self,
@@ -261,20 +265,24 @@ static Result min(Object *self,
   if (parameterCount == 0)
     RAISE_NEW_PARAMETER_ERROR("Expected at least one parameter");
 
-  Value smallest = parameters[0];
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  Value *smallest = wsky_Handle_new(parameters[0]);
 
+  Result rv = Result_NULL;
   for (unsigned i = 1; i < parameterCount; i++) {
     Value value = parameters[i];
-    Result rv = wsky_doBinaryOperation(value,
-                                            wsky_Operator_LT,
-                                            smallest);
+    rv = wsky_doBinaryOperation(value, wsky_Operator_LT, *smallest);
     if (rv.exception)
-      return rv;
-    if (wsky_isBoolean(rv.v) && rv.v.v.boolValue)
-      smallest = value;
+      break;
+    if (wsky_isBoolean(rv.v) && Value_toBool(rv.v))
+      *smallest = value;
   }
 
-  RETURN_VALUE(smallest);
+  if (!rv.exception)
+    rv = Result_fromValue(*smallest);
+  wsky_HandleScope_close(&handleScope);
+  return rv;
 }
 
 #define addValue wsky_Module_addValue
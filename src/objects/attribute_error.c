@@ -17,6 +17,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_AttributeError_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "AttributeError",
+  .objectSize = sizeof(AttributeError),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -35,7 +36,7 @@ AttributeError *wsky_AttributeError_new(const char *message) {
   r = wsky_Object_new(wsky_AttributeError_CLASS, 1, &v);
   if (r.exception)
     abort();
-  return (AttributeError *) r.v.v.objectValue;
+  return (AttributeError *) Value_toObject(r.v);
 }
 
 AttributeError *wsky_AttributeError_newNoAttr(const char *className,
@@ -18,6 +18,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Boolean_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Boolean",
+  .objectSize = 0,
   .final = true,
   .constructor = NULL,
   .privateConstructor = true,
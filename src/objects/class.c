@@ -46,6 +46,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Class_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Class",
+  .objectSize = sizeof(Class),
   .final = true,
   .constructor = NULL,
   .privateConstructor = true,
@@ -58,6 +59,14 @@ Class *wsky_Class_CLASS;
 
 
 
+/** The last version given to a class */
+static unsigned lastVersion = 0;
+
+void wsky_Class_updateVersion(Class *class) {
+  class->version = ++lastVersion;
+}
+
+
 static inline bool isSetter(MethodFlags flags) {
   return flags & wsky_MethodFlags_SET;
 }
@@ -75,12 +84,14 @@ void wsky_Class_initMethods(Class *class, const ClassDef *def) {
     if (isConstructor(method->flags))
       abort();
 
+    wsky_GC_writeBarrierObject(class, method);
     if (isSetter(method->flags))
       wsky_Dict_set(class->setters, method->name, method);
     else
       wsky_Dict_set(class->methods, method->name, method);
     methodDef++;
   }
+  wsky_Class_updateVersion(class);
 }
 
 
@@ -88,22 +99,29 @@ Class *wsky_Class_new(const char *name, Class *super) {
   if (super)
     assert(!super->final);
 
-  Class *class = (Class *)wsky_heaps_allocateObject("Class");
+  Class *class = (Class *)wsky_heaps_allocateObject(sizeof(Class), "Class");
   if (!class)
     return NULL;
   class->_initialized = false;
 
   class->class = wsky_Class_CLASS;
-  class->name = wsky_strdup(name);
+  class->name = wsky_Symbol_intern(name);
   class->native = false;
   class->final = false;
   class->super = super;
   class->gcAcceptFunction = NULL;
   class->destructor = NULL;
 
+  /* The objects of the Whiskey classes have fields */
+  class->objectSize = sizeof(Object);
+  if (super && super->objectSize > class->objectSize)
+    class->objectSize = super->objectSize;
+
   class->methods = wsky_Dict_new();
   class->setters = wsky_Dict_new();
   class->constructor = NULL;
+  class->shape = wsky_Shape_newRoot();
+  wsky_Class_updateVersion(class);
 
   class->_initialized = true;
   return class;
@@ -120,6 +138,8 @@ Class *wsky_Class_newFromC(const ClassDef *def, Class *super) {
   class->final = def->final;
   class->gcAcceptFunction = def->gcAcceptFunction;
   class->destructor = def->destructor;
+  if (def->objectSize)
+    class->objectSize = def->objectSize;
 
   class->constructor = NULL;
 
@@ -143,6 +163,7 @@ Class *wsky_Class_newFromC(const ClassDef *def, Class *super) {
         (wsky_Method0)def->constructor,
       };
       class->constructor = wsky_Method_newFromC(&ctorDef, class);
+      wsky_GC_writeBarrierObject(class, class->constructor);
     }
 
   }
@@ -152,13 +173,14 @@ Class *wsky_Class_newFromC(const ClassDef *def, Class *super) {
 static Result destroy(Object *object) {
   Class *self = (Class *) object;
   /*printf("Destroying class %s\n", self->name);*/
-  wsky_free(self->name);
   wsky_Dict_delete(self->methods);
   wsky_Dict_delete(self->setters);
+  wsky_Shape_delete(self->shape);
   RETURN_NULL;
 }
 
 
+/* The methods are never moved, the dictionary does not need an update */
 static void methodAcceptGC(const char *name, void *value) {
   (void) name;
   wsky_GC_visitObject(value);
@@ -192,10 +214,10 @@ static Result init(Class *class,
 
   const Value *self_ = parameters;
 
-  if (self_->type != Type_OBJECT)
+  if (Value_getType(*self_) != Type_OBJECT)
     RAISE_NEW_EXCEPTION("Not implemented");
 
-  Object *self = self_->v.objectValue;
+  Object *self = Value_toObject(*self_);
   if (!wsky_Object_isA(self, class))
     RAISE_NEW_TYPE_ERROR("Type error");
 
@@ -213,12 +235,12 @@ static Result get(Class *class, Value *self_, Value *name_) {
   if (!wsky_isString(*name_))
     RAISE_NEW_PARAMETER_ERROR("The 2nd parameter must be a string");
 
-  const char *name = ((String *)name_->v.objectValue)->string;
+  const char *name = ((String *)Value_toObject(*name_))->string;
 
-  if (self_->type != Type_OBJECT)
+  if (Value_getType(*self_) != Type_OBJECT)
     RAISE_NEW_EXCEPTION("Not implemented");
 
-  Object *self = self_->v.objectValue;
+  Object *self = Value_toObject(*self_);
   if (!self)
     RAISE_NEW_EXCEPTION("Not implemented");
 
@@ -230,12 +252,12 @@ static Result set(Class *class, Value *self_,
   if (!wsky_isString(*name_))
     RAISE_NEW_PARAMETER_ERROR("The 2nd parameter must be a string");
 
-  const char *name = ((String *)name_->v.objectValue)->string;
+  const char *name = ((String *)Value_toObject(*name_))->string;
 
-  if (self_->type != Type_OBJECT)
+  if (Value_getType(*self_) != Type_OBJECT)
     RAISE_NEW_EXCEPTION("Not implemented");
 
-  Object *self = self_->v.objectValue;
+  Object *self = Value_toObject(*self_);
   if (!self)
     RAISE_NEW_EXCEPTION("Not implemented");
 
@@ -245,8 +267,8 @@ static Result set(Class *class, Value *self_,
 
 
 void wsky_Class_acceptGC(Object *object) {
+  wsky_GC_visitObject(object->class);
   Class *class = object->class;
-  wsky_GC_visitObject(class);
   if (!class->native)
     wsky_ObjectFields_acceptGc(&object->fields);
   if (class->gcAcceptFunction) {
@@ -266,29 +288,26 @@ static inline bool isGetter(MethodFlags flags) {
 
 
 
-static ObjectFields *getFields(Class *wantedClass, Object *self) {
-  ObjectFields *fields = &self->fields;
-  Class *class = self->class;
-  while (fields) {
-    assert(!class->native);
-    if (class == wantedClass)
-      return fields;
-    class = class->super;
-    fields = fields->parent;
-  }
-  return NULL;
-}
-
 Result wsky_Class_getField(Class *class, Object *self,
                                 const char *name) {
   assert(!class->native);
-  ObjectFields *fields = getFields(class, self);
+  Symbol symbol = wsky_Symbol_find(name);
+  Value *v = NULL;
+  if (symbol)
+    v = wsky_ObjectFields_get(&self->fields, class, symbol);
+  if (v)
+    return Result_fromValue(*v);
 
-  if (fields) {
-    Value *v = wsky_Dict_get(&fields->fields, name);
-    if (v)
-      return Result_fromValue(*v);
-  }
+  const char *className = wsky_Object_getClassName(self);
+  return wsky_AttributeError_raiseNoAttr(className, name);
+}
+
+static Result getFieldCached(Class *class, Object *self,
+                             const char *name, InlineCache *cache) {
+  assert(!class->native);
+  Value *v = wsky_InlineCache_getField(cache, &self->fields, class, name);
+  if (v)
+    return Result_fromValue(*v);
 
   const char *className = wsky_Object_getClassName(self);
   return wsky_AttributeError_raiseNoAttr(className, name);
@@ -304,6 +323,17 @@ Result wsky_Class_callGetter(Object *self,
   return wsky_Method_call0(method, self);
 }
 
+/** Like wsky_Class_callGetter(), or through a cache if it is not NULL */
+static Result callGetterCached(Object *self, Method *method,
+                               const char *name, InlineCache *cache) {
+  assert(isGetter(method->flags));
+
+  if (wsky_Method_isDefault(method) && cache)
+    return getFieldCached(method->defClass, self, name, cache);
+
+  return wsky_Class_callGetter(self, method, name);
+}
+
 
 static Result raiseTypeError(const char *expectedClass,
                                   const char *class) {
@@ -312,23 +342,34 @@ static Result raiseTypeError(const char *expectedClass,
   RAISE_NEW_TYPE_ERROR(buffer);
 }
 
-Result wsky_Class_get(Class *class, Object *self,
-                           const char *attribute) {
-  if (!wsky_Object_isA(self, class))
-    return raiseTypeError(class->name, wsky_Object_getClass(self)->name);
-
-  Method *method = wsky_Class_findMethodOrGetter(class, attribute);
-
+/**
+ * Returns a public member, given the method found in the class
+ *
+ * @param cache The cache of the fields or NULL
+ */
+static Result getPublicMember(Class *class, Object *self,
+                              const char *attribute, Method *method,
+                              InlineCache *cache) {
   if (!method || !isPublic(method->flags))
     return wsky_AttributeError_raiseNoAttr(class->name, attribute);
 
   if (isGetter(method->flags))
-    return wsky_Class_callGetter(self, method, attribute);
+    return callGetterCached(self, method, attribute, cache);
 
   Value v = wsky_Value_fromObject(self);
   RETURN_OBJECT((Object *)wsky_InstanceMethod_new(method, v));
 }
 
+
+Result wsky_Class_get(Class *class, Object *self,
+                           const char *attribute) {
+  if (!wsky_Object_isA(self, class))
+    return raiseTypeError(class->name, wsky_Object_getClass(self)->name);
+
+  Method *method = wsky_Class_findMethodOrGetter(class, attribute);
+  return getPublicMember(class, self, attribute, method, NULL);
+}
+
 Result wsky_Class_getPrivate(Class *class, Object *self,
                                   const char *attribute) {
   if (!wsky_Object_isA(self, class))
@@ -341,24 +382,48 @@ Result wsky_Class_getPrivate(Class *class, Object *self,
   return wsky_Class_getField(class, self, attribute);
 }
 
+Result wsky_Class_getCached(Class *class, Object *self,
+                            const char *attribute, InlineCache *cache) {
+  if (!wsky_Object_isA(self, class))
+    return raiseTypeError(class->name, wsky_Object_getClass(self)->name);
+
+  Method *method = wsky_InlineCache_findMethodOrGetter(cache, class,
+                                                       attribute);
+  return getPublicMember(class, self, attribute, method, cache);
+}
+
+Result wsky_Class_getPrivateCached(Class *class, Object *self,
+                                   const char *attribute,
+                                   InlineCache *cache) {
+  if (!wsky_Object_isA(self, class))
+    return raiseTypeError(class->name, wsky_Object_getClass(self)->name);
+
+  Method *method = wsky_InlineCache_findMethodOrGetter(cache, class,
+                                                       attribute);
+  if (method)
+    return callGetterCached(self, method, attribute, cache);
+
+  return getFieldCached(class, self, attribute, cache);
+}
+
 
 
 Result wsky_Class_setField(Class *class, Object *self,
                                 const char *name, Value value) {
   assert(!class->native);
-  ObjectFields *fields = getFields(class, self);
-
-  if (fields) {
-    free(wsky_Dict_get(&fields->fields, name));
-
-    Value *mv = malloc(sizeof(Value));
-    *mv = value;
-    wsky_Dict_set(&fields->fields, name, mv);
-    RETURN_VALUE(value);
-  }
+  Symbol symbol = wsky_Symbol_intern(name);
+  wsky_ObjectFields_set(&self->fields, class, symbol, value);
+  wsky_GC_writeBarrier(self, value);
+  RETURN_VALUE(value);
+}
 
-  const char *className = wsky_Object_getClassName(self);
-  return wsky_AttributeError_raiseNoAttr(className, name);
+static Result setFieldCached(Class *class, Object *self,
+                             const char *name, Value value,
+                             InlineCache *cache) {
+  assert(!class->native);
+  wsky_InlineCache_setField(cache, &self->fields, class, name, value);
+  wsky_GC_writeBarrier(self, value);
+  RETURN_VALUE(value);
 }
 
 Result wsky_Class_callSetter(Object *self,
@@ -372,6 +437,17 @@ Result wsky_Class_callSetter(Object *self,
   return wsky_Method_call1(method, self, value);
 }
 
+static Result callSetterCached(Object *self, Method *method,
+                               const char *name, Value value,
+                               InlineCache *cache) {
+  assert(isSetter(method->flags));
+
+  if (wsky_Method_isDefault(method))
+    return setFieldCached(method->defClass, self, name, value, cache);
+
+  return wsky_Method_call1(method, self, value);
+}
+
 Result wsky_Class_set(Class *class, Object *self,
                            const char *attribute, Value value) {
   if (!wsky_Object_isA(self, class))
@@ -398,6 +474,33 @@ Result wsky_Class_setPrivate(Class *class, Object *self,
   return wsky_Class_setField(class, self, attribute, value);
 }
 
+Result wsky_Class_setCached(Class *class, Object *self,
+                            const char *attribute, Value value,
+                            InlineCache *cache) {
+  if (!wsky_Object_isA(self, class))
+    return raiseTypeError(class->name, wsky_Object_getClass(self)->name);
+
+  Method *method = wsky_InlineCache_findSetter(cache, class, attribute);
+
+  if (method && isPublic(method->flags))
+    return callSetterCached(self, method, attribute, value, cache);
+
+  return wsky_AttributeError_raiseNoAttr(class->name, attribute);
+}
+
+Result wsky_Class_setPrivateCached(Class *class, Object *self,
+                                   const char *attribute, Value value,
+                                   InlineCache *cache) {
+  if (!wsky_Object_isA(self, class))
+    return raiseTypeError(class->name, wsky_Object_getClass(self)->name);
+
+  Method *method = wsky_InlineCache_findSetter(cache, class, attribute);
+  if (method)
+    return callSetterCached(self, method, attribute, value, cache);
+
+  return setFieldCached(class, self, attribute, value, cache);
+}
+
 
 
 Method *wsky_Class_findLocalMethod(Class *class, const char *name) {
@@ -405,12 +508,16 @@ Method *wsky_Class_findLocalMethod(Class *class, const char *name) {
 }
 
 Method *wsky_Class_findMethodOrGetter(Class *class, const char *name) {
-  Method *method = wsky_Class_findLocalMethod(class, name);
-  if (method)
-    return method;
+  Symbol symbol = wsky_Symbol_find(name);
+  if (!symbol)
+    return NULL;
 
-  if (class->super)
-    return wsky_Class_findMethodOrGetter(class->super, name);
+  while (class) {
+    Method *method = wsky_Dict_getSymbol(class->methods, symbol);
+    if (method)
+      return method;
+    class = class->super;
+  }
   return NULL;
 }
 
@@ -420,12 +527,16 @@ Method *wsky_Class_findLocalSetter(Class *class, const char *name) {
 }
 
 Method *wsky_Class_findSetter(Class *class, const char *name) {
-  Method *method = wsky_Class_findLocalSetter(class, name);
-  if (method)
-    return method;
+  Symbol symbol = wsky_Symbol_find(name);
+  if (!symbol)
+    return NULL;
 
-  if (class->super)
-    return wsky_Class_findSetter(class->super, name);
+  while (class) {
+    Method *method = wsky_Dict_getSymbol(class->setters, symbol);
+    if (method)
+      return method;
+    class = class->super;
+  }
   return NULL;
 }
 
@@ -28,6 +28,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Exception_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Exception",
+  .objectSize = sizeof(Exception),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -53,7 +54,7 @@ Exception *wsky_Exception_new(const char *message,
   }
   if (r.exception)
     abort();
-  return (Exception *) r.v.v.objectValue;
+  return (Exception *) Value_toObject(r.v);
 }
 
 static Result construct(Object *object,
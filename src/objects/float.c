@@ -18,6 +18,7 @@ static wsky_MethodDef methods[] = {
 const wsky_ClassDef wsky_Float_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Float",
+  .objectSize = 0,
   .final = true,
   .constructor = NULL,
   .privateConstructor = true,
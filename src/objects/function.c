@@ -15,6 +15,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Function_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Function",
+  .objectSize = sizeof(Function),
   .final = true,
   .constructor = NULL,
   .privateConstructor = true,
@@ -33,10 +34,11 @@ Function *wsky_Function_newFromWsky(const char *name,
   Result r = wsky_Object_new(wsky_Function_CLASS, 0, NULL);
   if (r.exception)
     abort();
-  Function *function = (Function *) r.v.v.objectValue;
-  function->name = name ? wsky_strdup(name) : NULL;
+  Function *function = (Function *) Value_toObject(r.v);
+  function->name = name ? wsky_Symbol_intern(name) : NULL;
   assert(node);
-  function->node = (FunctionNode *)wsky_ASTNode_copy((const Node *)node);
+  function->node = wsky_FunctionNode_retain(node);
+  function->bytecode = NULL;
   function->globalScope = globalScope;
   return function;
 }
@@ -45,9 +47,10 @@ Function *wsky_Function_newFromC(const MethodDef *def) {
   Result r = wsky_Object_new(wsky_Function_CLASS, 0, NULL);
   if (r.exception)
     abort();
-  Function *function = (Function *) r.v.v.objectValue;
-  function->name = wsky_strdup(def->name);
+  Function *function = (Function *) Value_toObject(r.v);
+  function->name = wsky_Symbol_intern(def->name);
   function->node = NULL;
+  function->bytecode = NULL;
   function->cMethod = *def;
   function->globalScope = NULL;
   return function;
@@ -57,8 +60,8 @@ Function *wsky_Function_newFromC(const MethodDef *def) {
 
 static Result destroy(Object *object) {
   Function *self = (Function *) object;
-  if (self->name)
-    wsky_free(self->name);
+  if (self->bytecode)
+    wsky_Bytecode_delete(self->bytecode);
   if (self->node)
     wsky_ASTNode_delete((Node *)self->node);
   RETURN_NULL;
@@ -74,7 +77,10 @@ static void acceptGC(Object *object) {
 
 static void addVariable(Scope *scope, Node *node, const Value *value) {
   IdentifierNode *identifier = (IdentifierNode *) node;
-  wsky_Scope_addVariable(scope, identifier->name, *value);
+  if (identifier->depth == 0)
+    wsky_Scope_declareSlot(scope, identifier->slot, identifier->name, *value);
+  else
+    wsky_Scope_addVariable(scope, identifier->name, *value);
 }
 
 static void addVariables(Scope *scope,
@@ -100,26 +106,33 @@ static Result callNativeFunction(Function *function,
                              parameters);
 }
 
-Result wsky_Function_callSelf(Function *function,
-                                   Class *class,
-                                   Object *self,
-                                   unsigned parameterCount,
-                                   const Value *parameters) {
-  if (self)
-    assert(class);
-
-  if (!function->node)
-    return callNativeFunction(function, class, self,
-                              parameterCount, parameters);
+const wsky_Bytecode *wsky_Function_getBytecode(Function *function) {
+  assert(function->node);
+  if (!function->bytecode)
+    function->bytecode = wsky_Bytecode_compileFunction(function->node);
+  return function->bytecode;
+}
 
+Result wsky_Function_newCallScope(Function *function,
+                                  Class *class,
+                                  Object *self,
+                                  unsigned parameterCount,
+                                  const Value *parameters) {
   NodeList *params = function->node->parameters;
   unsigned wantedParamCount = wsky_ASTNodeList_getCount(params);
   if (wantedParamCount != parameterCount)
     RAISE_NEW_PARAMETER_ERROR("Invalid parameter count");
 
-  Scope *innerScope = wsky_Scope_new(function->globalScope, class, self);
-  wsky_eval_pushScope(innerScope);
+  Scope *innerScope = wsky_Scope_newWithSlots(function->globalScope,
+                                              class, self,
+                                              function->node->slotCount);
   addVariables(innerScope, params, parameters);
+  RETURN_OBJECT((Object *)innerScope);
+}
+
+static Result evalBody(Function *function, Scope *innerScope) {
+  if (wsky_vm_isEnabled())
+    return wsky_vm_run(wsky_Function_getBytecode(function), innerScope);
 
   Result rv = Result_NULL;
   NodeList *child = function->node->children;
@@ -129,7 +142,30 @@ Result wsky_Function_callSelf(Function *function,
       break;
     child = child->next;
   }
+  return rv;
+}
 
+Result wsky_Function_callSelf(Function *function,
+                                   Class *class,
+                                   Object *self,
+                                   unsigned parameterCount,
+                                   const Value *parameters) {
+  if (self)
+    assert(class);
+
+  if (!function->node)
+    return callNativeFunction(function, class, self,
+                              parameterCount, parameters);
+
+  Result rv = wsky_Function_newCallScope(function, class, self,
+                                         parameterCount, parameters);
+  if (rv.exception)
+    return rv;
+
+  Scope *innerScope = (Scope *)Value_toObject(rv.v);
+  wsky_eval_pushScope(innerScope);
+  wsky_GC_safepoint();
+  rv = evalBody(function, innerScope);
   wsky_eval_popScope();
   return rv;
 }
@@ -15,6 +15,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_ImportError_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "ImportError",
+  .objectSize = sizeof(ImportError),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -33,7 +34,7 @@ ImportError *wsky_ImportError_new(const char *message) {
   r = wsky_Object_new(wsky_ImportError_CLASS, 1, &v);
   if (r.exception)
     abort();
-  return (ImportError *) r.v.v.objectValue;
+  return (ImportError *) Value_toObject(r.v);
 }
 
 
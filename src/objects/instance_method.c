@@ -24,6 +24,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_InstanceMethod_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "InstanceMethod",
+  .objectSize = sizeof(InstanceMethod),
   .final = true,
   .constructor = &construct,
   .privateConstructor = true,
@@ -39,7 +40,7 @@ InstanceMethod *wsky_InstanceMethod_new(Method *method, Value self) {
   Result r = wsky_Object_new(wsky_InstanceMethod_CLASS, 0, NULL);
   if (r.exception)
     return NULL;
-  InstanceMethod *instanceMethod = (InstanceMethod *) r.v.v.objectValue;
+  InstanceMethod *instanceMethod = (InstanceMethod *) Value_toObject(r.v);
   instanceMethod->method = method;
   instanceMethod->self = self;
 
@@ -17,6 +17,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Integer_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Integer",
+  .objectSize = 0,
   .final = true,
   .constructor = NULL,
   .privateConstructor = true,
@@ -20,6 +20,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Method_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Method",
+  .objectSize = sizeof(Method),
   .final = true,
   .constructor = NULL,
   .privateConstructor = true,
@@ -33,9 +34,7 @@ Class *wsky_Method_CLASS;
 
 
 static Result destroy(Object *object) {
-  Method *self = (Method *)object;
-  /*printf("Destroying method %s\n", self->name);*/
-  wsky_free(self->name);
+  (void) object;
   RETURN_NULL;
 }
 
@@ -51,9 +50,9 @@ static Method *new(Class *class, const char *name, MethodFlags flags,
   Result r = wsky_Object_new(wsky_Method_CLASS, 0, NULL);
   if (r.exception)
     return NULL;
-  Method *self = (Method *) r.v.v.objectValue;
+  Method *self = (Method *) Value_toObject(r.v);
   self->defClass = class;
-  self->name = wsky_strdup(name);
+  self->name = wsky_Symbol_intern(name);
   self->flags = flags;
   self->function = function;
   return self;
@@ -52,6 +52,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Module_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Module",
+  .objectSize = sizeof(Module),
   .final = true,
   .constructor = &construct,
   .privateConstructor = true,
@@ -72,7 +73,7 @@ Module *wsky_Module_new(const char *name,
   Result r = wsky_Object_new(wsky_Module_CLASS, 0, NULL);
   if (r.exception)
     return NULL;
-  Module *module = (Module *)r.v.v.objectValue;
+  Module *module = (Module *)Value_toObject(r.v);
 
   module->name = wsky_strdup(name);
   wsky_Dict_init(&module->members);
@@ -80,6 +81,7 @@ Module *wsky_Module_new(const char *name,
   if (!file)
     file = wsky_ProgramFile_getUnknown(NULL);
   module->file = file;
+  wsky_GC_writeBarrierObject(module, file);
 
   if (strcmp(name, "__main__") != 0)
     ModuleList_add(&modules, module);
@@ -140,6 +142,7 @@ void wsky_Module_addValue(Module *module,
   Value *valuePointer = wsky_Value_new(value);
   if (!valuePointer)
     abort();
+  wsky_GC_writeBarrier(module, value);
   wsky_Dict_set(&module->members, name, valuePointer);
 }
 
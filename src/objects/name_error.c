@@ -17,6 +17,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_NameError_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "NameError",
+  .objectSize = sizeof(NameError),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -35,7 +36,7 @@ NameError *wsky_NameError_new(const char *message) {
   r = wsky_Object_new(wsky_NameError_CLASS, 1, &v);
   if (r.exception)
     abort();
-  return (NameError *) r.v.v.objectValue;
+  return (NameError *) Value_toObject(r.v);
 }
 
 
@@ -17,6 +17,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_NotImplementedError_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "NotImplementedError",
+  .objectSize = sizeof(NotImplementedError),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -35,7 +36,7 @@ NotImplError *wsky_NotImplementedError_new(const char *message) {
   r = wsky_Object_new(wsky_NotImplementedError_CLASS, 1, &v);
   if (r.exception)
     abort();
-  return (NotImplError *) r.v.v.objectValue;
+  return (NotImplError *) Value_toObject(r.v);
 }
 
 
@@ -18,6 +18,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Null_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "NullClass",
+  .objectSize = 0,
   .final = true,
   .constructor = NULL,
   .privateConstructor = true,
@@ -31,6 +32,5 @@ Class *wsky_Null_CLASS;
 
 
 static Result toString(Value *self) {
-  (void) self;
-  RETURN_C_STRING("null");
+  RETURN_OBJECT((Object *) wsky_String_getCached(*self));
 }
@@ -4,68 +4,77 @@
 #include "../heaps.h"
 
 
-static void acceptGcOnField(const char* name, void *value_) {
-  (void) name;
-  wsky_GC_visitValue(*(Value *)value_);
-}
+/** The capacity of the array of values of the first field */
+#define FIELDS_INITIAL_CAPACITY 4
 
-void wsky_ObjectFields_acceptGc(ObjectFields *fields) {
-  wsky_Dict_apply(&fields->fields, &acceptGcOnField);
-  if (fields->parent)
-    wsky_ObjectFields_acceptGc(fields->parent);
+
+void wsky_ObjectFields_init(ObjectFields *fields, const Class *class) {
+  assert(!class->native);
+  fields->shape = class->shape;
+  fields->values = NULL;
+  fields->capacity = 0;
 }
 
-static void freeField(const char *name, void *value) {
-  (void) name;
-  wsky_free(value);
+void wsky_ObjectFields_acceptGc(ObjectFields *fields) {
+  for (unsigned i = 0; i < fields->shape->fieldCount; i++)
+    wsky_GC_visitValue(fields->values[i]);
 }
 
 void wsky_ObjectFields_free(ObjectFields *fields) {
-  wsky_Dict_apply(&fields->fields, &freeField);
-  wsky_Dict_free(&fields->fields);
-  if (fields->parent) {
-    wsky_ObjectFields_free(fields->parent);
-    wsky_free(fields->parent);
-  }
+  wsky_free(fields->values);
+  fields->values = NULL;
+  fields->capacity = 0;
 }
 
-static void initFields(ObjectFields *fields, Class *class);
-
-static ObjectFields *newFields(Class *class) {
-  if (class->native)
+Value *wsky_ObjectFields_get(ObjectFields *fields,
+                             const Class *class, Symbol name) {
+  int index = wsky_Shape_getIndex(fields->shape, class, name);
+  if (index == -1)
     return NULL;
-  ObjectFields *fields = wsky_safeMalloc(sizeof(ObjectFields));
-  initFields(fields, class);
-  return fields;
+  return fields->values + index;
 }
 
-static void initFields(ObjectFields *fields, Class *class) {
-  if (class->native)
-    return;
-  wsky_Dict_init(&fields->fields);
-  fields->parent = newFields(class->super);
+Value *wsky_ObjectFields_add(ObjectFields *fields, const Shape *newShape) {
+  assert(newShape->parent == fields->shape);
+  unsigned index = fields->shape->fieldCount;
+  if (index == fields->capacity) {
+    unsigned capacity = fields->capacity ?
+      fields->capacity * 2 : FIELDS_INITIAL_CAPACITY;
+    Value *values = wsky_realloc(fields->values, capacity * sizeof(Value));
+    if (!values)
+      abort();
+    fields->values = values;
+    fields->capacity = capacity;
+  }
+  fields->shape = newShape;
+  return fields->values + index;
 }
 
-static void printField(const char* name, void *value_) {
-  Value *value = (Value *)value_;
-  Result rv = wsky_toString(*value);
-  printf("    %s = ", name);
-  if (rv.exception) {
-    puts("<toString has failed>");
-  } else {
-    String *s = (String *)rv.v.v.objectValue;
-    puts(s->string);
+void wsky_ObjectFields_set(ObjectFields *fields,
+                           const Class *class, Symbol name, Value value) {
+  Value *field = wsky_ObjectFields_get(fields, class, name);
+  if (!field) {
+    const Shape *shape = wsky_Shape_addField(fields->shape, class, name);
+    field = wsky_ObjectFields_add(fields, shape);
   }
+  *field = value;
 }
 
 void wsky_ObjectFields_print(ObjectFields *fields,
                              const Class *class) {
-  printf("\nfields (in %s):\n", class->name);
-  wsky_Dict_apply(&fields->fields, &printField);
-  if (fields->parent)
-    wsky_ObjectFields_print(fields->parent, class->super);
-  else
-    puts("end");
+  printf("\nfields (of a %s):\n", class->name);
+  for (const Shape *shape = fields->shape; shape->parent;
+       shape = shape->parent) {
+    Result rv = wsky_toString(fields->values[shape->fieldCount - 1]);
+    printf("    %s.%s = ", shape->class->name, shape->name);
+    if (rv.exception) {
+      puts("<toString has failed>");
+    } else {
+      String *s = (String *)Value_toObject(rv.v);
+      puts(s->string);
+    }
+  }
+  puts("end");
 }
 
 
@@ -151,6 +160,7 @@ static MethodDef methodsDefs[] = {
 const ClassDef wsky_Object_CLASS_DEF = {
   .super = NULL,
   .name = "Object",
+  .objectSize = sizeof(Object),
   .final = false,
   .constructor = NULL,
   .privateConstructor = true,
@@ -169,7 +179,7 @@ Result wsky_Object_new(Class *class,
   if (wsky_isStarted())
     wsky_GC_requestCollection();
 
-  Object *object = wsky_heaps_allocateObject(class->name);
+  Object *object = wsky_heaps_allocateObject(class->objectSize, class->name);
   if (!object)
     RETURN_NULL;
   object->_initialized = false;
@@ -177,7 +187,7 @@ Result wsky_Object_new(Class *class,
   object->class = class;
 
   if (!class->native)
-    initFields(&object->fields, class);
+    wsky_ObjectFields_init(&object->fields, class);
 
   if (class->constructor) {
     Result rv;
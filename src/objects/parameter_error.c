@@ -15,6 +15,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_ParameterError_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "ParameterError",
+  .objectSize = sizeof(ParameterError),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -33,7 +34,7 @@ ParameterError *wsky_ParameterError_new(const char *message) {
   r = wsky_Object_new(wsky_ParameterError_CLASS, 1, &v);
   if (r.exception)
     abort();
-  return (ParameterError *) r.v.v.objectValue;
+  return (ParameterError *) Value_toObject(r.v);
 }
 
 
@@ -1,7 +1,17 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "../whiskey_private.h"
 
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
+
 
 static Result construct(Object *object,
                              unsigned paramCount,
@@ -17,6 +27,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_ProgramFile_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "ProgramFile",
+  .objectSize = sizeof(ProgramFile),
   .final = true,
   .constructor = &construct,
   .privateConstructor = true,
@@ -28,36 +39,140 @@ const ClassDef wsky_ProgramFile_CLASS_DEF = {
 Class *wsky_ProgramFile_CLASS;
 
 
-static char *readFile(FILE *file) {
-  unsigned blockSize = 32 * 1024;
-  char *string = NULL;
-  unsigned length = 0;
+static bool mappingEnabled = false;
+
+
+void wsky_FileContent_setMappingEnabled(bool enabled) {
+  mappingEnabled = enabled;
+}
+
+bool wsky_FileContent_isMappingEnabled(void) {
+  return mappingEnabled;
+}
+
+FileContent *wsky_FileContent_new(char *string, size_t length) {
+  FileContent *content = wsky_safeMalloc(sizeof(FileContent));
+  content->referenceCount = 1;
+  content->length = length;
+  content->string = string;
+  content->mapped = false;
+  return content;
+}
+
+FileContent *wsky_FileContent_retain(FileContent *content) {
+  content->referenceCount++;
+  return content;
+}
+
+void wsky_FileContent_release(FileContent *content) {
+  assert(content->referenceCount);
+  if (--content->referenceCount)
+    return;
+#ifdef HAVE_MMAP
+  if (content->mapped)
+    munmap((void *)content->string, content->length);
+  else
+#endif
+    wsky_free((char *)content->string);
+  wsky_free(content);
+}
+
+static void setContent(ProgramFile *file, FileContent *content) {
+  file->source = content;
+  file->content = content->string;
+}
+
+
+#ifdef HAVE_MMAP
+
+/** The files smaller than this are read, a mapping costs more than a copy */
+static const size_t MIN_MAPPED_SIZE = 16 * 1024;
+
+/**
+ * Maps a file. The end of its last page is filled with zeros, which
+ * terminate the string, so the files whose size is a multiple of the
+ * page size are not mapped.
+ */
+static FileContent *mapFile(int descriptor, size_t size) {
+  long pageSize = sysconf(_SC_PAGESIZE);
+  if (size < MIN_MAPPED_SIZE || pageSize <= 0 || size % (size_t)pageSize == 0)
+    return NULL;
+
+  void *string = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  if (string == MAP_FAILED)
+    return NULL;
+
+  FileContent *content = wsky_FileContent_new(NULL, size);
+  content->string = string;
+  content->mapped = true;
+  return content;
+}
+
+#endif /* HAVE_MMAP */
+
+/**
+ * Reads a file. The buffer has the size given by fstat(), it grows only
+ * if the file is larger, like a pipe or a file being written.
+ */
+static FileContent *readFile(int descriptor, size_t size) {
+  size_t capacity = size + 1;
+  char *string = wsky_safeMalloc(capacity);
+  size_t length = 0;
   while (1) {
-    string = wsky_realloc(string, length + blockSize + 1);
-    if (!string)
-      return NULL;
-    size_t readCharCount = fread(string + length, 1, blockSize, file);
-    length += readCharCount;
-    string[length] = '\0';
-    if (strlen(string) != length) {
+    if (length + 1 == capacity) {
+      capacity *= 2;
+      string = wsky_realloc(string, capacity);
+      if (!string)
+        abort();
+    }
+
+    ssize_t readCount = read(descriptor, string + length,
+                             capacity - 1 - length);
+    if (readCount < 0) {
+      if (errno == EINTR)
+        continue;
       wsky_free(string);
       return NULL;
     }
-    if (readCharCount != blockSize)
+    if (readCount == 0)
       break;
+    length += (size_t)readCount;
   }
-  return string;
+  string[length] = '\0';
+  return wsky_FileContent_new(string, length);
 }
 
-static char *wsky_openAndReadFile(const char *path) {
-  FILE *file = fopen(path, "r");
-  if (!file)
+FileContent *wsky_FileContent_load(const char *path) {
+  int descriptor = open(path, O_RDONLY);
+  if (descriptor < 0)
     return NULL;
-  char *content = readFile(file);
-  fclose(file);
+
+  struct stat st;
+  if (fstat(descriptor, &st)) {
+    close(descriptor);
+    return NULL;
+  }
+
+  size_t size = S_ISREG(st.st_mode) ? (size_t)st.st_size : 0;
+  FileContent *content = NULL;
+#ifdef HAVE_MMAP
+  if (mappingEnabled)
+    content = mapFile(descriptor, size);
+#endif
+  if (!content)
+    content = readFile(descriptor, size);
+  close(descriptor);
+  if (!content)
+    return NULL;
+
+  if (memchr(content->string, '\0', content->length)) {
+    wsky_FileContent_release(content);
+    return NULL;
+  }
   return content;
 }
 
+
 Result wsky_ProgramFile_new(const char *cPath) {
   Value v = wsky_buildValue("s", cPath);
   Result rv = wsky_Object_new(wsky_ProgramFile_CLASS, 1, &v);
@@ -67,8 +182,10 @@ Result wsky_ProgramFile_new(const char *cPath) {
 ProgramFile *wsky_ProgramFile_getUnknown(const char *content) {
   Result rv = wsky_Object_new(wsky_ProgramFile_CLASS, 0, NULL);
   assert(!rv.exception);
-  ProgramFile *file = (ProgramFile *)rv.v.v.objectValue;
-  file->content = content ? wsky_strdup(content) : NULL;
+  ProgramFile *file = (ProgramFile *)Value_toObject(rv.v);
+  if (content)
+    setContent(file, wsky_FileContent_new(wsky_strdup(content),
+                                          strlen(content)));
   return file;
 }
 
@@ -77,6 +194,7 @@ static void initUnknownFile(ProgramFile *self) {
   self->absolutePath = NULL;
   self->directoryPath = wsky_path_getCurrentDirectory();
   self->content = NULL;
+  self->source = NULL;
 }
 
 static Result construct(Object *object,
@@ -86,6 +204,8 @@ static Result construct(Object *object,
     RAISE_NEW_PARAMETER_ERROR("Parameter error");
 
   ProgramFile *self = (ProgramFile *) object;
+  self->content = NULL;
+  self->source = NULL;
 
   if (paramCount == 0) {
     initUnknownFile(self);
@@ -100,11 +220,12 @@ static Result construct(Object *object,
   if (!self->absolutePath)
     RAISE_NEW_EXCEPTION("Invalid path");
 
-  self->content = wsky_openAndReadFile(self->absolutePath);
-  if (!self->content) {
+  FileContent *content = wsky_FileContent_load(self->absolutePath);
+  if (!content) {
     wsky_free(self->absolutePath);
     RAISE_NEW_EXCEPTION("IO error");
   }
+  setContent(self, content);
 
   char *dirAbsPath = wsky_path_getDirectoryPath(self->absolutePath);
   self->directoryPath = (dirAbsPath ?
@@ -119,6 +240,7 @@ static Result destroy(Object *object) {
   wsky_free(self->name);
   wsky_free(self->absolutePath);
   wsky_free(self->directoryPath);
-  wsky_free(self->content);
+  if (self->source)
+    wsky_FileContent_release(self->source);
   RETURN_NULL;
 }
@@ -19,6 +19,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Scope_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Scope",
+  .objectSize = sizeof(Scope),
   .final = true,
   .constructor = &construct,
   .privateConstructor = true,
@@ -31,12 +32,13 @@ Class *wsky_Scope_CLASS;
 
 
 
-Scope *wsky_Scope_new(Scope *parent, Class *class, Object *self) {
+Scope *wsky_Scope_newWithSlots(Scope *parent, Class *class, Object *self,
+                               unsigned slotCount) {
   Result rv = wsky_Object_new(wsky_Scope_CLASS, 0, NULL);
   if (rv.exception)
     return NULL;
 
-  Scope *scope = (Scope *) rv.v.v.objectValue;
+  Scope *scope = (Scope *) Value_toObject(rv.v);
 
   if (class)
     assert(!class->native);
@@ -45,9 +47,21 @@ Scope *wsky_Scope_new(Scope *parent, Class *class, Object *self) {
   scope->self = self;
   scope->module = NULL;
   wsky_Dict_init(&scope->variables);
+
+  scope->slotCount = slotCount;
+  if (slotCount) {
+    size_t slotSize = sizeof(Value) + sizeof(Symbol);
+    scope->slots = wsky_safeMalloc(slotCount * slotSize);
+    scope->slotNames = (Symbol *)(scope->slots + slotCount);
+    memset(scope->slotNames, 0, slotCount * sizeof(Symbol));
+  }
   return scope;
 }
 
+Scope *wsky_Scope_new(Scope *parent, Class *class, Object *self) {
+  return wsky_Scope_newWithSlots(parent, class, self, 0);
+}
+
 static bool isVisibleFromWhiskey(const Class *class) {
   return (class != wsky_Scope_CLASS && class != wsky_ProgramFile_CLASS);
 }
@@ -77,9 +91,12 @@ Scope *wsky_Scope_newRoot(Module *module) {
 static Result construct(Object *object,
                              unsigned paramCount,
                              const Value *params) {
-  (void) object;
   (void) paramCount;
   (void) params;
+  Scope *scope = (Scope *) object;
+  scope->slots = NULL;
+  scope->slotNames = NULL;
+  scope->slotCount = 0;
   RETURN_NULL;
 }
 
@@ -91,27 +108,32 @@ static void freeVariable(const char *name, void *valuePointer) {
 static Result destroy(Object *object) {
   Scope *scope = (Scope *) object;
 
-  wsky_Dict_apply(&scope->variables, &freeVariable);
-  wsky_Dict_free(&scope->variables);
+  wsky_Scope_delete(scope);
   RETURN_NULL;
 }
 
 void wsky_Scope_delete(wsky_Scope *scope) {
   wsky_Dict_apply(&scope->variables, &freeVariable);
   wsky_Dict_free(&scope->variables);
+  wsky_free(scope->slots);
+  scope->slots = NULL;
+  scope->slotNames = NULL;
+  scope->slotCount = 0;
 }
 
 
 
 static void visitVariable(const char *name, void *valuePointer) {
   (void) name;
-  Value value = *(Value *) valuePointer;
-  wsky_GC_visitValue(value);
+  wsky_GC_visitValue(*(Value *) valuePointer);
 }
 
 static void acceptGC(wsky_Object *object) {
   Scope *scope = (Scope *) object;
   wsky_Dict_apply(&scope->variables, &visitVariable);
+  for (unsigned i = 0; i < scope->slotCount; i++)
+    if (scope->slotNames[i])
+      wsky_GC_visitValue(scope->slots[i]);
   wsky_GC_visitObject(scope->parent);
   wsky_GC_visitObject(scope->module);
   wsky_GC_visitObject(scope->self);
@@ -125,12 +147,15 @@ static void printVariable(const char *name, void *value_) {
   Result rv = wsky_toString(value);
   if (rv.exception)
     abort();
-  wsky_String *string = (wsky_String *) rv.v.v.objectValue;
+  wsky_String *string = (wsky_String *) Value_toObject(rv.v);
   printf("%s = %s\n", name, string->string);
 }
 
 
 void wsky_Scope_print(const Scope *scope) {
+  for (unsigned i = 0; i < scope->slotCount; i++)
+    if (scope->slotNames[i])
+      printVariable(scope->slotNames[i], scope->slots + i);
   wsky_Dict_applyConst(&scope->variables, &printVariable);
   if (scope->parent) {
     printf("parent:\n");
@@ -142,36 +167,101 @@ void wsky_Scope_print(const Scope *scope) {
 void wsky_Scope_addVariable(Scope *scope, const char *name, Value value) {
   Value *valuePointer = wsky_safeMalloc(sizeof(Value));
   *valuePointer = value;
+  wsky_GC_writeBarrier(scope, value);
   wsky_Dict_set(&scope->variables, name, valuePointer);
 }
 
 
-bool wsky_Scope_setVariable(Scope *scope,
-                            const char *name, Value value) {
-  Value *valuePointer = (Value*) wsky_Dict_get(&scope->variables, name);
-  if (valuePointer) {
-    *valuePointer = value;
+void wsky_Scope_declareSlot(Scope *scope, unsigned slot,
+                            Symbol name, Value value) {
+  assert(slot < scope->slotCount);
+  scope->slots[slot] = value;
+  scope->slotNames[slot] = name;
+  wsky_GC_writeBarrier(scope, value);
+}
+
+bool wsky_Scope_isSlotDeclared(const Scope *scope, unsigned slot) {
+  assert(slot < scope->slotCount);
+  return scope->slotNames[slot] != NULL;
+}
+
+Value *wsky_Scope_getSlot(Scope *scope, unsigned depth, unsigned slot) {
+  while (depth--) {
+    scope = scope->parent;
+    if (!scope)
+      return NULL;
+  }
+  if (slot >= scope->slotCount || !scope->slotNames[slot])
+    return NULL;
+  return scope->slots + slot;
+}
+
+
+bool wsky_Scope_setSlot(Scope *scope, unsigned depth, unsigned slot,
+                        Value value) {
+  while (depth--) {
+    scope = scope->parent;
+    if (!scope)
+      return false;
+  }
+  if (slot >= scope->slotCount || !scope->slotNames[slot])
     return false;
+  scope->slots[slot] = value;
+  wsky_GC_writeBarrier(scope, value);
+  return true;
+}
+
+
+/* Returns a pointer to the variable or NULL */
+static Value *findLocalVariable(const Scope *scope, Symbol name) {
+  for (unsigned i = 0; i < scope->slotCount; i++)
+    if (scope->slotNames[i] == name)
+      return scope->slots + i;
+  return wsky_Dict_getSymbol(&scope->variables, name);
+}
+
+/*
+ * Returns a pointer to the variable or NULL.
+ * Sets `owner` to the scope of the variable if `owner` is not NULL.
+ */
+static Value *findVariable(const Scope *scope, Symbol name,
+                           const Scope **owner) {
+  while (scope) {
+    Value *valuePointer = findLocalVariable(scope, name);
+    if (valuePointer) {
+      if (owner)
+        *owner = scope;
+      return valuePointer;
+    }
+    scope = scope->parent;
   }
-  if (!scope->parent)
+  return NULL;
+}
+
+
+bool wsky_Scope_setVariable(Scope *scope,
+                            const char *name, Value value) {
+  Symbol symbol = wsky_Symbol_find(name);
+  const Scope *owner;
+  Value *valuePointer = symbol ? findVariable(scope, symbol, &owner) : NULL;
+  if (!valuePointer)
     return true;
-  return wsky_Scope_setVariable(scope->parent, name, value);
+  *valuePointer = value;
+  wsky_GC_writeBarrier((Scope *)owner, value);
+  return false;
 }
 
 
 bool wsky_Scope_containsVariable(const Scope *scope, const char *name) {
-  if (wsky_Dict_contains(&scope->variables, name)) {
-    return true;
-  }
-  if (!scope->parent)
-    return false;
-  return wsky_Scope_containsVariable(scope->parent, name);
+  Symbol symbol = wsky_Symbol_find(name);
+  return symbol && findVariable(scope, symbol, NULL);
 }
 
 
 bool wsky_Scope_containsVariableLocally(const Scope *scope,
                                         const char *name) {
-  return wsky_Dict_contains(&scope->variables, name);
+  Symbol symbol = wsky_Symbol_find(name);
+  return symbol && findLocalVariable(scope, symbol);
 }
 
 
@@ -189,13 +279,12 @@ wsky_Module *wsky_Scope_getModule(Scope *scope) {
 
 
 Value wsky_Scope_getVariable(Scope *scope, const char *name) {
-  Value *valuePointer = (Value*) wsky_Dict_get(&scope->variables, name);
-  if (valuePointer)
-    return *valuePointer;
-  if (!scope->parent) {
+  Symbol symbol = wsky_Symbol_find(name);
+  Value *valuePointer = symbol ? findVariable(scope, symbol, NULL) : NULL;
+  if (!valuePointer) {
     fprintf(stderr, "wsky_Scope_getVariable(): error\n");
     wsky_Scope_print(scope);
     abort();
   }
-  return wsky_Scope_getVariable(scope->parent, name);
+  return *valuePointer;
 }
@@ -3,7 +3,7 @@
 #include "../whiskey_private.h"
 
 
-#define CAST_TO_STRING(value) ((String *) (value).v.objectValue)
+#define CAST_TO_STRING(value) ((String *) Value_toObject(value))
 
 static Result construct(Object *object,
                              unsigned paramCount,
@@ -62,6 +62,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_String_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "String",
+  .objectSize = sizeof(String),
   .final = true,
   .constructor = &construct,
   .privateConstructor = true,
@@ -78,11 +79,80 @@ String *wsky_String_new(const char *cString) {
   Result r = wsky_Object_new(wsky_String_CLASS, 0, NULL);
   if (r.exception)
     return NULL;
-  String *string = (String *) r.v.v.objectValue;
+  String *string = (String *) Value_toObject(r.v);
   string->string = wsky_strdup(cString);
   return string;
 }
 
+/** The range of the integers whose strings are cached */
+#define SMALL_INT_MIN (-128)
+#define SMALL_INT_MAX 1024
+
+static String *smallIntStrings[SMALL_INT_MAX - SMALL_INT_MIN];
+
+static String *trueString = NULL;
+static String *falseString = NULL;
+static String *nullString = NULL;
+static String *emptyString = NULL;
+
+
+/** Returns the string of a cache slot, which is created the first time */
+static String *getCachedString(String **slot, const char *cString) {
+  if (!*slot)
+    *slot = wsky_String_new(cString);
+  return *slot;
+}
+
+String *wsky_String_getEmpty(void) {
+  return getCachedString(&emptyString, "");
+}
+
+String *wsky_String_getCached(Value value) {
+  switch (Value_getType(value)) {
+  case Type_BOOL:
+    if (Value_toBool(value))
+      return getCachedString(&trueString, "true");
+    return getCachedString(&falseString, "false");
+
+  case Type_INT: {
+    wsky_int n = Value_toInt(value);
+    if (n < SMALL_INT_MIN || n >= SMALL_INT_MAX)
+      return NULL;
+    String **slot = smallIntStrings + (n - SMALL_INT_MIN);
+    if (*slot)
+      return *slot;
+    char buffer[wsky_FORMAT_BUFFER_SIZE];
+    wsky_formatInt(n, buffer);
+    return getCachedString(slot, buffer);
+  }
+
+  case Type_OBJECT:
+    if (Value_toObject(value))
+      return NULL;
+    return getCachedString(&nullString, "null");
+
+  default:
+    return NULL;
+  }
+}
+
+void wsky_String_visitCache(void) {
+  for (size_t i = 0; i < SMALL_INT_MAX - SMALL_INT_MIN; i++)
+    wsky_GC_visitObject(smallIntStrings[i]);
+  wsky_GC_visitObject(trueString);
+  wsky_GC_visitObject(falseString);
+  wsky_GC_visitObject(nullString);
+  wsky_GC_visitObject(emptyString);
+}
+
+void wsky_String_clearCache(void) {
+  memset(smallIntStrings, 0, sizeof smallIntStrings);
+  trueString = NULL;
+  falseString = NULL;
+  nullString = NULL;
+  emptyString = NULL;
+}
+
 static Result construct(Object *object,
                              unsigned paramCount,
                              const Value *params) {
@@ -171,44 +241,36 @@ void wsky_String_print(const String *self) {
 
 
 
-static void escapeChar(char *dest, char source) {
-  /* TODO: Improve a lot, it’s crappy */
-
+/** Writes a character, escaped, and returns the end of the string */
+static char *escapeChar(char *dest, char source) {
+  char escaped;
   switch (source) {
-  case '\n':
-    strcat(dest, "\\n");
-    return;
-  case '\r':
-    strcat(dest, "\\r");
-    return;
-  case '\t':
-    strcat(dest, "\\t");
-    return;
-  case '\0':
-    strcat(dest, "\\0");
-    return;
-  case '\'':
-    strcat(dest, "\\'");
-    return;
-  case '\"':
-    strcat(dest, "\\\"");
-    return;
+  case '\n': escaped = 'n'; break;
+  case '\r': escaped = 'r'; break;
+  case '\t': escaped = 't'; break;
+  case '\0': escaped = '0'; break;
+  case '\'': escaped = '\''; break;
+  case '\"': escaped = '"'; break;
+  default:
+    *dest = source;
+    return dest + 1;
   }
-
-  size_t length = strlen(dest);
-  dest[length] = source;
-  dest[length + 1] = '\0';
+  dest[0] = '\\';
+  dest[1] = escaped;
+  return dest + 2;
 }
 
 char *wsky_String_escapeCString(const char *source) {
   size_t max_length = strlen(source) * 2 + 2;
   char *s = wsky_safeMalloc(max_length + 1);
-  strcpy(s, "'");
+  char *end = s;
+  *end++ = '\'';
   while (*source) {
-    escapeChar(s, *source);
+    end = escapeChar(end, *source);
     source++;
   }
-  strcat(s, "'");
+  *end++ = '\'';
+  *end = '\0';
   return s;
 }
 
@@ -217,7 +279,7 @@ static String *concat(const char *left, size_t leftLength,
                       const char *right, size_t rightLength) {
 
   Result r = wsky_Object_new(wsky_String_CLASS, 0, NULL);
-  String *string = (String *) r.v.v.objectValue;
+  String *string = (String *) Value_toObject(r.v);
   size_t newLength = leftLength + rightLength;
   string->string = wsky_malloc(newLength + 1);
   if (!string->string) {
@@ -233,7 +295,7 @@ static String *multiply(const char *source, size_t sourceLength,
                         unsigned count) {
 
   Result r = wsky_Object_new(wsky_String_CLASS, 0, NULL);
-  String *string = (String *) r.v.v.objectValue;
+  String *string = (String *) Value_toObject(r.v);
   size_t newLength = sourceLength * count;
   string->string = wsky_malloc(newLength + 1);
   if (!string->string) {
@@ -263,55 +325,70 @@ static inline char *castToCString(Value v) {
   // thrown.
   // Rewrite this function.
   assert(wsky_isString(v));
-  String *s = (String *) v.v.objectValue;
+  String *s = (String *) Value_toObject(v);
   return wsky_strdup(s->string);
 }
 
 static Result operatorEquals(String *self, Value *value) {
   if (!wsky_isString(*value))
     RAISE_NOT_IMPL;
-  String *other = (String *)value->v.objectValue;
+  String *other = (String *)Value_toObject(*value);
   RETURN_BOOL(strcmp(self->string, other->string) == 0);
 }
 
 static Result operatorNotEquals(String *self, Value *value) {
   if (!wsky_isString(*value))
     RAISE_NOT_IMPL;
-  String *other = (String *)value->v.objectValue;
+  String *other = (String *)Value_toObject(*value);
   RETURN_BOOL(strcmp(self->string, other->string) != 0);
 }
 
-static Result operatorPlus(String *self, Value *value) {
-  Result rv = wsky_toString(*value);
-  if (rv.exception)
-    return rv;
-  char *right = castToCString(rv.v);
-
-  String *new = concat(self->string, strlen(self->string),
-                       right, strlen(right));
-  wsky_free(right);
+/**
+ * Concatenates a string and the string of a value. The primitive values
+ * are formatted without allocation.
+ */
+static Result concatValue(String *self, Value value, bool valueOnRight) {
+  char buffer[wsky_FORMAT_BUFFER_SIZE];
+  char *copy = NULL;
+  const char *other = buffer;
+  size_t otherLength;
+
+  if (Value_getType(value) != Type_OBJECT) {
+    otherLength = wsky_formatPrimitive(value, buffer);
+  } else {
+    Result rv = wsky_toString(value);
+    if (rv.exception)
+      return rv;
+    copy = castToCString(rv.v);
+    other = copy;
+    otherLength = strlen(copy);
+  }
+
+  size_t selfLength = strlen(self->string);
+  String *new;
+  if (valueOnRight)
+    new = concat(self->string, selfLength, other, otherLength);
+  else
+    new = concat(other, otherLength, self->string, selfLength);
+  wsky_free(copy);
   RETURN_OBJECT((Object *)new);
 }
 
+static Result operatorPlus(String *self, Value *value) {
+  return concatValue(self, *value, true);
+}
+
 
 static Result operatorRPlus(String *self, Value *value) {
-  Result rv = wsky_toString(*value);
-  if (rv.exception)
-    return rv;
-  char *right = castToCString(rv.v);
-
-  String *new = concat(right, strlen(right),
-                       self->string, strlen(self->string));
-  wsky_free(right);
-  RETURN_OBJECT((Object *)new);
+  return concatValue(self, *value, false);
 }
 
 
 static Result operatorStar(String *self, Value *value) {
-  if (value->type != Type_INT) {
+  if (Value_getType(*value) != Type_INT) {
     RAISE_NOT_IMPL;
   }
-  wsky_int count = value->v.intValue;
+  wsky_int count = Value_toInt(*value);
   if (count < 0) {
     ValueError *e = wsky_ValueError_new("The factor cannot be negative");
     RAISE_EXCEPTION((Exception *)e);
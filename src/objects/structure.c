@@ -26,6 +26,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_Structure_CLASS_DEF = {
   .super = &wsky_Object_CLASS_DEF,
   .name = "Structure",
+  .objectSize = sizeof(Structure),
   .final = true,
   .constructor = &construct,
   .privateConstructor = false,
@@ -82,6 +83,7 @@ Result wsky_Structure_set(Structure *self,
                                Value value) {
   Value *newValue = wsky_safeMalloc(sizeof(Value));
   *newValue = value;
+  wsky_GC_writeBarrier(self, value);
   wsky_Dict_set(&self->members, name, newValue);
   RETURN_VALUE(value);
 }
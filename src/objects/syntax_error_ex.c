@@ -16,6 +16,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_SyntaxErrorEx_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "SyntaxError",
+  .objectSize = sizeof(SyntaxErrorEx),
   .final = true,
   .constructor = &construct,
   .privateConstructor = true,
@@ -34,7 +35,7 @@ SyntaxErrorEx *wsky_SyntaxErrorEx_new(const SyntaxError *syntaxError) {
   if (r.exception)
     abort();
 
-  SyntaxErrorEx *self = (SyntaxErrorEx *) r.v.v.objectValue;
+  SyntaxErrorEx *self = (SyntaxErrorEx *) Value_toObject(r.v);
   wsky_SyntaxError_copy(&self->syntaxError, syntaxError);
   return self;
 }
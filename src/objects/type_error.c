@@ -15,6 +15,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_TypeError_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "TypeError",
+  .objectSize = sizeof(TypeError),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -33,7 +34,7 @@ TypeError *wsky_TypeError_new(const char *message) {
   r = wsky_Object_new(wsky_TypeError_CLASS, 1, &v);
   if (r.exception)
     abort();
-  return (TypeError *) r.v.v.objectValue;
+  return (TypeError *) Value_toObject(r.v);
 }
 
 
@@ -15,6 +15,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_ValueError_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "ValueError",
+  .objectSize = sizeof(ValueError),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -33,7 +34,7 @@ ValueError *wsky_ValueError_new(const char *message) {
   r = wsky_Object_new(wsky_ValueError_CLASS, 1, &v);
   if (r.exception)
     abort();
-  return (ValueError *) r.v.v.objectValue;
+  return (ValueError *) Value_toObject(r.v);
 }
 
 
@@ -17,6 +17,7 @@ static MethodDef methods[] = {
 const ClassDef wsky_ZeroDivisionError_CLASS_DEF = {
   .super = &wsky_Exception_CLASS_DEF,
   .name = "ZeroDivisionError",
+  .objectSize = sizeof(ZeroDivisionError),
   .final = false,
   .constructor = &construct,
   .privateConstructor = false,
@@ -35,7 +36,7 @@ ZeroDivisionError *wsky_ZeroDivisionError_new(void) {
   r = wsky_Object_new(wsky_ZeroDivisionError_CLASS, 1, &v);
   if (r.exception)
     abort();
-  return (ZeroDivisionError *) r.v.v.objectValue;
+  return (ZeroDivisionError *) Value_toObject(r.v);
 }
 
 
@@ -65,6 +65,8 @@ static inline ParserResult createUnexpectedEofError() {
 
 
 static inline ParserResult createUnexpectedTokenError(const Token *t) {
+  if (t->type == wsky_TokenType_HTML)
+    return createErrorImpl("Unexpected HTML", t->begin, false);
   char *message = wsky_asprintf("Unexpected '%s'", t->string);
   ParserResult r = createErrorImpl(message, t->begin, false);
   wsky_free(message);
@@ -112,6 +114,65 @@ static ParserResult parseHtml(TokenList **listPointer) {
   return createNodeResult(node);
 }
 
+static void setEOFErrorPosition(ParserResult *result, TokenList *begin);
+
+/* Returns a template print node (`<%= expression %>`) or NULL */
+static ParserResult parseTemplatePrint(TokenList **listPointer) {
+  if (!*listPointer) {
+    return ParserResult_NULL;
+  }
+
+  Token *token = &(*listPointer)->token;
+  if (token->type != wsky_TokenType_WSKY_PRINT) {
+    return ParserResult_NULL;
+  }
+
+  TokenList *children = token->v.children;
+  if (!children)
+    return createError("Expected an expression", token->begin, NULL);
+
+  ParserResult pr = parseExpr(&children);
+  setEOFErrorPosition(&pr, token->v.children);
+  if (!pr.success)
+    return pr;
+  if (children) {
+    wsky_ASTNode_delete(pr.node);
+    return createUnexpectedTokenError(&children->token);
+  }
+
+  Node *node = (Node *) wsky_TpltPrintNode_new(token, pr.node);
+  *listPointer = (*listPointer)->next;
+  return createNodeResult(node);
+}
+
+/*
+ * In a template, the HTML and the printed expressions need no
+ * semicolon before or after them.
+ */
+static bool isTemplateItem(const Node *node, const TokenList *next) {
+  if (node->type == wsky_ASTNodeType_HTML ||
+      node->type == wsky_ASTNodeType_TPLT_PRINT)
+    return true;
+  return next && (next->token.type == wsky_TokenType_HTML ||
+                  next->token.type == wsky_TokenType_WSKY_PRINT);
+}
+
+/*
+ * Adds a node to the nodes of a sequence. An HTML node which follows
+ * another one is merged into it, so that the static parts of a template
+ * are written at once.
+ */
+static void addSequenceNode(NodeList **nodesPointer, Node *node) {
+  Node *last = wsky_ASTNodeList_getLastNode(*nodesPointer);
+  if (last && last->type == wsky_ASTNodeType_HTML &&
+      node->type == wsky_ASTNodeType_HTML) {
+    wsky_HtmlNode_append((HtmlNode *)last, (const HtmlNode *)node);
+    wsky_ASTNode_delete(node);
+    return;
+  }
+  wsky_ASTNodeList_addNode(nodesPointer, node);
+}
+
 
 static Token *tryToReadIdentifier(TokenList **listPointer) {
   if (!*listPointer)
@@ -258,8 +319,11 @@ static ParserResult parseSequenceImpl(TokenList **listPointer,
       wsky_ASTNodeList_delete(nodes);
       return r;
     }
-    wsky_ASTNodeList_addNode(&nodes, r.node);
+    bool templateItem = isTemplateItem(r.node, *listPointer);
+    addSequenceNode(&nodes, r.node);
     separated = tryToReadOperator(listPointer, separatorOperator);
+    if (!separated && separatorOperator == OP(SEMICOLON))
+      separated = templateItem;
   }
 
   wsky_ASTNodeList_delete(nodes);
@@ -355,11 +419,9 @@ static ParserResult parseTerm(TokenList **listPointer) {
   if (result.node)
     return result;
 
-  /*
-    result = parseTemplatePrint(listPointer);
-    if (result.node)
+  result = parseTemplatePrint(listPointer);
+  if (!result.success || result.node)
     return result;
-  */
 
   result = parseSequence(listPointer);
   if (!result.success || result.node)
@@ -1062,12 +1124,13 @@ static ParserResult parseProgram(TokenList **listPointer) {
       wsky_ASTNodeList_delete(nodes);
       return pr;
     }
-    wsky_ASTNodeList_addNode(&nodes, pr.node);
+    bool templateItem = isTemplateItem(pr.node, *listPointer);
+    addSequenceNode(&nodes, pr.node);
 
     if (!*listPointer)
       break;
     Token *semi = tryToReadOperator(listPointer, OP(SEMICOLON));
-    if (!semi) {
+    if (!semi && !templateItem) {
       wsky_ASTNodeList_delete(nodes);
       return createUnexpectedTokenError(&(*listPointer)->token);
     }
@@ -1127,15 +1190,21 @@ ParserResult wsky_parseFile(ProgramFile *file) {
   return parseFromLexerResult(wsky_lexFromFile(file));
 }
 
-ParserResult wsky_parseTemplateString(const char *string) {
-  LexerResult lr = wsky_lexTemplateFromString(string);
+static ParserResult parseTemplateFromLexerResult(LexerResult lr) {
   if (!lr.success)
     return createResultFromError(lr.syntaxError);
 
+  wsky_TokenList_deleteComments(&lr.tokens);
+
   ParserResult pr = wsky_parseTemplate(lr.tokens);
   wsky_TokenList_delete(lr.tokens);
-  if (!pr.success)
-    return pr;
-
   return pr;
 }
+
+ParserResult wsky_parseTemplateString(const char *string) {
+  return parseTemplateFromLexerResult(wsky_lexTemplateFromString(string));
+}
+
+ParserResult wsky_parseTemplateFile(ProgramFile *file) {
+  return parseTemplateFromLexerResult(wsky_lexTemplateFromFile(file));
+}
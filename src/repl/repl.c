@@ -203,6 +203,7 @@ static int evalNode(wsky_ASTNode *node, Scope *scope) {
 
   assert(node->type == wsky_ASTNodeType_SEQUENCE);
 
+  wsky_resolveSequence((wsky_SequenceNode *)node);
   Result rv = wsky_evalSequence((wsky_SequenceNode *)node, scope);
   wsky_ASTNode_delete(node);
   if (rv.exception) {
@@ -216,7 +217,7 @@ static int evalNode(wsky_ASTNode *node, Scope *scope) {
     return 2;
   }
 
-  wsky_String *string = (wsky_String *) rv.v.v.objectValue;
+  wsky_String *string = (wsky_String *) wsky_Value_toObject(rv.v);
   printf("%s\n", string->string);
   return 0;
 }
@@ -0,0 +1,383 @@
+#include <assert.h>
+#include <string.h>
+#include "whiskey_private.h"
+
+
+/** The scope of a node at runtime, as seen by the resolver */
+typedef struct ResolverScope_s {
+  struct ResolverScope_s *parent;
+
+  /** `true` if the variables are declared by name (the root scope) */
+  bool dynamic;
+
+  /** `true` if this is the scope of a function call */
+  bool function;
+
+  /**
+   * All the variables declared in this scope, in order, including the
+   * ones which are not declared yet
+   */
+  Symbol *names;
+
+  /** `true` if the variable of the same index has been declared */
+  bool *declared;
+
+  unsigned count;
+  unsigned capacity;
+} ResolverScope;
+
+
+static void initScope(ResolverScope *scope, ResolverScope *parent,
+                      bool dynamic, bool function) {
+  scope->parent = parent;
+  scope->dynamic = dynamic;
+  scope->function = function;
+  scope->names = NULL;
+  scope->declared = NULL;
+  scope->count = 0;
+  scope->capacity = 0;
+}
+
+static void freeScope(ResolverScope *scope) {
+  wsky_free(scope->names);
+  wsky_free(scope->declared);
+}
+
+static int indexOf(const ResolverScope *scope, Symbol name) {
+  for (unsigned i = 0; i < scope->count; i++)
+    if (scope->names[i] == name)
+      return (int)i;
+  return -1;
+}
+
+static void addName(ResolverScope *scope, Symbol name) {
+  if (scope->dynamic || indexOf(scope, name) != -1)
+    return;
+
+  if (scope->count == scope->capacity) {
+    scope->capacity = scope->capacity ? scope->capacity * 2 : 8;
+    scope->names = wsky_realloc(scope->names,
+                                scope->capacity * sizeof(Symbol));
+    scope->declared = wsky_realloc(scope->declared,
+                                   scope->capacity * sizeof(bool));
+    if (!scope->names || !scope->declared)
+      abort();
+  }
+  scope->names[scope->count] = name;
+  scope->declared[scope->count] = false;
+  scope->count++;
+}
+
+/** Returns the slot of the variable or -1 if it is declared by name */
+static int declare(ResolverScope *scope, Symbol name) {
+  if (scope->dynamic)
+    return -1;
+  int slot = indexOf(scope, name);
+  assert(slot != -1);
+  scope->declared[slot] = true;
+  return slot;
+}
+
+
+
+/*
+ * Collects the variables declared by a node in the current scope, without
+ * looking into the nodes which create a new scope.
+ */
+
+static void collect(const Node *node, ResolverScope *scope);
+
+static void collectList(const NodeList *list, ResolverScope *scope) {
+  for (; list; list = list->next)
+    collect(list->node, scope);
+}
+
+static void collect(const Node *node, ResolverScope *scope) {
+  if (!node)
+    return;
+
+  switch (node->type) {
+  case wsky_ASTNodeType_TPLT_PRINT:
+    collect(((const TpltPrintNode *)node)->child, scope);
+    break;
+
+  case wsky_ASTNodeType_UNARY_OPERATOR:
+  case wsky_ASTNodeType_BINARY_OPERATOR: {
+    const OperatorNode *n = (const OperatorNode *)node;
+    collect(n->left, scope);
+    collect(n->right, scope);
+    break;
+  }
+
+  case wsky_ASTNodeType_VAR: {
+    const VarNode *n = (const VarNode *)node;
+    collect(n->right, scope);
+    addName(scope, n->name);
+    break;
+  }
+
+  case wsky_ASTNodeType_ASSIGNMENT: {
+    const AssignmentNode *n = (const AssignmentNode *)node;
+    collect(n->right, scope);
+    collect(n->left, scope);
+    break;
+  }
+
+  case wsky_ASTNodeType_CALL: {
+    const CallNode *n = (const CallNode *)node;
+    collect(n->left, scope);
+    collectList(n->children, scope);
+    break;
+  }
+
+  case wsky_ASTNodeType_MEMBER_ACCESS:
+    collect(((const MemberAccessNode *)node)->left, scope);
+    break;
+
+  case wsky_ASTNodeType_CLASS: {
+    const ClassNode *n = (const ClassNode *)node;
+    collect(n->superclass, scope);
+    addName(scope, n->name);
+    break;
+  }
+
+  case wsky_ASTNodeType_IMPORT:
+    addName(scope, wsky_Symbol_intern(((const ImportNode *)node)->name));
+    break;
+
+  case wsky_ASTNodeType_EXPORT: {
+    const ExportNode *n = (const ExportNode *)node;
+    if (n->right) {
+      collect(n->right, scope);
+      addName(scope, n->name);
+    }
+    break;
+  }
+
+  case wsky_ASTNodeType_IF: {
+    const IfNode *n = (const IfNode *)node;
+    collectList(n->tests, scope);
+    collectList(n->expressions, scope);
+    collect(n->elseNode, scope);
+    break;
+  }
+
+  case wsky_ASTNodeType_TRY: {
+    const TryNode *n = (const TryNode *)node;
+    collect(n->try, scope);
+    for (size_t i = 0; i < n->exceptCount; i++)
+      collectList(n->excepts[i].classes, scope);
+    collect(n->elseNode, scope);
+    collect(n->finally, scope);
+    break;
+  }
+
+  default:
+    break;
+  }
+}
+
+
+
+/*
+ * Resolves the identifiers and assigns the slots.
+ */
+
+static void resolve(Node *node, ResolverScope *scope);
+
+static void resolveList(NodeList *list, ResolverScope *scope) {
+  for (; list; list = list->next)
+    resolve(list->node, scope);
+}
+
+/* Resolves the children of a node which creates a new scope */
+static unsigned resolveScope(NodeList *children, ResolverScope *scope) {
+  collectList(children, scope);
+  resolveList(children, scope);
+  return scope->count;
+}
+
+static void resolveIdentifier(IdentifierNode *node,
+                              const ResolverScope *scope) {
+  node->depth = -1;
+
+  bool crossedFunction = false;
+  for (int depth = 0; scope; scope = scope->parent, depth++) {
+    if (scope->dynamic)
+      return;
+
+    int slot = indexOf(scope, node->name);
+    if (slot != -1) {
+      if (scope->declared[slot]) {
+        node->depth = depth;
+        node->slot = (unsigned)slot;
+        return;
+      }
+
+      /* The function may be called after the declaration */
+      if (crossedFunction)
+        return;
+    }
+
+    if (scope->function)
+      crossedFunction = true;
+  }
+}
+
+static void resolveFunction(FunctionNode *node, ResolverScope *parent) {
+  ResolverScope scope;
+  initScope(&scope, parent, false, true);
+
+  for (NodeList *param = node->parameters; param; param = param->next) {
+    IdentifierNode *identifier = (IdentifierNode *)param->node;
+    addName(&scope, identifier->name);
+    identifier->depth = 0;
+    identifier->slot = (unsigned)declare(&scope, identifier->name);
+  }
+
+  node->slotCount = resolveScope(node->children, &scope);
+  freeScope(&scope);
+}
+
+static void resolveExcept(ExceptNode *node, ResolverScope *parent) {
+  ResolverScope scope;
+  initScope(&scope, parent, false, false);
+
+  if (node->variable) {
+    addName(&scope, node->variable);
+    node->slot = declare(&scope, node->variable);
+  }
+
+  collect(node->expression, &scope);
+  resolve(node->expression, &scope);
+  node->slotCount = scope.count;
+  freeScope(&scope);
+}
+
+static void resolve(Node *node, ResolverScope *scope) {
+  if (!node)
+    return;
+
+  switch (node->type) {
+  case wsky_ASTNodeType_IDENTIFIER:
+    resolveIdentifier((IdentifierNode *)node, scope);
+    break;
+
+  case wsky_ASTNodeType_TPLT_PRINT:
+    resolve(((TpltPrintNode *)node)->child, scope);
+    break;
+
+  case wsky_ASTNodeType_UNARY_OPERATOR:
+  case wsky_ASTNodeType_BINARY_OPERATOR: {
+    OperatorNode *n = (OperatorNode *)node;
+    resolve(n->left, scope);
+    resolve(n->right, scope);
+    break;
+  }
+
+  case wsky_ASTNodeType_SEQUENCE: {
+    SequenceNode *n = (SequenceNode *)node;
+    ResolverScope inner;
+    initScope(&inner, scope, false, false);
+    n->slotCount = resolveScope(n->children, &inner);
+    freeScope(&inner);
+    break;
+  }
+
+  case wsky_ASTNodeType_FUNCTION:
+    resolveFunction((FunctionNode *)node, scope);
+    break;
+
+  case wsky_ASTNodeType_VAR: {
+    VarNode *n = (VarNode *)node;
+    resolve(n->right, scope);
+    n->slot = declare(scope, n->name);
+    break;
+  }
+
+  case wsky_ASTNodeType_ASSIGNMENT: {
+    AssignmentNode *n = (AssignmentNode *)node;
+    resolve(n->right, scope);
+    resolve(n->left, scope);
+    break;
+  }
+
+  case wsky_ASTNodeType_CALL: {
+    CallNode *n = (CallNode *)node;
+    resolve(n->left, scope);
+    resolveList(n->children, scope);
+    break;
+  }
+
+  case wsky_ASTNodeType_MEMBER_ACCESS:
+    resolve(((MemberAccessNode *)node)->left, scope);
+    break;
+
+  case wsky_ASTNodeType_CLASS: {
+    ClassNode *n = (ClassNode *)node;
+    resolve(n->superclass, scope);
+    for (NodeList *list = n->children; list; list = list->next)
+      resolve(((ClassMemberNode *)list->node)->right, scope);
+    n->slot = declare(scope, n->name);
+    break;
+  }
+
+  case wsky_ASTNodeType_IMPORT: {
+    ImportNode *n = (ImportNode *)node;
+    n->slot = declare(scope, wsky_Symbol_intern(n->name));
+    break;
+  }
+
+  case wsky_ASTNodeType_EXPORT: {
+    ExportNode *n = (ExportNode *)node;
+    if (n->right) {
+      resolve(n->right, scope);
+      n->slot = declare(scope, n->name);
+    }
+    break;
+  }
+
+  case wsky_ASTNodeType_IF: {
+    IfNode *n = (IfNode *)node;
+    NodeList *tests = n->tests;
+    NodeList *expressions = n->expressions;
+    while (tests) {
+      resolve(tests->node, scope);
+      resolve(expressions->node, scope);
+      tests = tests->next;
+      expressions = expressions->next;
+    }
+    resolve(n->elseNode, scope);
+    break;
+  }
+
+  case wsky_ASTNodeType_TRY: {
+    TryNode *n = (TryNode *)node;
+    resolve(n->try, scope);
+    for (size_t i = 0; i < n->exceptCount; i++) {
+      resolveList(n->excepts[i].classes, scope);
+      resolveExcept(n->excepts + i, scope);
+    }
+    resolve(n->elseNode, scope);
+    resolve(n->finally, scope);
+    break;
+  }
+
+  default:
+    break;
+  }
+}
+
+
+
+void wsky_resolveNode(Node *node) {
+  ResolverScope root;
+  initScope(&root, NULL, true, false);
+  resolve(node, &root);
+}
+
+void wsky_resolveSequence(SequenceNode *node) {
+  ResolverScope root;
+  initScope(&root, NULL, true, false);
+  resolveList(node->children, &root);
+}
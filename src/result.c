@@ -2,42 +2,22 @@
 
 
 const Result Result_TRUE = {
-  .v = {
-    .type = Type_BOOL,
-    .v = {
-      .boolValue = true
-    }
-  },
+  .v = Value_BOOL_INITIALIZER(true),
   .exception = NULL
 };
 
 const Result Result_FALSE = {
-  .v = {
-    .type = Type_BOOL,
-    .v = {
-      .boolValue = false
-    }
-  },
+  .v = Value_BOOL_INITIALIZER(false),
   .exception = NULL
 };
 
 const Result Result_NULL = {
-  .v = {
-    .type = Type_OBJECT,
-    .v = {
-      .objectValue = NULL
-    }
-  },
+  .v = Value_NULL_INITIALIZER,
   .exception = NULL
 };
 
 const Result Result_ZERO = {
-  .v = {
-    .type = Type_INT,
-    .v = {
-      .intValue = 0
-    }
-  },
+  .v = Value_INT_INITIALIZER(0),
   .exception = NULL
 };
 
@@ -0,0 +1,61 @@
+#include <assert.h>
+#include "whiskey_private.h"
+
+
+/** The last identifier given to a shape */
+static unsigned lastId = 0;
+
+
+static Shape *newShape(const Shape *parent,
+                       const Class *class, Symbol name) {
+  Shape *shape = wsky_safeMalloc(sizeof(Shape));
+  shape->parent = parent;
+  shape->class = class;
+  shape->name = name;
+  shape->fieldCount = parent ? parent->fieldCount + 1 : 0;
+  shape->id = ++lastId;
+  shape->children = NULL;
+  shape->next = NULL;
+  return shape;
+}
+
+Shape *wsky_Shape_newRoot(void) {
+  return newShape(NULL, NULL, NULL);
+}
+
+void wsky_Shape_delete(Shape *root) {
+  Shape *child = root->children;
+  while (child) {
+    Shape *next = child->next;
+    wsky_Shape_delete(child);
+    child = next;
+  }
+  wsky_free(root);
+}
+
+int wsky_Shape_getIndex(const Shape *shape, const Class *class,
+                        Symbol name) {
+  while (shape->parent) {
+    if (shape->name == name && shape->class == class)
+      return (int)shape->fieldCount - 1;
+    shape = shape->parent;
+  }
+  return -1;
+}
+
+const Shape *wsky_Shape_addField(const Shape *shape_,
+                                 const Class *class, Symbol name) {
+  assert(wsky_Shape_getIndex(shape_, class, name) == -1);
+
+  /* Only the transitions of a shape change */
+  Shape *shape = (Shape *)shape_;
+  for (Shape *child = shape->children; child; child = child->next) {
+    if (child->name == name && child->class == class)
+      return child;
+  }
+
+  Shape *child = newShape(shape, class, name);
+  child->next = shape->children;
+  shape->children = child;
+  return child;
+}
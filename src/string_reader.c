@@ -14,9 +14,14 @@ StringReader wsky_StringReader_create(ProgramFile *file,
     .column = 0,
     .file = file,
   };
+  /* The content of a file is not measured again */
+  size_t length = (file->source && string == file->content ?
+                   file->source->length : strlen(string));
+
   StringReader reader = {
     .file = file,
     .string = string,
+    .length = length,
     .position = pos,
   };
   return reader;
@@ -34,7 +39,7 @@ void wsky_StringReader_free(StringReader *reader) {
 
 
 bool wsky_StringReader_hasMore(const StringReader *reader) {
-  return reader->position.index < (int)strlen(reader->string);
+  return (size_t)reader->position.index < reader->length;
 }
 
 char wsky_StringReader_next(StringReader *reader) {
@@ -0,0 +1,154 @@
+#include <stdbool.h>
+#include <string.h>
+#include "whiskey_private.h"
+
+
+typedef struct {
+  uint32_t hash;
+  uint32_t length;
+  char string[];
+} SymbolHeader;
+
+
+/** The open-addressing table of the symbols */
+static SymbolHeader **table = NULL;
+static size_t tableCapacity = 0;
+static size_t symbolCount = 0;
+
+/**
+ * A direct-mapped cache of the symbols recently found, keyed by address.
+ *
+ * An address in this cache is always the address of a live symbol, so
+ * finding a string which is already a symbol does not need to hash it.
+ */
+#define CACHE_SIZE 256
+static const char *cache[CACHE_SIZE];
+
+
+static inline SymbolHeader *getHeader(Symbol symbol) {
+  return (SymbolHeader *)(symbol - offsetof(SymbolHeader, string));
+}
+
+static inline size_t getCacheIndex(const char *string) {
+  return ((uintptr_t)string >> 4) & (CACHE_SIZE - 1);
+}
+
+
+/* FNV-1a */
+static uint32_t hashString(const char *string, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char)string[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+
+/* Returns the slot of the symbol or the empty slot where it should be */
+static SymbolHeader **findSlot(const char *string, size_t length,
+                               uint32_t hash) {
+  size_t mask = tableCapacity - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    SymbolHeader *header = table[i];
+    if (!header)
+      return table + i;
+    if (header->string == string)
+      return table + i;
+    if (header->hash == hash && header->length == length &&
+        memcmp(header->string, string, length) == 0)
+      return table + i;
+  }
+}
+
+static void grow(void) {
+  size_t oldCapacity = tableCapacity;
+  SymbolHeader **oldTable = table;
+
+  tableCapacity = oldCapacity ? oldCapacity * 2 : 256;
+  table = wsky_safeMalloc(tableCapacity * sizeof(SymbolHeader *));
+  memset(table, 0, tableCapacity * sizeof(SymbolHeader *));
+
+  size_t mask = tableCapacity - 1;
+  for (size_t i = 0; i < oldCapacity; i++) {
+    SymbolHeader *header = oldTable[i];
+    if (!header)
+      continue;
+    size_t slot = header->hash & mask;
+    while (table[slot])
+      slot = (slot + 1) & mask;
+    table[slot] = header;
+  }
+  wsky_free(oldTable);
+}
+
+
+Symbol wsky_Symbol_internLength(const char *string, size_t length) {
+  if ((symbolCount + 1) * 2 > tableCapacity)
+    grow();
+
+  uint32_t hash = hashString(string, length);
+  SymbolHeader **slot = findSlot(string, length, hash);
+  if (*slot)
+    return (*slot)->string;
+
+  SymbolHeader *header = wsky_safeMalloc(sizeof(SymbolHeader) + length + 1);
+  header->hash = hash;
+  header->length = (uint32_t)length;
+  memcpy(header->string, string, length);
+  header->string[length] = '\0';
+  *slot = header;
+  symbolCount++;
+  return header->string;
+}
+
+Symbol wsky_Symbol_intern(const char *string) {
+  const char *cached = cache[getCacheIndex(string)];
+  if (cached == string)
+    return cached;
+
+  Symbol symbol = wsky_Symbol_internLength(string, strlen(string));
+  cache[getCacheIndex(symbol)] = symbol;
+  return symbol;
+}
+
+Symbol wsky_Symbol_find(const char *string) {
+  const char *cached = cache[getCacheIndex(string)];
+  if (cached == string)
+    return cached;
+
+  if (!table)
+    return NULL;
+
+  size_t length = strlen(string);
+  SymbolHeader *header = *findSlot(string, length,
+                                   hashString(string, length));
+  if (!header)
+    return NULL;
+  cache[getCacheIndex(header->string)] = header->string;
+  return header->string;
+}
+
+
+uint32_t wsky_Symbol_getHash(Symbol symbol) {
+  return getHeader(symbol)->hash;
+}
+
+size_t wsky_Symbol_getLength(Symbol symbol) {
+  return getHeader(symbol)->length;
+}
+
+size_t wsky_Symbol_getCount(void) {
+  return symbolCount;
+}
+
+
+void wsky_Symbol_freeAll(void) {
+  for (size_t i = 0; i < tableCapacity; i++)
+    wsky_free(table[i]);
+  wsky_free(table);
+  table = NULL;
+  tableCapacity = 0;
+  symbolCount = 0;
+  memset(cache, 0, sizeof(cache));
+}
@@ -0,0 +1,329 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+#include "whiskey_private.h"
+
+
+/** The top of the stack of the current outputs */
+static TemplateOutput *currentOutput = NULL;
+
+/**
+ * The static pieces shorter than this are copied by the vectored
+ * outputs, because a slice costs more than a few bytes
+ */
+static const size_t MIN_STATIC_SLICE_LENGTH = 64;
+
+
+void wsky_TemplateOutput_initBuffer(TemplateOutput *output) {
+  output->buffer = NULL;
+  output->length = 0;
+  output->capacity = 0;
+  output->writer = NULL;
+  output->vectorWriter = NULL;
+  output->writerData = NULL;
+  output->slices = NULL;
+  output->sliceCount = 0;
+  output->sources = NULL;
+  output->sourceCount = 0;
+  output->failed = false;
+  output->previous = NULL;
+}
+
+void wsky_TemplateOutput_initStream(TemplateOutput *output,
+                                    wsky_TemplateWriter writer,
+                                    void *writerData) {
+  wsky_TemplateOutput_initBuffer(output);
+  output->buffer = wsky_safeMalloc(wsky_TemplateOutput_STREAM_BUFFER_SIZE);
+  output->capacity = wsky_TemplateOutput_STREAM_BUFFER_SIZE;
+  output->writer = writer;
+  output->writerData = writerData;
+}
+
+void wsky_TemplateOutput_initVector(TemplateOutput *output,
+                                    wsky_TemplateVectorWriter writer,
+                                    void *writerData) {
+  wsky_TemplateOutput_initBuffer(output);
+  output->buffer = wsky_safeMalloc(wsky_TemplateOutput_STREAM_BUFFER_SIZE);
+  output->capacity = wsky_TemplateOutput_STREAM_BUFFER_SIZE;
+  output->vectorWriter = writer;
+  output->writerData = writerData;
+  output->slices = wsky_safeMalloc(wsky_TemplateOutput_SLICE_COUNT *
+                                   sizeof(TemplateSlice));
+  output->sources = wsky_safeMalloc(wsky_TemplateOutput_SLICE_COUNT *
+                                    sizeof(FileContent *));
+}
+
+/** Releases the contents retained by the slices of a vectored output */
+static void releaseSources(TemplateOutput *output) {
+  for (size_t i = 0; i < output->sourceCount; i++)
+    wsky_FileContent_release(output->sources[i]);
+  output->sourceCount = 0;
+}
+
+void wsky_TemplateOutput_free(TemplateOutput *output) {
+  releaseSources(output);
+  wsky_free(output->buffer);
+  wsky_free(output->slices);
+  wsky_free(output->sources);
+  output->buffer = NULL;
+  output->length = 0;
+  output->capacity = 0;
+  output->slices = NULL;
+  output->sliceCount = 0;
+  output->sources = NULL;
+}
+
+void wsky_TemplateOutput_clear(TemplateOutput *output) {
+  releaseSources(output);
+  output->length = 0;
+  output->sliceCount = 0;
+}
+
+/** Grows the buffer of a buffered output to hold at least the capacity */
+static void reserve(TemplateOutput *output, size_t capacity) {
+  if (capacity <= output->capacity)
+    return;
+
+  size_t newCapacity = output->capacity ? output->capacity * 2 : 256;
+  while (newCapacity < capacity)
+    newCapacity *= 2;
+  output->buffer = wsky_realloc(output->buffer, newCapacity);
+  if (!output->buffer)
+    abort();
+  output->capacity = newCapacity;
+}
+
+const char *wsky_TemplateOutput_getString(TemplateOutput *output) {
+  reserve(output, output->length + 1);
+  output->buffer[output->length] = '\0';
+  return output->buffer;
+}
+
+static void writeToCallback(TemplateOutput *output,
+                            const char *bytes, size_t length) {
+  if (!output->failed && length)
+    output->failed = !output->writer(output->writerData, bytes, length);
+}
+
+bool wsky_TemplateOutput_flush(TemplateOutput *output) {
+  if (output->writer) {
+    writeToCallback(output, output->buffer, output->length);
+    output->length = 0;
+  } else if (output->vectorWriter) {
+    if (!output->failed && output->sliceCount)
+      output->failed = !output->vectorWriter(output->writerData,
+                                             output->slices,
+                                             output->sliceCount);
+    output->sliceCount = 0;
+    output->length = 0;
+    releaseSources(output);
+  }
+  return !output->failed;
+}
+
+/** Adds a slice to a vectored output */
+static void addSlice(TemplateOutput *output,
+                     const char *bytes, size_t length) {
+  if (output->sliceCount == wsky_TemplateOutput_SLICE_COUNT)
+    wsky_TemplateOutput_flush(output);
+  TemplateSlice *slice = output->slices + output->sliceCount++;
+  slice->bytes = bytes;
+  slice->length = length;
+}
+
+/** Copies some bytes into the buffer of a vectored output */
+static void writeToVector(TemplateOutput *output,
+                          const char *bytes, size_t length) {
+  if (output->length + length > output->capacity ||
+      output->sliceCount == wsky_TemplateOutput_SLICE_COUNT)
+    wsky_TemplateOutput_flush(output);
+
+  /* Large pieces are not copied, they are written at once */
+  if (length >= output->capacity) {
+    addSlice(output, bytes, length);
+    wsky_TemplateOutput_flush(output);
+    return;
+  }
+
+  char *end = output->buffer + output->length;
+  memcpy(end, bytes, length);
+  output->length += length;
+
+  /* The bytes follow the last ones copied */
+  if (output->sliceCount) {
+    TemplateSlice *last = output->slices + output->sliceCount - 1;
+    if (last->bytes + last->length == end) {
+      last->length += length;
+      return;
+    }
+  }
+  addSlice(output, end, length);
+}
+
+void wsky_TemplateOutput_write(TemplateOutput *output,
+                               const char *bytes, size_t length) {
+  if (output->vectorWriter) {
+    writeToVector(output, bytes, length);
+    return;
+  }
+
+  if (output->writer) {
+    if (output->length + length > output->capacity) {
+      wsky_TemplateOutput_flush(output);
+
+      /* Large pieces are not copied */
+      if (length >= output->capacity) {
+        writeToCallback(output, bytes, length);
+        return;
+      }
+    }
+  } else {
+    reserve(output, output->length + length);
+  }
+
+  memcpy(output->buffer + output->length, bytes, length);
+  output->length += length;
+}
+
+void wsky_TemplateOutput_writeStatic(TemplateOutput *output,
+                                     const char *bytes, size_t length) {
+  if (output->vectorWriter && length >= MIN_STATIC_SLICE_LENGTH)
+    addSlice(output, bytes, length);
+  else
+    wsky_TemplateOutput_write(output, bytes, length);
+}
+
+void wsky_TemplateOutput_writeEscaped(TemplateOutput *output,
+                                      const char *bytes, size_t length) {
+  while (length) {
+    size_t run = wsky_html_findSpecial(bytes, length);
+    if (run)
+      wsky_TemplateOutput_write(output, bytes, run);
+    if (run == length)
+      return;
+    size_t entityLength;
+    const char *entity = wsky_html_getEntity(bytes[run], &entityLength);
+    wsky_TemplateOutput_write(output, entity, entityLength);
+    bytes += run + 1;
+    length -= run + 1;
+  }
+}
+
+/** Retains a content until the next flush, once per flush */
+static void retainSource(TemplateOutput *output, FileContent *source) {
+  for (size_t i = output->sourceCount; i > 0; i--)
+    if (output->sources[i - 1] == source)
+      return;
+  output->sources[output->sourceCount++] = wsky_FileContent_retain(source);
+}
+
+void wsky_TemplateOutput_writeSource(TemplateOutput *output,
+                                     FileContent *source,
+                                     size_t offset, size_t length) {
+  const char *bytes = source->string + offset;
+  if (output->vectorWriter && length >= MIN_STATIC_SLICE_LENGTH) {
+    /* The slice may outlive the node which refers to the content */
+    addSlice(output, bytes, length);
+    retainSource(output, source);
+  } else {
+    wsky_TemplateOutput_write(output, bytes, length);
+  }
+}
+
+bool wsky_TemplateOutput_writeToDescriptor(void *data,
+                                           const TemplateSlice *slices,
+                                           size_t count) {
+  int descriptor = *(const int *)data;
+  struct iovec vectors[wsky_TemplateOutput_SLICE_COUNT];
+  if (count > wsky_TemplateOutput_SLICE_COUNT)
+    return false;
+  for (size_t i = 0; i < count; i++) {
+    vectors[i].iov_base = (void *)slices[i].bytes;
+    vectors[i].iov_len = slices[i].length;
+  }
+
+  struct iovec *vector = vectors;
+  while (count) {
+    ssize_t written = writev(descriptor, vector, (int)count);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    /* Skips what has been written */
+    size_t remaining = (size_t)written;
+    while (count && remaining >= vector->iov_len) {
+      remaining -= vector->iov_len;
+      vector++;
+      count--;
+    }
+    if (count) {
+      vector->iov_base = (char *)vector->iov_base + remaining;
+      vector->iov_len -= remaining;
+    }
+  }
+  return true;
+}
+
+Result wsky_TemplateOutput_writeValue(TemplateOutput *output, Value value) {
+  if (Value_getType(value) != Type_OBJECT) {
+    char buffer[wsky_FORMAT_BUFFER_SIZE];
+    size_t length = wsky_formatPrimitive(value, buffer);
+    wsky_TemplateOutput_write(output, buffer, length);
+    RETURN_NULL;
+  }
+
+  if (wsky_isString(value)) {
+    const String *string = (const String *)Value_toObject(value);
+    wsky_TemplateOutput_writeEscaped(output,
+                                     string->string, strlen(string->string));
+    RETURN_NULL;
+  }
+
+  HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  wsky_Handle_new(value);
+  Result rv = wsky_toString(value);
+  wsky_HandleScope_close(&handleScope);
+  if (rv.exception)
+    return rv;
+  const String *string = (const String *)Value_toObject(rv.v);
+  wsky_TemplateOutput_writeEscaped(output,
+                                   string->string, strlen(string->string));
+  RETURN_NULL;
+}
+
+
+void wsky_TemplateOutput_push(TemplateOutput *output) {
+  output->previous = currentOutput;
+  currentOutput = output;
+}
+
+void wsky_TemplateOutput_pop(void) {
+  currentOutput = currentOutput->previous;
+}
+
+TemplateOutput *wsky_TemplateOutput_getCurrent(void) {
+  return currentOutput;
+}
+
+
+Result wsky_Template_writeHtml(const HtmlNode *node) {
+  if (!currentOutput)
+    RAISE_NEW_EXCEPTION("No template is rendered");
+  for (unsigned i = 0; i < node->sliceCount; i++) {
+    const HtmlSlice *slice = node->slices + i;
+    wsky_TemplateOutput_writeSource(currentOutput, node->source,
+                                    slice->offset, slice->length);
+  }
+  RETURN_NULL;
+}
+
+Result wsky_Template_print(Value value) {
+  if (!currentOutput)
+    RAISE_NEW_EXCEPTION("No template is rendered");
+  return wsky_TemplateOutput_writeValue(currentOutput, value);
+}
@@ -4,52 +4,70 @@
 #include "whiskey_private.h"
 
 
-inline static char *boolToCString(bool v) {
-  return wsky_strdup(v ? "true" : "false");
+static size_t copyString(const char *string, char *buffer) {
+  size_t length = strlen(string);
+  memcpy(buffer, string, length + 1);
+  return length;
 }
 
-inline static char *intToCString(wsky_int v) {
-  return wsky_asprintf("%ld", (long) v);
+size_t wsky_formatInt(wsky_int n, char *buffer) {
+  char digits[24];
+  size_t count = 0;
+  uint64_t u = n < 0 ? -(uint64_t)n : (uint64_t)n;
+  do {
+    digits[count++] = (char)('0' + u % 10);
+    u /= 10;
+  } while (u);
+
+  size_t length = 0;
+  if (n < 0)
+    buffer[length++] = '-';
+  while (count)
+    buffer[length++] = digits[--count];
+  buffer[length] = '\0';
+  return length;
 }
 
-inline static char *floatToCString(wsky_float v) {
-  if (isnan(v))
-    return wsky_strdup("NaN");
-  if (isinf(v))
-    return wsky_strdup(v > 0.0 ? "Infinity" : "-Infinity");
-  char *s = wsky_safeMalloc(100);
-  snprintf(s, 80, "%.10g", (double) v);
-  if (!strchr(s, '.') && !strchr(s, 'e')) {
-    strcat(s, ".0");
+size_t wsky_formatFloat(wsky_float n, char *buffer) {
+  if (isnan(n))
+    return copyString("NaN", buffer);
+  if (isinf(n))
+    return copyString(n > 0.0 ? "Infinity" : "-Infinity", buffer);
+
+  int length = snprintf(buffer, wsky_FORMAT_BUFFER_SIZE - 2,
+                        "%.10g", (double) n);
+  assert(length > 0 && length < wsky_FORMAT_BUFFER_SIZE - 2);
+  if (!strchr(buffer, '.') && !strchr(buffer, 'e')) {
+    strcpy(buffer + length, ".0");
+    length += 2;
   }
-  return s;
+  return (size_t)length;
 }
 
-/* Returns a malloc'd null-terminated string */
-static char *primitiveToCString(Value value) {
-  switch (value.type) {
+size_t wsky_formatPrimitive(Value value, char *buffer) {
+  switch (Value_getType(value)) {
   case Type_BOOL:
-    return boolToCString(value.v.objectValue);
+    return copyString(Value_toBool(value) ? "true" : "false", buffer);
   case Type_INT:
-    return intToCString(value.v.intValue);
+    return wsky_formatInt(Value_toInt(value), buffer);
   case Type_FLOAT:
-    return floatToCString(value.v.floatValue);
+    return wsky_formatFloat(Value_toFloat(value), buffer);
   case Type_OBJECT:
     abort();
   }
   abort();
 }
 
-static String *primitiveToString(const Value value) {
-  char *cs = primitiveToCString(value);
-  String *s = wsky_String_new(cs);
-  wsky_free(cs);
-  return s;
-}
-
 Result wsky_toString(const Value value) {
-  if (value.type == Type_OBJECT) {
-    return wsky_Object_toString(value.v.objectValue);
+  String *cached = wsky_String_getCached(value);
+  if (cached)
+    RETURN_OBJECT((Object *) cached);
+
+  if (Value_getType(value) == Type_OBJECT) {
+    return wsky_Object_toString(Value_toObject(value));
   }
-  RETURN_OBJECT((Object *) primitiveToString(value));
+
+  char buffer[wsky_FORMAT_BUFFER_SIZE];
+  wsky_formatPrimitive(value, buffer);
+  RETURN_C_STRING(buffer);
 }
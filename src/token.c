@@ -9,7 +9,7 @@ Token wsky_Token_create(Position begin, Position end,
   Token t = {
     .begin = begin,
     .end = end,
-    .string = wsky_strdup(string),
+    .string = string ? wsky_strdup(string) : NULL,
     .type = type,
   };
   if (type == wsky_TokenType_STRING)
@@ -94,6 +94,12 @@ static char *valueToString(const Token *token) {
 
 char *wsky_Token_toString(const Token *token) {
   const char *type = wsky_TokenType_toString(token);
+  if (token->type == wsky_TokenType_HTML) {
+    const char *html = token->begin.file->content + token->begin.index;
+    return wsky_asprintf("{type: %s; string: %.*s}", type,
+                         token->end.index - token->begin.index, html);
+  }
+
   char *value = valueToString(token);
   if (!value) {
     return wsky_asprintf("{type: %s; string: %s}",
@@ -167,6 +173,8 @@ void wsky_TokenList_deleteComments(TokenList **listPointer) {
     wsky_free(list);
     return;
   }
+  if (token->type == wsky_TokenType_WSKY_PRINT)
+    wsky_TokenList_deleteComments(&token->v.children);
   wsky_TokenList_deleteComments(&(*listPointer)->next);
 }
 
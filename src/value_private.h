@@ -32,4 +32,24 @@ typedef wsky_Value Value;
 
 #define Value_new               wsky_Value_new
 
+#define Value_getType           wsky_Value_getType
+#define Value_toBool            wsky_Value_toBool
+#define Value_toInt             wsky_Value_toInt
+#define Value_toFloat           wsky_Value_toFloat
+#define Value_toObject          wsky_Value_toObject
+
+/* The initializers of the constant values */
+#ifdef WSKY_NAN_BOXING
+# define Value_BOOL_INITIALIZER(b)      {wsky_Value_BOOL_TAG | (b)}
+# define Value_INT_INITIALIZER(n)       {wsky_Value_INT_TAG | (n)}
+# define Value_NULL_INITIALIZER         {wsky_Value_OBJECT_TAG}
+#else
+# define Value_BOOL_INITIALIZER(b)                       \
+  {.type = Type_BOOL, .v = {.boolValue = (b)}}
+# define Value_INT_INITIALIZER(n)                        \
+  {.type = Type_INT, .v = {.intValue = (n)}}
+# define Value_NULL_INITIALIZER                         \
+  {.type = Type_OBJECT, .v = {.objectValue = NULL}}
+#endif
+
 #endif /* VALUE_PRIVATE_H */
@@ -0,0 +1,557 @@
+#include <assert.h>
+#include "eval_private.h"
+
+typedef wsky_Bytecode Bytecode;
+typedef wsky_BytecodeConstant Constant;
+
+#define OP(name) wsky_Opcode_ ## name
+
+#if defined(__GNUC__) && !defined(WSKY_VM_NO_COMPUTED_GOTO)
+/* Labels as values are a GNU extension, allowed only where they are used */
+# define USE_COMPUTED_GOTO
+# define GNU_EXTENSION_BEGIN                    \
+  _Pragma("GCC diagnostic push")                \
+  _Pragma("GCC diagnostic ignored \"-Wpedantic\"")
+# define GNU_EXTENSION_END _Pragma("GCC diagnostic pop")
+#endif
+
+
+/** The number of values of the stack */
+#define STACK_SIZE (64 * 1024)
+
+/** The maximum number of nested calls of Whiskey functions */
+#define MAX_FRAMES 4096
+
+/** The maximum number of nested `try` */
+#define MAX_HANDLERS 4096
+
+
+/** A call of a Whiskey function, or a call of wsky_vm_run() */
+typedef struct {
+  const Bytecode *bytecode;
+
+  /** The saved program counter */
+  const uint32_t *pc;
+
+  /** The saved current scope */
+  Scope *scope;
+
+  /**
+   * The slot of the function on the stack, where the return value
+   * will be pushed.
+   */
+  Value *base;
+
+  /** The number of scopes pushed with wsky_eval_pushScope() */
+  unsigned scopeDepth;
+} Frame;
+
+/** An exception handler installed by a `TRY` instruction */
+typedef struct {
+  unsigned frame;
+  unsigned target;
+  Value *sp;
+  Scope *scope;
+  unsigned scopeDepth;
+} Handler;
+
+
+static bool enabled = false;
+
+static Value stack[STACK_SIZE];
+
+/** The top of the stack, updated before each instruction */
+static Value *stackTop = stack;
+
+static Frame frames[MAX_FRAMES];
+static unsigned frameCount = 0;
+
+static Handler handlers[MAX_HANDLERS];
+static unsigned handlerCount = 0;
+
+
+void wsky_vm_setEnabled(bool enabled_) {
+  enabled = enabled_;
+}
+
+bool wsky_vm_isEnabled(void) {
+  return enabled;
+}
+
+void wsky_vm_visitStack(void) {
+  for (Value *value = stack; value < stackTop; value++)
+    wsky_GC_visitValue(*value);
+  for (unsigned i = 0; i < frameCount; i++)
+    wsky_GC_visitObject(frames[i].scope);
+  for (unsigned i = 0; i < handlerCount; i++)
+    wsky_GC_visitObject(handlers[i].scope);
+}
+
+
+static void popScopes(unsigned count) {
+  while (count--)
+    wsky_eval_popScope();
+}
+
+static Exception *newException(const char *message) {
+  return wsky_Result_newException(message).exception;
+}
+
+static bool hasStackRoom(const Value *sp, const Bytecode *bytecode) {
+  return frameCount < MAX_FRAMES &&
+    sp + bytecode->maxStackSize <= stack + STACK_SIZE;
+}
+
+static bool isWhiskeyFunction(Value value) {
+  return wsky_isFunction(value) &&
+    ((Function *)Value_toObject(value))->node;
+}
+
+
+Result wsky_vm_run(const Bytecode *bytecode, Scope *scope) {
+  Value *base = stackTop;
+  if (!hasStackRoom(base, bytecode))
+    RAISE_NEW_EXCEPTION("Stack overflow");
+
+  const unsigned baseFrame = frameCount;
+  const unsigned baseHandler = handlerCount;
+
+  Frame *frame = frames + frameCount++;
+  frame->bytecode = bytecode;
+  frame->scope = scope;
+  frame->base = base;
+  frame->scopeDepth = 0;
+
+  const uint32_t *pc = bytecode->code;
+  const Constant *constants = bytecode->constants;
+  Value *sp = base;
+  Exception *exception;
+  Result rv;
+
+#define READ() (*pc++)
+#define CONSTANT() (constants[READ()])
+#define PUSH(value) (*sp++ = (value))
+#define POP() (*--sp)
+#define TOP() (sp[-1])
+#define THROW(e) do { exception = (e); goto raise; } while (0)
+#define CHECK(result)                           \
+  do {                                          \
+    rv = (result);                              \
+    if (rv.exception)                           \
+      THROW(rv.exception);                      \
+  } while (0)
+
+#define SAVE_FRAME()                            \
+  do {                                          \
+    frame->pc = pc;                             \
+    frame->scope = scope;                       \
+  } while (0)
+
+#define LOAD_FRAME()                                    \
+  do {                                                  \
+    pc = frame->pc;                                     \
+    scope = frame->scope;                               \
+    constants = frame->bytecode->constants;             \
+  } while (0)
+
+#ifdef USE_COMPUTED_GOTO
+  GNU_EXTENSION_BEGIN
+  static const void *const labels[] = {
+# define LABEL(name, operandCount) &&LABEL_ ## name,
+    wsky_OPCODES(LABEL)
+# undef LABEL
+  };
+  GNU_EXTENSION_END
+
+# define TARGET(name) LABEL_ ## name:
+# define DISPATCH()                             \
+  do {                                          \
+    stackTop = sp;                              \
+    GNU_EXTENSION_BEGIN                         \
+    goto *labels[*pc++];                        \
+    GNU_EXTENSION_END                           \
+  } while (0)
+
+  DISPATCH();
+
+#else
+
+# define TARGET(name) case OP(name):
+# define DISPATCH() goto dispatch
+
+ dispatch:
+  stackTop = sp;
+  switch ((wsky_Opcode)*pc++) {
+
+#endif
+
+  TARGET(PUSH_NULL) {
+    PUSH(Value_NULL);
+    DISPATCH();
+  }
+
+  TARGET(PUSH_TRUE) {
+    PUSH(Value_TRUE);
+    DISPATCH();
+  }
+
+  TARGET(PUSH_FALSE) {
+    PUSH(Value_FALSE);
+    DISPATCH();
+  }
+
+  TARGET(PUSH_INT) {
+    PUSH(Value_fromInt(CONSTANT().intValue));
+    DISPATCH();
+  }
+
+  TARGET(PUSH_FLOAT) {
+    PUSH(Value_fromFloat(CONSTANT().floatValue));
+    DISPATCH();
+  }
+
+  TARGET(PUSH_STRING) {
+    const char *cString = CONSTANT().stringValue;
+    String *string;
+    if (*cString)
+      string = wsky_String_new(cString);
+    else
+      string = wsky_String_getEmpty();
+    PUSH(Value_fromObject((Object *)string));
+    DISPATCH();
+  }
+
+  TARGET(POP) {
+    sp--;
+    DISPATCH();
+  }
+
+  TARGET(LOAD_SLOT) {
+    unsigned depth = READ();
+    unsigned slot = READ();
+    const char *name = CONSTANT().stringValue;
+    Value *value = wsky_Scope_getSlot(scope, depth, slot);
+    if (value) {
+      PUSH(*value);
+      DISPATCH();
+    }
+    CHECK(wsky_eval_getVariable(scope, name));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(LOAD_NAME) {
+    CHECK(wsky_eval_getVariable(scope, CONSTANT().stringValue));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(STORE_SLOT) {
+    unsigned depth = READ();
+    unsigned slot = READ();
+    const char *name = CONSTANT().stringValue;
+    if (wsky_Scope_setSlot(scope, depth, slot, TOP()))
+      DISPATCH();
+    CHECK(wsky_eval_setVariable(scope, name, TOP()));
+    DISPATCH();
+  }
+
+  TARGET(STORE_NAME) {
+    CHECK(wsky_eval_setVariable(scope, CONSTANT().stringValue, TOP()));
+    DISPATCH();
+  }
+
+  TARGET(DECLARE_SLOT) {
+    int slot = (int)READ();
+    const char *name = CONSTANT().stringValue;
+    CHECK(wsky_eval_declareVariable(scope, name, slot, TOP()));
+    DISPATCH();
+  }
+
+  TARGET(DECLARE_NAME) {
+    const char *name = CONSTANT().stringValue;
+    CHECK(wsky_eval_declareVariable(scope, name, -1, TOP()));
+    DISPATCH();
+  }
+
+  TARGET(PUSH_SELF) {
+    CHECK(wsky_eval_getSelf(scope));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(PUSH_SUPERCLASS) {
+    CHECK(wsky_eval_getSuperclass(scope));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(BINARY) {
+    Operator operator = (Operator)READ();
+    Value right = POP();
+    CHECK(wsky_doBinaryOperation(TOP(), operator, right));
+    TOP() = rv.v;
+    DISPATCH();
+  }
+
+  TARGET(UNARY) {
+    Operator operator = (Operator)READ();
+    CHECK(wsky_doUnaryOperation(operator, TOP()));
+    TOP() = rv.v;
+    DISPATCH();
+  }
+
+  TARGET(ENTER_SCOPE) {
+    unsigned slotCount = READ();
+    Scope *inner = wsky_Scope_newWithSlots(scope,
+                                           scope->defClass, scope->self,
+                                           slotCount);
+    wsky_eval_pushScope(inner);
+    frame->scopeDepth++;
+    scope = inner;
+    DISPATCH();
+  }
+
+  TARGET(LEAVE_SCOPE) {
+    wsky_eval_popScope();
+    frame->scopeDepth--;
+    scope = scope->parent;
+    DISPATCH();
+  }
+
+  TARGET(MAKE_FUNCTION) {
+    const FunctionNode *node = (const FunctionNode *)CONSTANT().node;
+    Function *function = wsky_Function_newFromWsky(node->name, node, scope);
+    PUSH(Value_fromObject((Object *)function));
+    DISPATCH();
+  }
+
+  TARGET(CALL) {
+    unsigned parameterCount = READ();
+    Value *callee = sp - parameterCount - 1;
+
+    if (!isWhiskeyFunction(*callee)) {
+      CHECK(wsky_eval_call(*callee, parameterCount, callee + 1));
+      sp = callee;
+      PUSH(rv.v);
+      DISPATCH();
+    }
+
+    Function *function = (Function *)Value_toObject(*callee);
+    const Bytecode *code = wsky_Function_getBytecode(function);
+    if (!hasStackRoom(sp, code))
+      THROW(newException("Stack overflow"));
+
+    CHECK(wsky_Function_newCallScope(function, NULL, NULL,
+                                     parameterCount, callee + 1));
+    Scope *inner = (Scope *)Value_toObject(rv.v);
+    wsky_eval_pushScope(inner);
+    wsky_GC_safepoint();
+
+    SAVE_FRAME();
+    frame = frames + frameCount++;
+    frame->bytecode = code;
+    frame->scope = inner;
+    frame->base = callee;
+    frame->scopeDepth = 1;
+    pc = code->code;
+    constants = code->constants;
+    scope = inner;
+    DISPATCH();
+  }
+
+  TARGET(SUPER_CALL) {
+    unsigned parameterCount = READ();
+    sp -= parameterCount;
+    CHECK(wsky_eval_callSuper(scope, parameterCount, sp));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(GET_METHOD) {
+    const MemberAccessNode *node = (const MemberAccessNode *)CONSTANT().node;
+    InlineCache *cache = wsky_eval_getMemberCache(node);
+    Method *method = wsky_eval_findMethod(scope, TOP(), node->name, cache);
+    if (method) {
+      Value self = TOP();
+      TOP() = Value_fromObject((Object *)method);
+      PUSH(self);
+      DISPATCH();
+    }
+    CHECK(wsky_eval_getMember(scope, TOP(), node->name, cache));
+    TOP() = Value_NULL;
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(CALL_METHOD) {
+    unsigned parameterCount = READ();
+    Value *base = sp - parameterCount - 2;
+    Object *method = Value_toObject(*base);
+    if (method)
+      CHECK(wsky_eval_callMethod((Method *)method, base[1],
+                                 parameterCount, base + 2));
+    else
+      CHECK(wsky_eval_call(base[1], parameterCount, base + 2));
+    sp = base;
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(GET_MEMBER) {
+    const MemberAccessNode *node = (const MemberAccessNode *)CONSTANT().node;
+    CHECK(wsky_eval_getMember(scope, TOP(), node->name,
+                              wsky_eval_getMemberCache(node)));
+    TOP() = rv.v;
+    DISPATCH();
+  }
+
+  TARGET(GET_SUPER_MEMBER) {
+    CHECK(wsky_eval_getSuperMember(scope, CONSTANT().stringValue));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(SET_MEMBER) {
+    const MemberAccessNode *node = (const MemberAccessNode *)CONSTANT().node;
+    Value object = POP();
+    CHECK(wsky_eval_setMember(scope, object, node->name, TOP(),
+                              wsky_eval_getMemberCache(node)));
+    DISPATCH();
+  }
+
+  TARGET(SET_SUPER_MEMBER) {
+    const char *name = CONSTANT().stringValue;
+    CHECK(wsky_eval_setSuperMember(scope, name, TOP()));
+    DISPATCH();
+  }
+
+  TARGET(JUMP) {
+    pc = frame->bytecode->code + *pc;
+    DISPATCH();
+  }
+
+  TARGET(JUMP_IF_FALSE) {
+    unsigned target = READ();
+    Value value = POP();
+    if (!wsky_isBoolean(value)) {
+      TypeError *e = wsky_TypeError_new("Expected a Boolean");
+      THROW((Exception *)e);
+    }
+    if (!Value_toBool(value))
+      pc = frame->bytecode->code + target;
+    DISPATCH();
+  }
+
+  TARGET(TRY) {
+    unsigned target = READ();
+    if (handlerCount == MAX_HANDLERS)
+      THROW(newException("Too many nested try"));
+    Handler *handler = handlers + handlerCount++;
+    handler->frame = frameCount - 1;
+    handler->target = target;
+    handler->sp = sp;
+    handler->scope = scope;
+    handler->scopeDepth = frame->scopeDepth;
+    DISPATCH();
+  }
+
+  TARGET(END_TRY) {
+    assert(handlerCount > baseHandler);
+    handlerCount--;
+    DISPATCH();
+  }
+
+  TARGET(EXCEPT_MATCH) {
+    unsigned target = READ();
+    Value class = POP();
+    Exception *e = (Exception *)Value_toObject(TOP());
+    CHECK(wsky_eval_matchException(e, class));
+    if (Value_toBool(rv.v))
+      pc = frame->bytecode->code + target;
+    DISPATCH();
+  }
+
+  TARGET(RAISE) {
+    Value value = POP();
+    THROW((Exception *)Value_toObject(value));
+  }
+
+  TARGET(WRITE_HTML) {
+    CHECK(wsky_Template_writeHtml((const HtmlNode *)CONSTANT().node));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(PRINT) {
+    Value value = POP();
+    CHECK(wsky_Template_print(value));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(EVAL_NODE) {
+    CHECK(wsky_evalNode(CONSTANT().node, scope));
+    PUSH(rv.v);
+    DISPATCH();
+  }
+
+  TARGET(RETURN) {
+    Value value = POP();
+    popScopes(frame->scopeDepth);
+    sp = frame->base;
+    frameCount--;
+    if (frameCount == baseFrame) {
+      assert(handlerCount == baseHandler);
+      stackTop = base;
+      RETURN_VALUE(value);
+    }
+    frame = frames + frameCount - 1;
+    LOAD_FRAME();
+    PUSH(value);
+    DISPATCH();
+  }
+
+#ifndef USE_COMPUTED_GOTO
+  default:
+    abort();
+  }
+#endif
+
+ raise:
+  if (handlerCount > baseHandler) {
+    Handler *handler = handlers + --handlerCount;
+    while (frameCount - 1 > handler->frame) {
+      popScopes(frames[frameCount - 1].scopeDepth);
+      frameCount--;
+    }
+    frame = frames + handler->frame;
+    popScopes(frame->scopeDepth - handler->scopeDepth);
+    frame->scopeDepth = handler->scopeDepth;
+    scope = handler->scope;
+    constants = frame->bytecode->constants;
+    pc = frame->bytecode->code + handler->target;
+    sp = handler->sp;
+    PUSH(Value_fromObject((Object *)exception));
+    DISPATCH();
+  }
+
+  while (frameCount > baseFrame) {
+    popScopes(frames[frameCount - 1].scopeDepth);
+    frameCount--;
+  }
+  stackTop = base;
+  RAISE_EXCEPTION(exception);
+
+#undef READ
+#undef CONSTANT
+#undef PUSH
+#undef POP
+#undef TOP
+#undef THROW
+#undef CHECK
+#undef SAVE_FRAME
+#undef LOAD_FRAME
+#undef TARGET
+#undef DISPATCH
+}
@@ -17,8 +17,12 @@ void wsky_start(void) {
 
 void wsky_stop(void) {
   started = false;
+  wsky_FileCache_clear();
   wsky_GC_deleteAll();
+  wsky_String_clearCache();
+  wsky_Handle_freeAll();
 
   wsky_freeBuiltinClasses();
   wsky_Module_deleteModules();
+  wsky_Symbol_freeAll();
 }
@@ -18,13 +18,21 @@
 # define IMPORT(name) typedef wsky_##name name;
 
 IMPORT(AttributeError)
+IMPORT(CachedFile)
 IMPORT(Class)
 IMPORT(ClassArray)
 IMPORT(ClassDef)
 IMPORT(Dict)
 IMPORT(Exception)
+IMPORT(FieldCache)
+IMPORT(FileContent)
+IMPORT(FileStamp)
 IMPORT(Function)
+IMPORT(HandleScope)
+IMPORT(HtmlSlice)
 IMPORT(ImportError)
+IMPORT(InlineCache)
+IMPORT(InlineCacheEntry)
 IMPORT(InstanceMethod)
 IMPORT(Keyword)
 IMPORT(LexerResult)
@@ -43,11 +51,15 @@ IMPORT(ParserResult)
 IMPORT(Position)
 IMPORT(ProgramFile)
 IMPORT(Scope)
+IMPORT(Shape)
 IMPORT(String)
 IMPORT(StringReader)
 IMPORT(Structure)
+IMPORT(Symbol)
 IMPORT(SyntaxError)
 IMPORT(SyntaxErrorEx)
+IMPORT(TemplateOutput)
+IMPORT(TemplateSlice)
 IMPORT(Token)
 IMPORT(TokenList)
 IMPORT(TokenType)
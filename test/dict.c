@@ -1,6 +1,8 @@
 #include "test.h"
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "dict.h"
 
 static void delete(void) {
@@ -18,7 +20,88 @@ static void a(void) {
   wsky_Dict_delete(dict);
 }
 
+static void longKeys(void) {
+  wsky_Dict *dict = wsky_Dict_new();
+  wsky_Dict_set(dict, "a very long key, longer than the others", "1");
+  wsky_Dict_set(dict, "", "2");
+  yolo_assert_str_eq("1", wsky_Dict_get(dict,
+                                        "a very long key, "
+                                        "longer than the others"));
+  yolo_assert_str_eq("2", wsky_Dict_get(dict, ""));
+  yolo_assert_null(wsky_Dict_get(dict, "a very long key"));
+  wsky_Dict_delete(dict);
+}
+
+static void overwrite(void) {
+  wsky_Dict *dict = wsky_Dict_new();
+  wsky_Dict_set(dict, "a", "1");
+  wsky_Dict_set(dict, "a", "2");
+  yolo_assert_ulong_eq(1, wsky_Dict_getCount(dict));
+  yolo_assert_str_eq("2", wsky_Dict_get(dict, "a"));
+  wsky_Dict_delete(dict);
+}
+
+#define MANY 1000
+
+static char manyKeys[MANY][16];
+
+static void growth(void) {
+  wsky_Dict *dict = wsky_Dict_new();
+  for (int i = 0; i < MANY; i++) {
+    snprintf(manyKeys[i], sizeof manyKeys[i], "key%d", i);
+    wsky_Dict_set(dict, manyKeys[i], manyKeys[i]);
+  }
+  yolo_assert_ulong_eq(MANY, wsky_Dict_getCount(dict));
+
+  bool allFound = true;
+  for (int i = 0; i < MANY; i++)
+    allFound = allFound && wsky_Dict_get(dict, manyKeys[i]) == manyKeys[i];
+  yolo_assert(allFound);
+
+  for (int i = 0; i < MANY; i += 2)
+    wsky_Dict_remove(dict, manyKeys[i]);
+  yolo_assert_ulong_eq(MANY / 2, wsky_Dict_getCount(dict));
+
+  bool removedOk = true;
+  for (int i = 0; i < MANY; i++) {
+    bool contains = wsky_Dict_contains(dict, manyKeys[i]);
+    removedOk = removedOk && contains == (i % 2 == 1);
+  }
+  yolo_assert(removedOk);
+
+  for (int i = 0; i < MANY; i += 2)
+    wsky_Dict_set(dict, manyKeys[i], manyKeys[i]);
+  yolo_assert_ulong_eq(MANY, wsky_Dict_getCount(dict));
+
+  wsky_Dict_delete(dict);
+}
+
+static char orderBuffer[64];
+
+static void appendKey(const char *key, void *value) {
+  (void)value;
+  strcat(orderBuffer, key);
+}
+
+static void insertionOrder(void) {
+  wsky_Dict *dict = wsky_Dict_new();
+  const char *keys[] = {"m", "a", "z", "b", "y", "c", "x", "d", "w", "e"};
+  for (int i = 0; i < 10; i++)
+    wsky_Dict_set(dict, keys[i], NULL);
+  wsky_Dict_remove(dict, "z");
+  wsky_Dict_set(dict, "z", NULL);
+
+  orderBuffer[0] = '\0';
+  wsky_Dict_apply(dict, appendKey);
+  yolo_assert_str_eq("mabycxdwez", orderBuffer);
+  wsky_Dict_delete(dict);
+}
+
 void dictTestSuite(void) {
   delete();
   a();
+  longKeys();
+  overwrite();
+  growth();
+  insertionOrder();
 }
@@ -19,7 +19,7 @@ static void assertValueEq(const char *expected, Value value,
     return;
   }
   assert(wsky_isString(stringRv.v));
-  wsky_String *string = (wsky_String *) stringRv.v.v.objectValue;
+  wsky_String *string = (wsky_String *) wsky_Value_toObject(stringRv.v);
   yolo_assert_str_eq_impl(expected, string->string, testName, position);
 }
 
@@ -314,6 +314,20 @@ static void scope(void) {
                ")");
 }
 
+static void resolvedScope(void) {
+  assertEvalEq("1", "var a = 1; (var b = a; var a = 2; b)");
+  assertEvalEq("2", "var a = 1; (var f = {a}; var a = 2; f())");
+  assertEvalEq("1", "var a = 1; (if false: var a = 2; a)");
+  assertEvalEq("2", "var a = 1; (if true: var a = 2; a)");
+  assertEvalEq("5", "var a = 1; {b: a = b}(5); a");
+  assertEvalEq("10", "var f = {n: if n == 0: 0 else: n + f(n - 1)}; f(4)");
+  assertEvalEq("<ZeroDivisionError>",
+               "try: 1 / 0 except ZeroDivisionError as e: (var x = e; x)");
+  assertException("NameError",
+                  "Identifier 'a' already declared",
+                  "(var a; var a)");
+}
+
 static void function(void) {
   assertEvalEq("<Function>", "{}");
   assertEvalEq("<Function>", "{ a, b, c: 'yolo'}");
@@ -323,6 +337,25 @@ static void function(void) {
   assertException("SyntaxError", "Expected ';' or '}'", "{a b}");
 }
 
+/* There is no limit on the parameter count */
+static void manyParameters(void) {
+  char params[256] = "", args[256] = "", source[2048];
+  for (int i = 0; i < 40; i++) {
+    sprintf(params + strlen(params), "%sp%d", i ? ", " : "", i);
+    sprintf(args + strlen(args), "%s%d", i ? ", " : "", i);
+  }
+
+  sprintf(source, "{%s: p0 + p39}(%s)", params, args);
+  assertEvalEq("39", source);
+
+  sprintf(source,
+          "class A (init {%s: @x = p39}; get @x);"
+          "class B: A (init {%s: super(%s)}; @f {%s: @x + p1});"
+          "B(%s).f(%s)",
+          params, params, params, params, args, args);
+  assertEvalEq("40", source);
+}
+
 static void call(void) {
   assertException("SyntaxError", "Expected ')'", "0(");
   assertException("SyntaxError", "Expected ',' or ')'", "0(a b)");
@@ -369,6 +402,8 @@ static void call(void) {
   assertException("TypeError",
                   "'Integer' objects are not callable",
                   "0()");
+
+  manyParameters();
 }
 
 static void functionScope(void) {
@@ -376,6 +411,27 @@ static void functionScope(void) {
   assertEvalEq("1", "var a = 1; {var a = 2}(); a");
 }
 
+/* The functions share their AST node, which outlives the program tree */
+static void closure(void) {
+  assertEvalEq("5", "var f = {n: {m: n + m}}; var g = f(2); f(1); g(3)");
+
+  Result rv = wsky_evalString("{n: {m: n * m}}(2)", NULL);
+  yolo_assert_null(rv.exception);
+  yolo_assert(wsky_isFunction(rv.v));
+
+  wsky_HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  wsky_Value *function = wsky_Handle_new(rv.v);
+  wsky_GC_collect();
+
+  Value parameter = wsky_Value_fromInt(3);
+  rv = wsky_Function_call((wsky_Function *)wsky_Value_toObject(*function),
+                          1, &parameter);
+  assertResultEq("6", rv, __func__, YOLO__POSITION_STRING);
+
+  wsky_HandleScope_close(&handleScope);
+}
+
 static void method(void) {
   assertEvalEq("1",
                "var m = 'hello'.indexOf;"
@@ -704,6 +760,96 @@ static void inheritance(void) {
 }
 
 
+/* The same member access nodes see objects of several classes */
+static void inlineCache(void) {
+  const char *source =
+    "class A (get @name {'a'}; @show {@name});"
+    "class B: A (get @name {'b'});"
+    "class C: B ();"
+    "var f = {o: o.name + o.show()};"
+    "f(A()) + f(B()) + f(C()) + f(A()) + f(C()) + f(B())";
+
+  size_t hitCount = wsky_InlineCache_getHitCount();
+  assertEvalEq("aababaaababa", source);
+  yolo_assert(wsky_InlineCache_getHitCount() > hitCount);
+
+  /* The classes are new, the entries of the previous ones do not match */
+  assertEvalEq("aababaaababa", source);
+
+  assertEvalEq("3",
+               "var f = {o: o.length};"
+               "f('abc')");
+  assertException("AttributeError",
+                  "'Integer' object has no attribute 'show'",
+                  "class A (@show {1});"
+                  "var f = {o: o.show()};"
+                  "f(A()); f(1)");
+}
+
+
+/* The objects whose fields are added in other orders have other shapes */
+static void shapes(void) {
+  assertEvalEq("2 1 a b",
+               "class A ("
+               "  init {first: if first: (@x = 1; @y = 2)"
+               "               else: (@y = 'a'; @x = 'b')};"
+               "  get @x; get @y"
+               ");"
+               "var f = {a: a.y.toString + ' ' + a.x.toString};"
+               "f(A(true)) + ' ' + f(A(false))");
+
+  assertEvalEq("1 2",
+               "class A (init {@x = 1}; get @ax {@x});"
+               "class B: A ("
+               "  init {super(); @x = 2};"
+               "  get @bx {@x}"
+               ");"
+               "var b = B(); b.ax.toString + ' ' + b.bx.toString");
+
+  assertEvalEq("21",
+               "class A ("
+               "  init {"
+               "    @a = 1; @b = 2; @c = 3; @d = 4; @e = 5; @f = 6"
+               "  };"
+               "  get @sum {@a + @b + @c + @d + @e + @f}"
+               ");"
+               "A().sum");
+
+  assertException("AttributeError",
+                  "'A' object has no attribute 'y'",
+                  "class A (init {@x = 1}; get @x {@y});"
+                  "A().x");
+}
+
+
+/* The methods are called without InstanceMethod, the other members are
+   got then called */
+static void methodCall(void) {
+  assertEvalEq("hello",
+               "class A ("
+               "  @hello {@.greet('hel')};"
+               "  private @greet {s: s + 'lo'}"
+               ");"
+               "A().hello()");
+
+  assertEvalEq("3",
+               "class A (init {@f = {x: x + 1}}; get @f);"
+               "A().f(2)");
+
+  assertEvalEq("2", "'hello'.indexOf('l')");
+
+  assertException("TypeError",
+                  "'Integer' objects are not callable",
+                  "class A (get @x {1});"
+                  "A().x()");
+
+  assertException("AttributeError",
+                  "'A' object has no attribute 'greet'",
+                  "class A (private @greet {1});"
+                  "A().greet()");
+}
+
+
 static void ctorInheritance(void) {
 
 }
@@ -786,9 +932,11 @@ void evalTestSuite(void) {
   var();
   variable();
   scope();
+  resolvedScope();
   function();
   call();
   functionScope();
+  closure();
   method();
   toString();
   getClass();
@@ -801,6 +949,9 @@ void evalTestSuite(void) {
   classPerson();
   builtinClasses();
   inheritance();
+  inlineCache();
+  shapes();
+  methodCall();
   ctorInheritance();
   ifElse();
   helloScript();
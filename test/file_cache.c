@@ -0,0 +1,104 @@
+#include "test.h"
+
+#include <stdio.h>
+#include "whiskey.h"
+
+typedef wsky_Result Result;
+
+
+static void writeFile(const char *path, const char *content) {
+  FILE *file = fopen(path, "w");
+  yolo_assert_not_null(file);
+  if (!file)
+    return;
+  fputs(content, file);
+  fclose(file);
+}
+
+static void assertIntResult(long expected, Result rv) {
+  yolo_assert_null(rv.exception);
+  if (!rv.exception)
+    yolo_assert_long_eq(expected, (long)wsky_Value_toInt(rv.v));
+}
+
+
+static void hits(void) {
+  char *path = getLocalFilePath("file_cache_test.wsky");
+  writeFile(path, "6 * 7");
+
+  size_t hitCount = wsky_FileCache_getHitCount();
+  size_t missCount = wsky_FileCache_getMissCount();
+
+  assertIntResult(42, wsky_evalFile(path, NULL));
+  yolo_assert_ulong_eq(missCount + 1, wsky_FileCache_getMissCount());
+  assertIntResult(42, wsky_evalFile(path, NULL));
+  yolo_assert_ulong_eq(hitCount + 1, wsky_FileCache_getHitCount());
+
+  /* The size of the file changes */
+  writeFile(path, "6 * 70");
+  assertIntResult(420, wsky_evalFile(path, NULL));
+  yolo_assert_ulong_eq(missCount + 2, wsky_FileCache_getMissCount());
+
+  remove(path);
+  Result rv = wsky_evalFile(path, NULL);
+  yolo_assert_not_null(rv.exception);
+  wsky_free(path);
+}
+
+static void eviction(void) {
+  size_t capacity = wsky_FileCache_getCapacity();
+  char *a = getLocalFilePath("file_cache_a.wsky");
+  char *b = getLocalFilePath("file_cache_b.wsky");
+  writeFile(a, "1");
+  writeFile(b, "2");
+
+  wsky_FileCache_setCapacity(1);
+  yolo_assert_ulong_eq(1, wsky_FileCache_getSize());
+
+  size_t missCount = wsky_FileCache_getMissCount();
+  assertIntResult(1, wsky_evalFile(a, NULL));
+  assertIntResult(2, wsky_evalFile(b, NULL));
+  assertIntResult(1, wsky_evalFile(a, NULL));
+  yolo_assert_ulong_eq(missCount + 3, wsky_FileCache_getMissCount());
+  yolo_assert_ulong_eq(1, wsky_FileCache_getSize());
+
+  wsky_FileCache_setCapacity(0);
+  yolo_assert_ulong_eq(0, wsky_FileCache_getSize());
+  assertIntResult(2, wsky_evalFile(b, NULL));
+  yolo_assert_ulong_eq(0, wsky_FileCache_getSize());
+
+  wsky_FileCache_setCapacity(capacity);
+  remove(a);
+  remove(b);
+  wsky_free(a);
+  wsky_free(b);
+}
+
+static void templates(void) {
+  char *path = getLocalFilePath("file_cache_test.html");
+  writeFile(path, "<p><%= 1 + 1 %></p>");
+
+  size_t hitCount = wsky_FileCache_getHitCount();
+  for (int i = 0; i < 2; i++) {
+    wsky_TemplateOutput output;
+    wsky_TemplateOutput_initBuffer(&output);
+    Result rv = wsky_evalTemplateFile(path, NULL, &output);
+    yolo_assert_null(rv.exception);
+    yolo_assert_str_eq("<p>2</p>", wsky_TemplateOutput_getString(&output));
+    wsky_TemplateOutput_free(&output);
+  }
+  yolo_assert_ulong_eq(hitCount + 1, wsky_FileCache_getHitCount());
+
+  /* The same file is not a valid program */
+  Result rv = wsky_evalFile(path, NULL);
+  yolo_assert_not_null(rv.exception);
+
+  remove(path);
+  wsky_free(path);
+}
+
+void fileCacheTestSuite(void) {
+  hits();
+  eviction();
+  templates();
+}
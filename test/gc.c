@@ -0,0 +1,397 @@
+#include <string.h>
+#include "test.h"
+
+#include "whiskey.h"
+#include "src/heaps.h"
+
+/* Allocates a lot of garbage, with the stress mode disabled */
+static void allocateGarbage(void) {
+  wsky_Result rv = wsky_evalString("var f = {n: if n == 0: 0 else: ("
+                                   "  'garbage' + n; f(n - 1)"
+                                   ")}; f(2000); f(2000); f(2000)",
+                                   NULL);
+  yolo_assert_null(rv.exception);
+}
+
+static void collectOutsideStressMode(void) {
+  bool stressed = wsky_GC_isStressed();
+  bool compacting = wsky_GC_isCompacting();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  wsky_GC_setStressed(false);
+  wsky_GC_setCompacting(false);
+  wsky_GC_setMinimumThreshold(64 * 1024);
+
+  wsky_GC_Stats before;
+  wsky_GC_getStats(&before);
+  allocateGarbage();
+  wsky_GC_Stats after;
+  wsky_GC_getStats(&after);
+
+  yolo_assert(after.collectionCount > before.collectionCount);
+  yolo_assert(after.totalPauseTime >= before.totalPauseTime);
+  yolo_assert(after.liveObjectCount > 0);
+  yolo_assert(after.liveBytes <= after.allocatedBytes);
+  yolo_assert(after.allocatedBytes <= after.heapSize);
+  yolo_assert(after.threshold >= 64 * 1024);
+
+  yolo_assert(after.minorCollectionCount > before.minorCollectionCount);
+
+  /*
+   * The heap does not keep growing when the same garbage is allocated
+   * again, once the old generation has reached its steady state. The
+   * empty heaps may be released and allocated again, and the heaps grow
+   * by doubling.
+   */
+  size_t maxHeapSize = 0;
+  for (int i = 0; i < 8; i++) {
+    allocateGarbage();
+    wsky_GC_getStats(&after);
+    if (after.heapSize > maxHeapSize)
+      maxHeapSize = after.heapSize;
+  }
+  bool grown = false;
+  for (int i = 0; i < 4; i++) {
+    allocateGarbage();
+    wsky_GC_getStats(&after);
+    grown = grown || after.heapSize > 2 * maxHeapSize;
+  }
+  yolo_assert(!grown);
+
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setCompacting(compacting);
+  wsky_GC_setStressed(stressed);
+}
+
+static void growthFactor(void) {
+  double factor = wsky_GC_getGrowthFactor();
+  wsky_GC_setGrowthFactor(3.0);
+  yolo_assert(wsky_GC_getGrowthFactor() == 3.0);
+
+  wsky_GC_Stats stats;
+  wsky_GC_getStats(&stats);
+  yolo_assert(stats.threshold >= wsky_GC_getMinimumThreshold());
+  yolo_assert(stats.threshold >= stats.liveBytes * 3);
+
+  wsky_GC_setGrowthFactor(factor);
+}
+
+static size_t getAllocatedBytes(void) {
+  wsky_GC_Stats stats;
+  wsky_GC_getStats(&stats);
+  return stats.allocatedBytes;
+}
+
+static void sizeClasses(void) {
+  /* No collection during the test */
+  bool stressed = wsky_GC_isStressed();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  wsky_GC_setStressed(false);
+  wsky_GC_setMinimumThreshold((size_t)-1);
+  wsky_GC_finishSweep();
+
+  size_t before = getAllocatedBytes();
+  wsky_String *string = wsky_String_new("small");
+  yolo_assert_ulong_eq(32, getAllocatedBytes() - before);
+
+  before = getAllocatedBytes();
+  wsky_Scope *scope = wsky_Scope_new(NULL, NULL, NULL);
+  yolo_assert_ulong_eq(128, getAllocatedBytes() - before);
+
+  yolo_assert_str_eq("small", string->string);
+  yolo_assert(scope->class == wsky_Scope_CLASS);
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setStressed(stressed);
+}
+
+static void heapMembership(void) {
+  wsky_String *string = wsky_String_new("member");
+  char *pointer = (char *)string;
+
+  yolo_assert(wsky_heaps_contains(pointer));
+  yolo_assert(!wsky_heaps_contains(pointer + 8));
+  yolo_assert(!wsky_heaps_contains(pointer + 1));
+  yolo_assert(!wsky_heaps_contains(&pointer));
+  yolo_assert(!wsky_heaps_contains(NULL));
+  yolo_assert_str_eq("member", string->string);
+}
+
+/** Creates a chain of scopes, the last one is pushed */
+static wsky_Scope *pushScopeChain(unsigned length) {
+  wsky_Scope *scope = NULL;
+  for (unsigned i = 0; i < length; i++)
+    scope = wsky_Scope_new(scope, NULL, NULL);
+  wsky_eval_pushScope(scope);
+  return scope;
+}
+
+static void deepObjectGraph(unsigned length) {
+  bool stressed = wsky_GC_isStressed();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  wsky_GC_setStressed(false);
+  wsky_GC_setMinimumThreshold((size_t)-1);
+
+  wsky_Scope *scope = pushScopeChain(length);
+  wsky_GC_collect();
+  wsky_GC_Stats stats;
+  wsky_GC_getStats(&stats);
+  yolo_assert(stats.objectCount >= length);
+
+  unsigned count = 0;
+  for (; scope; scope = scope->parent) {
+    if (scope->class != wsky_Scope_CLASS)
+      break;
+    count++;
+  }
+  yolo_assert_ulong_eq(length, count);
+  wsky_eval_popScope();
+
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setStressed(stressed);
+}
+
+/** Creates a scope which holds the given number of strings and pushes it */
+static wsky_Scope *pushWideScope(unsigned count) {
+  wsky_Scope *scope = wsky_Scope_newWithSlots(NULL, NULL, NULL, count);
+  wsky_eval_pushScope(scope);
+  wsky_Symbol name = wsky_Symbol_intern("s");
+  for (unsigned i = 0; i < count; i++) {
+    wsky_Value value = wsky_Value_fromObject(
+      (wsky_Object *)wsky_String_new("wide"));
+    wsky_Scope_declareSlot(scope, i, name, value);
+  }
+  return scope;
+}
+
+/** Returns the number of slots of the scope which hold a string */
+static unsigned countStrings(const wsky_Scope *scope) {
+  unsigned count = 0;
+  for (unsigned i = 0; i < scope->slotCount; i++)
+    if (wsky_isString(scope->slots[i]))
+      count++;
+  return count;
+}
+
+static void markStackOverflow(void (*collect)(void)) {
+  bool stressed = wsky_GC_isStressed();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  size_t limit = wsky_GC_getMarkStackLimit();
+  wsky_GC_setStressed(false);
+  wsky_GC_setMinimumThreshold((size_t)-1);
+  wsky_GC_setMarkStackLimit(4);
+
+  wsky_GC_Stats before;
+  wsky_GC_getStats(&before);
+  wsky_Scope *scope = pushWideScope(1000);
+  collect();
+  wsky_GC_Stats after;
+  wsky_GC_getStats(&after);
+  yolo_assert(after.markStackOverflowCount > before.markStackOverflowCount);
+  yolo_assert_ulong_eq(1000, countStrings(scope));
+  wsky_eval_popScope();
+
+  wsky_GC_setMarkStackLimit(limit);
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setStressed(stressed);
+}
+
+static void allocateYoungGarbage(unsigned count) {
+  for (unsigned i = 0; i < count; i++)
+    wsky_String_new("young garbage");
+}
+
+static void minorCollection(void) {
+  bool stressed = wsky_GC_isStressed();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  wsky_GC_setStressed(false);
+  wsky_GC_setMinimumThreshold((size_t)-1);
+
+  wsky_Scope *scope = wsky_Scope_new(NULL, NULL, NULL);
+  wsky_eval_pushScope(scope);
+  wsky_GC_collect();
+  yolo_assert(scope->_gcOld);
+
+  /* A young object only referenced by an old one */
+  wsky_String *string = wsky_String_new("young");
+  wsky_Scope_addVariable(scope, "young", wsky_Value_fromObject(
+                           (wsky_Object *)string));
+  yolo_assert(scope->_gcRemembered);
+  string = NULL;
+
+  allocateYoungGarbage(1000);
+  wsky_GC_Stats before;
+  wsky_GC_getStats(&before);
+  wsky_GC_collectYoung();
+  wsky_GC_Stats after;
+  wsky_GC_getStats(&after);
+  yolo_assert(after.objectCount + 900 < before.objectCount);
+  yolo_assert(!scope->_gcRemembered);
+
+  wsky_Value young = wsky_Scope_getVariable(scope, "young");
+  yolo_assert(wsky_isString(young));
+  yolo_assert(wsky_Value_toObject(young)->_gcOld);
+  yolo_assert_str_eq("young",
+                     ((wsky_String *)wsky_Value_toObject(young))->string);
+  wsky_eval_popScope();
+
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setStressed(stressed);
+}
+
+static void lazySweep(void) {
+  bool stressed = wsky_GC_isStressed();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  wsky_GC_setStressed(false);
+  wsky_GC_setMinimumThreshold((size_t)-1);
+
+  allocateYoungGarbage(1000);
+  wsky_GC_collect();
+  wsky_GC_Stats stats;
+  wsky_GC_getStats(&stats);
+  yolo_assert(stats.unsweptPageCount > 1);
+  yolo_assert(stats.liveObjectCount < stats.objectCount);
+
+  size_t unsweptPageCount = stats.unsweptPageCount;
+  yolo_assert(!wsky_GC_sweep(1));
+  wsky_GC_getStats(&stats);
+  yolo_assert_ulong_eq(unsweptPageCount - 1, stats.unsweptPageCount);
+
+  yolo_assert(wsky_GC_sweep((size_t)-1));
+  wsky_GC_getStats(&stats);
+  yolo_assert_ulong_eq(0, stats.unsweptPageCount);
+  yolo_assert(stats.objectCount <= stats.liveObjectCount);
+
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setStressed(stressed);
+}
+
+static void releaseEmptyHeaps(void) {
+  bool stressed = wsky_GC_isStressed();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  wsky_GC_setStressed(false);
+
+  /* A peak of garbage */
+  wsky_GC_setMinimumThreshold((size_t)-1);
+  wsky_GC_collect();
+  allocateYoungGarbage(50000);
+  wsky_GC_Stats peak;
+  wsky_GC_getStats(&peak);
+
+  /* The heaps emptied by the peak are kept after the first sweep */
+  wsky_GC_setMinimumThreshold(64 * 1024);
+  wsky_GC_collect();
+  wsky_GC_finishSweep();
+  wsky_GC_Stats stats;
+  wsky_GC_getStats(&stats);
+  yolo_assert_ulong_eq(peak.heapSize, stats.heapSize);
+
+  for (int i = 0; i < 4; i++) {
+    wsky_GC_collect();
+    wsky_GC_finishSweep();
+  }
+  wsky_GC_getStats(&stats);
+  yolo_assert(stats.heapSize < peak.heapSize / 2);
+  yolo_assert(stats.allocatedBytes <= stats.heapSize);
+
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setStressed(stressed);
+}
+
+static void preciseRoots(void) {
+  bool stressed = wsky_GC_isStressed();
+  bool precise = wsky_GC_isPrecise();
+  wsky_GC_setStressed(true);
+  wsky_GC_setPrecise(true);
+
+  wsky_HandleScope handleScope;
+  wsky_HandleScope_open(&handleScope);
+  wsky_Value *handle = wsky_Handle_new(wsky_Value_fromObject(
+                                         (wsky_Object *)wsky_String_new("a")));
+  wsky_Value *array = wsky_Handle_newArray(300);
+  yolo_assert(wsky_isNull(array[299]));
+  array[299] = wsky_Value_fromObject((wsky_Object *)wsky_String_new("b"));
+
+  /* The collections are deferred to the next safepoint */
+  wsky_GC_Stats before;
+  wsky_GC_getStats(&before);
+  allocateYoungGarbage(100);
+  wsky_GC_Stats after;
+  wsky_GC_getStats(&after);
+  yolo_assert_ulong_eq(before.collectionCount, after.collectionCount);
+  wsky_GC_safepoint();
+  wsky_GC_getStats(&after);
+  yolo_assert(after.collectionCount > before.collectionCount);
+
+  wsky_GC_collect();
+  wsky_GC_finishSweep();
+  allocateYoungGarbage(100);
+  wsky_String *a = (wsky_String *)wsky_Value_toObject(*handle);
+  wsky_String *b = (wsky_String *)wsky_Value_toObject(array[299]);
+  yolo_assert_str_eq("a", a->string);
+  yolo_assert_str_eq("b", b->string);
+  wsky_HandleScope_close(&handleScope);
+
+  wsky_GC_setPrecise(precise);
+  wsky_GC_setStressed(stressed);
+}
+
+static void compaction(void) {
+  bool stressed = wsky_GC_isStressed();
+  size_t minimumThreshold = wsky_GC_getMinimumThreshold();
+  wsky_GC_setStressed(false);
+  wsky_GC_setMinimumThreshold((size_t)-1);
+
+  /* One string out of 64 survives */
+  wsky_Scope *scope = wsky_Scope_new(NULL, NULL, NULL);
+  wsky_eval_pushScope(scope);
+  char name[32];
+  for (int i = 0; i < 20000; i++) {
+    wsky_String *string = wsky_String_new("sparse");
+    if (i % 64 == 0) {
+      sprintf(name, "s%d", i);
+      wsky_Scope_addVariable(scope, name, wsky_Value_fromObject(
+                               (wsky_Object *)string));
+    }
+  }
+
+  wsky_GC_collect();
+  wsky_GC_finishSweep();
+  wsky_GC_Stats before;
+  wsky_GC_getStats(&before);
+  wsky_GC_compact();
+  wsky_GC_Stats after;
+  wsky_GC_getStats(&after);
+
+  yolo_assert_ulong_eq(before.compactionCount + 1, after.compactionCount);
+  yolo_assert(after.movedObjectCount > before.movedObjectCount);
+  yolo_assert(after.heapSize < before.heapSize);
+  yolo_assert_ulong_eq(before.objectCount, after.objectCount);
+
+  bool intact = true;
+  for (int i = 0; i < 20000; i += 64) {
+    sprintf(name, "s%d", i);
+    wsky_Value value = wsky_Scope_getVariable(scope, name);
+    wsky_String *string = (wsky_String *)wsky_Value_toObject(value);
+    intact = intact && wsky_isString(value) &&
+      strcmp(string->string, "sparse") == 0;
+  }
+  yolo_assert(intact);
+  wsky_eval_popScope();
+
+  wsky_GC_setMinimumThreshold(minimumThreshold);
+  wsky_GC_setStressed(stressed);
+}
+
+void gcTestSuite(void) {
+  collectOutsideStressMode();
+  growthFactor();
+  sizeClasses();
+  heapMembership();
+  deepObjectGraph(200000);
+  markStackOverflow(wsky_GC_collect);
+  markStackOverflow(wsky_GC_collectYoung);
+  minorCollection();
+  lazySweep();
+  releaseEmptyHeaps();
+  preciseRoots();
+  compaction();
+}
@@ -75,6 +75,7 @@ static void literals(void) {
   assertAstEq("hello", "hello");
   assertAstEq("'hello'", "'hello'");
   assertAstEq("'\\\"'", "'\"'");
+  assertAstEq("'a\\n\\t\\'b'", "'a\\n\\t\\'b'");
   assertAstEq("255", "0xff");
   assertAstEq("6.25", "0006.2500");
   assertAstEq("6.25", "0006.2500f");
@@ -200,6 +201,9 @@ static void template(void) {
   assertTpltAstEq("HTML( <html> )", " <html> ");
   assertTpltAstEq("((6 * 5); HTML( yolo ))",
                   "<% (6 * 5; %> yolo <% ) %>");
+  assertTpltAstEq("HTML(<p>); TPLT_PRINT(a); HTML(</p>); if a: HTML(b)",
+                  "<p><%= a %></p><% if a: %>b<% %>");
+  assertTpltAstEq("HTML(<p></p>)", "<p><% /* comment */ %></p>");
 }
 
 static void var(void) {
@@ -1,5 +1,6 @@
 #include "test.h"
 
+#include <stdio.h>
 #include <string.h>
 #include "whiskey.h"
 
@@ -11,7 +12,7 @@ static void baseTests(void) {
   Result rv = wsky_ProgramFile_new(filePath);
   wsky_free(filePath);
   yolo_assert_null(rv.exception);
-  ProgramFile *pf = (ProgramFile *)rv.v.v.objectValue;
+  ProgramFile *pf = (ProgramFile *)wsky_Value_toObject(rv.v);
   yolo_assert_not_null(pf);
   yolo_assert_ulong_neq(0, strlen(pf->content));
   yolo_assert_str_eq("eval.c", pf->name);
@@ -19,6 +20,84 @@ static void baseTests(void) {
     return;
 }
 
+/** Writes a file of the given size, ending with a line break */
+static char *writeFile(const char *name, size_t size, bool nullByte) {
+  char *path = getLocalFilePath(name);
+  FILE *file = fopen(path, "wb");
+  yolo_assert_not_null(file);
+  if (!file)
+    return path;
+  for (size_t i = 0; i < size; i++)
+    fputc(i == size - 1 ? '\n' : nullByte && i == size / 2 ? '\0' : 'a',
+          file);
+  fclose(file);
+  return path;
+}
+
+static void assertLoaded(size_t size, bool mapped) {
+  char *path = writeFile("program_file_test.w", size, false);
+  Result rv = wsky_ProgramFile_new(path);
+  remove(path);
+  wsky_free(path);
+  yolo_assert_null(rv.exception);
+  if (rv.exception)
+    return;
+
+  ProgramFile *pf = (ProgramFile *)wsky_Value_toObject(rv.v);
+  yolo_assert_ulong_eq(size, pf->source->length);
+  yolo_assert_ulong_eq(size, strlen(pf->content));
+  yolo_assert_char_eq('\n', pf->content[size - 1]);
+#ifdef HAVE_MMAP
+  yolo_assert(mapped == pf->source->mapped);
+#else
+  (void)mapped;
+#endif
+}
+
+/**
+ * A file truncated in place after its loading is still readable, with
+ * the default settings
+ */
+static void truncated(void) {
+  char *path = writeFile("program_file_test.w", 100 * 1000, false);
+  Result rv = wsky_ProgramFile_new(path);
+  yolo_assert_null(rv.exception);
+  if (!rv.exception) {
+    FILE *file = fopen(path, "w");
+    if (file)
+      fclose(file);
+    ProgramFile *pf = (ProgramFile *)wsky_Value_toObject(rv.v);
+    yolo_assert_char_eq('\n', pf->content[100 * 1000 - 1]);
+  }
+  remove(path);
+  wsky_free(path);
+}
+
+static void loading(void) {
+  assertLoaded(1, false);
+  assertLoaded(100, false);
+  assertLoaded(100 * 1000, false);
+
+  wsky_FileContent_setMappingEnabled(true);
+  assertLoaded(100, false);
+  assertLoaded(100 * 1000, true);
+
+  /* A multiple of the usual page sizes, without a null byte after it */
+  assertLoaded(64 * 1024, false);
+  wsky_FileContent_setMappingEnabled(false);
+
+  char *path = writeFile("program_file_test.w", 100 * 1000, true);
+  Result rv = wsky_ProgramFile_new(path);
+  yolo_assert_not_null(rv.exception);
+  remove(path);
+  wsky_free(path);
+
+  rv = wsky_ProgramFile_new("/no/such/file.w");
+  yolo_assert_not_null(rv.exception);
+}
+
 void programFileTestSuite(void) {
   baseTests();
+  truncated();
+  loading();
 }
@@ -0,0 +1,42 @@
+#include "test.h"
+
+#include <string.h>
+#include "symbol.h"
+
+static void intern(void) {
+  char buffer[] = "someSymbol";
+  wsky_Symbol a = wsky_Symbol_intern("someSymbol");
+  wsky_Symbol b = wsky_Symbol_intern(buffer);
+  yolo_assert(a == b);
+  yolo_assert(buffer != b);
+  yolo_assert_str_eq("someSymbol", a);
+  yolo_assert_ulong_eq(10, wsky_Symbol_getLength(a));
+  yolo_assert(a == wsky_Symbol_intern(a));
+}
+
+static void internLength(void) {
+  wsky_Symbol a = wsky_Symbol_internLength("symbolAndMore", 6);
+  yolo_assert_str_eq("symbol", a);
+  yolo_assert(a == wsky_Symbol_intern("symbol"));
+}
+
+static void find(void) {
+  yolo_assert(!wsky_Symbol_find("neverInternedBefore"));
+  wsky_Symbol a = wsky_Symbol_intern("internedNow");
+  yolo_assert(a == wsky_Symbol_find("internedNow"));
+  yolo_assert(a == wsky_Symbol_find(a));
+}
+
+static void hash(void) {
+  char buffer[] = "hashed";
+  wsky_Symbol a = wsky_Symbol_intern("hashed");
+  yolo_assert_uint_eq(wsky_Symbol_getHash(a),
+                      wsky_Symbol_getHash(wsky_Symbol_intern(buffer)));
+}
+
+void symbolTestSuite(void) {
+  intern();
+  internLength();
+  find();
+  hash();
+}
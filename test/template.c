@@ -0,0 +1,247 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "whiskey.h"
+
+
+# define assertRenderEq(expected, source)                       \
+  assertRenderEqImpl((expected), (source),                      \
+                     __func__, YOLO__POSITION_STRING)
+
+# define assertRenderException(exceptionClass, expectedMessage, source) \
+  assertRenderExceptionImpl((exceptionClass), (expectedMessage),        \
+                            (source), __func__, YOLO__POSITION_STRING)
+
+
+static void assertRenderEqImpl(const char *expected,
+                               const char *source,
+                               const char *testName,
+                               const char *position) {
+  wsky_TemplateOutput output;
+  wsky_TemplateOutput_initBuffer(&output);
+
+  wsky_Result rv = wsky_evalTemplateString(source, NULL, &output);
+  if (rv.exception) {
+    yolo_fail_impl(testName, position);
+    printf("%s\n", rv.exception->message);
+  } else {
+    yolo_assert_str_eq_impl(expected, wsky_TemplateOutput_getString(&output),
+                            testName, position);
+  }
+  wsky_TemplateOutput_free(&output);
+}
+
+static void assertRenderExceptionImpl(const char *exceptionClass,
+                                      const char *expectedMessage,
+                                      const char *source,
+                                      const char *testName,
+                                      const char *position) {
+  wsky_TemplateOutput output;
+  wsky_TemplateOutput_initBuffer(&output);
+
+  wsky_Result rv = wsky_evalTemplateString(source, NULL, &output);
+  wsky_TemplateOutput_free(&output);
+  yolo_assert_ptr_neq_impl(NULL, rv.exception, testName, position);
+  if (!rv.exception)
+    return;
+
+  yolo_assert_str_eq_impl(exceptionClass, rv.exception->class->name,
+                          testName, position);
+  yolo_assert_str_eq_impl(expectedMessage, rv.exception->message,
+                          testName, position);
+}
+
+
+static void html(void) {
+  assertRenderEq("", "");
+  assertRenderEq("<p>Hello</p>", "<p>Hello</p>");
+  assertRenderEq("<p></p>", "<p><% %></p>");
+}
+
+static void print(void) {
+  assertRenderEq("<p>3</p>", "<p><%= 1 + 2 %></p>");
+  assertRenderEq("1.5 true null", "<%= 1.5 %> <%= true %> <%= null %>");
+  assertRenderEq("<b>ab</b>", "<b><%= 'a' + 'b' %></b>");
+  assertRenderEq("12", "<%= 1 %><%= 2 %>");
+  assertRenderEq("1", "<%= 1 /* comment */ %>");
+}
+
+static void escape(void) {
+  assertRenderEq("<b>&lt;i&gt; &amp; &quot;&#39;</b>",
+                 "<b><%= '<i> & \"\\'' %></b>");
+  assertRenderEq("&lt;Function&gt;", "<%= {} %>");
+
+  /* The special bytes are found at each position of the blocks */
+  char bytes[80];
+  for (size_t i = 0; i < sizeof bytes; i++) {
+    memset(bytes, 'a', sizeof bytes);
+    bytes[i] = '&';
+    yolo_assert_ulong_eq(i, wsky_html_findSpecial(bytes, sizeof bytes));
+    yolo_assert_ulong_eq(i, wsky_html_findSpecial(bytes, i + 1));
+    yolo_assert_ulong_eq(i, wsky_html_findSpecial(bytes, i));
+  }
+
+  const char *source = "if (a < b && c > \"d\") 'e'";
+  const char *expected =
+    "if (a &lt; b &amp;&amp; c &gt; &quot;d&quot;) &#39;e&#39;";
+  size_t length = strlen(source);
+  char escaped[128];
+  yolo_assert_ulong_eq(strlen(expected),
+                       wsky_html_getEscapedLength(source, length));
+  char *end = wsky_html_escape(escaped, source, length);
+  *end = '\0';
+  yolo_assert_str_eq(expected, escaped);
+}
+
+static void statements(void) {
+  assertRenderEq("Hello World!",
+                 "<% var name = 'World' %>Hello <%= name %>!");
+  assertRenderEq("yes",
+                 "<% var a = true; %>"
+                 "<% if a: %>yes<% else: %>no<% %>");
+  assertRenderEq("<ul><li>1</li><li>2</li></ul>",
+                 "<% var item = {x: ( %><li><%= x %></li><% )} %>"
+                 "<ul><% item(1); item(2) %></ul>");
+}
+
+static void errors(void) {
+  assertRenderException("SyntaxError", "Expected an expression",
+                        "<p><%= %></p>");
+  assertRenderException("SyntaxError", "Unexpected 'b'", "<%= a b %>");
+  assertRenderException("ZeroDivisionError", "Division by zero",
+                        "<%= 1 / 0 %>");
+
+  wsky_Result rv = wsky_Template_print(wsky_Value_fromInt(1));
+  yolo_assert_ptr_neq(NULL, rv.exception);
+}
+
+
+typedef struct {
+  char string[8192];
+  size_t length;
+  unsigned callCount;
+  bool fail;
+} Sink;
+
+static bool writeToSink(void *data, const char *bytes, size_t length) {
+  Sink *sink = data;
+  sink->callCount++;
+  if (sink->fail || sink->length + length >= sizeof sink->string)
+    return false;
+  memcpy(sink->string + sink->length, bytes, length);
+  sink->length += length;
+  sink->string[sink->length] = '\0';
+  return true;
+}
+
+static void stream(void) {
+  Sink sink = {.length = 0, .callCount = 0, .fail = false};
+  wsky_TemplateOutput output;
+  wsky_TemplateOutput_initStream(&output, writeToSink, &sink);
+
+  wsky_Result rv = wsky_evalTemplateString("<p><%= 6 * 7 %></p>",
+                                           NULL, &output);
+  yolo_assert_null(rv.exception);
+  yolo_assert_str_eq("<p>42</p>", sink.string);
+  yolo_assert_int_eq(1, sink.callCount);
+
+  /* A piece larger than the buffer is written as is */
+  char large[wsky_TemplateOutput_STREAM_BUFFER_SIZE + 1];
+  memset(large, 'a', sizeof large - 1);
+  large[sizeof large - 1] = '\0';
+  sink.length = 0;
+  sink.callCount = 0;
+  wsky_TemplateOutput_write(&output, "<", 1);
+  wsky_TemplateOutput_write(&output, large, sizeof large - 1);
+  yolo_assert(wsky_TemplateOutput_flush(&output));
+  yolo_assert_int_eq(2, sink.callCount);
+  yolo_assert_int_eq(sizeof large, sink.length);
+
+  sink.fail = true;
+  rv = wsky_evalTemplateString("<p></p>", NULL, &output);
+  yolo_assert_ptr_neq(NULL, rv.exception);
+  wsky_TemplateOutput_free(&output);
+}
+
+typedef struct {
+  Sink sink;
+  unsigned sliceCount;
+} VectorSink;
+
+static bool writeSlicesToSink(void *data,
+                              const wsky_TemplateSlice *slices,
+                              size_t count) {
+  VectorSink *vectorSink = data;
+  vectorSink->sliceCount += (unsigned)count;
+  for (size_t i = 0; i < count; i++)
+    if (!writeToSink(&vectorSink->sink, slices[i].bytes, slices[i].length))
+      return false;
+  return true;
+}
+
+static void vector(void) {
+  const char *source =
+    "<html><head><title>A static page with a single value</title></head>"
+    "<body><%= 6 * 7 %><% /* comment */ %>"
+    "<p>The end of the page, which is long enough to be a slice</p>"
+    "</body></html>";
+  const char *expected =
+    "<html><head><title>A static page with a single value</title></head>"
+    "<body>42"
+    "<p>The end of the page, which is long enough to be a slice</p>"
+    "</body></html>";
+
+  VectorSink vectorSink = {{.length = 0, .callCount = 0, .fail = false}, 0};
+  wsky_TemplateOutput output;
+  wsky_TemplateOutput_initVector(&output, writeSlicesToSink, &vectorSink);
+
+  wsky_Result rv = wsky_evalTemplateString(source, NULL, &output);
+  yolo_assert_null(rv.exception);
+  yolo_assert_str_eq(expected, vectorSink.sink.string);
+  yolo_assert_int_eq(3, vectorSink.sliceCount);
+  wsky_TemplateOutput_free(&output);
+
+  /* The slices keep the content of the file alive until the flush */
+  vectorSink.sink.length = 0;
+  wsky_TemplateOutput_initVector(&output, writeSlicesToSink, &vectorSink);
+  wsky_FileContent *html = wsky_FileContent_new(wsky_strdup(expected),
+                                                strlen(expected));
+  wsky_TemplateOutput_writeSource(&output, html, 6, strlen(expected) - 6);
+  wsky_FileContent_release(html);
+  yolo_assert(wsky_TemplateOutput_flush(&output));
+  yolo_assert_str_eq(expected + 6, vectorSink.sink.string);
+  wsky_TemplateOutput_free(&output);
+
+  /* writev() */
+  FILE *file = tmpfile();
+  yolo_assert_not_null(file);
+  if (!file)
+    return;
+  int descriptor = fileno(file);
+  wsky_TemplateOutput_initVector(&output,
+                                 wsky_TemplateOutput_writeToDescriptor,
+                                 &descriptor);
+  rv = wsky_evalTemplateString(source, NULL, &output);
+  yolo_assert_null(rv.exception);
+  wsky_TemplateOutput_free(&output);
+
+  char content[1024];
+  rewind(file);
+  size_t length = fread(content, 1, sizeof content - 1, file);
+  content[length] = '\0';
+  yolo_assert_str_eq(expected, content);
+  fclose(file);
+}
+
+void templateTestSuite(void) {
+  html();
+  print();
+  escape();
+  statements();
+  errors();
+  stream();
+  vector();
+}
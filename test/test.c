@@ -23,7 +23,7 @@ static Result assertImpl(wsky_Object *self, wsky_Value *v) {
   if (!wsky_isBoolean(*v)) {
     wsky_RAISE_NEW_PARAMETER_ERROR("Expected a Boolean");
   }
-  yolo_assert(v->v.boolValue);
+  yolo_assert(wsky_Value_toBool(*v));
   wsky_RETURN_NULL;
 }
 
@@ -32,7 +32,7 @@ static Result printImpl(wsky_Object *self, wsky_Value *v) {
   if (!wsky_isString(*v)) {
     wsky_RAISE_NEW_PARAMETER_ERROR("Expected a String");
   }
-  wsky_String *string = (wsky_String *)v->v.objectValue;
+  wsky_String *string = (wsky_String *)wsky_Value_toObject(*v);
   printf("%s", string->string);
   wsky_RETURN_NULL;
 }
@@ -85,14 +85,24 @@ static void runWhiskeyTests(void) {
 }
 
 int main(int argc, char **argv) {
-  if (argc > 1 && strcmp(argv[1], "--gc-stress") == 0)
-    wsky_GC_setStressed(true);
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--gc-stress") == 0)
+      wsky_GC_setStressed(true);
+    else if (strcmp(argv[i], "--gc-precise") == 0)
+      wsky_GC_setPrecise(true);
+    else if (strcmp(argv[i], "--gc-compact") == 0)
+      wsky_GC_setCompacting(true);
+    else if (strcmp(argv[i], "--vm") == 0)
+      wsky_vm_setEnabled(true);
+  }
 
   whiskeyAssertCount = 0;
   yolo_begin();
   wsky_start();
 
   dictTestSuite();
+  symbolTestSuite();
+  valueTestSuite();
   exceptionTestSuite();
   programFileTestSuite();
   positionTestSuite();
@@ -100,6 +110,9 @@ int main(int argc, char **argv) {
   lexerTestSuite();
   parserTestSuite();
   evalTestSuite();
+  fileCacheTestSuite();
+  templateTestSuite();
+  gcTestSuite();
 
   runWhiskeyTests();
 
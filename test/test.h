@@ -27,6 +27,8 @@ void assertExceptionImpl(const char *exceptionClass,
 char *getLocalFilePath(const char *fileName);
 
 void dictTestSuite(void);
+void symbolTestSuite(void);
+void valueTestSuite(void);
 void programFileTestSuite(void);
 void exceptionTestSuite(void);
 void positionTestSuite(void);
@@ -34,5 +36,8 @@ void stringReaderTestSuite(void);
 void lexerTestSuite(void);
 void parserTestSuite(void);
 void evalTestSuite(void);
+void fileCacheTestSuite(void);
+void templateTestSuite(void);
+void gcTestSuite(void);
 
 #endif /* TEST_H */
@@ -0,0 +1,107 @@
+#include "test.h"
+
+#include <math.h>
+#include "whiskey.h"
+
+typedef wsky_Value Value;
+
+
+static void types(void) {
+  yolo_assert_int_eq(wsky_Type_BOOL, wsky_Value_getType(wsky_Value_TRUE));
+  yolo_assert_int_eq(wsky_Type_INT,
+                     wsky_Value_getType(wsky_Value_fromInt(0)));
+  yolo_assert_int_eq(wsky_Type_FLOAT,
+                     wsky_Value_getType(wsky_Value_fromFloat(0.0)));
+  yolo_assert_int_eq(wsky_Type_OBJECT, wsky_Value_getType(wsky_Value_NULL));
+  yolo_assert(wsky_isNull(wsky_Value_NULL));
+  yolo_assert(!wsky_isNull(wsky_Value_fromInt(0)));
+  yolo_assert(!wsky_isNull(wsky_Value_FALSE));
+}
+
+static void booleans(void) {
+  yolo_assert(wsky_Value_toBool(wsky_Value_fromBool(true)));
+  yolo_assert(!wsky_Value_toBool(wsky_Value_fromBool(false)));
+}
+
+static void integers(void) {
+  wsky_int values[] = {0, 1, -1, 123456789, -123456789,
+                       (wsky_int)1 << 46, -((wsky_int)1 << 47)};
+  for (size_t i = 0; i < sizeof values / sizeof values[0]; i++) {
+    Value v = wsky_Value_fromInt(values[i]);
+    yolo_assert_long_eq((long)values[i], (long)wsky_Value_toInt(v));
+  }
+}
+
+static void floats(void) {
+  wsky_float values[] = {0.0, -0.0, 1.5, -1e300, INFINITY, -INFINITY};
+  for (size_t i = 0; i < sizeof values / sizeof values[0]; i++) {
+    Value v = wsky_Value_fromFloat(values[i]);
+    yolo_assert_int_eq(wsky_Type_FLOAT, wsky_Value_getType(v));
+    yolo_assert(values[i] == wsky_Value_toFloat(v));
+  }
+
+  Value nan = wsky_Value_fromFloat(-NAN);
+  yolo_assert_int_eq(wsky_Type_FLOAT, wsky_Value_getType(nan));
+  yolo_assert(isnan(wsky_Value_toFloat(nan)));
+}
+
+static void objects(void) {
+  wsky_Object *object = (wsky_Object *)wsky_String_new("value");
+  Value v = wsky_Value_fromObject(object);
+  yolo_assert_ptr_eq(object, wsky_Value_toObject(v));
+  yolo_assert(wsky_isString(v));
+  yolo_assert_ptr_eq(NULL, wsky_Value_toObject(wsky_Value_NULL));
+}
+
+static void formatting(void) {
+  char buffer[wsky_FORMAT_BUFFER_SIZE];
+
+  yolo_assert_ulong_eq(1, wsky_formatInt(0, buffer));
+  yolo_assert_str_eq("0", buffer);
+  yolo_assert_ulong_eq(4, wsky_formatInt(-123, buffer));
+  yolo_assert_str_eq("-123", buffer);
+  wsky_formatInt(INT64_MIN, buffer);
+  yolo_assert_str_eq("-9223372036854775808", buffer);
+
+  yolo_assert_ulong_eq(3, wsky_formatFloat(1.0, buffer));
+  yolo_assert_str_eq("1.0", buffer);
+  wsky_formatFloat(-0.25, buffer);
+  yolo_assert_str_eq("-0.25", buffer);
+  wsky_formatFloat(-1e300, buffer);
+  yolo_assert_str_eq("-1e+300", buffer);
+  wsky_formatFloat(NAN, buffer);
+  yolo_assert_str_eq("NaN", buffer);
+  wsky_formatFloat(-INFINITY, buffer);
+  yolo_assert_str_eq("-Infinity", buffer);
+
+  yolo_assert_ulong_eq(5, wsky_formatPrimitive(wsky_Value_FALSE, buffer));
+  yolo_assert_str_eq("false", buffer);
+}
+
+static void cachedStrings(void) {
+  wsky_Value values[] = {
+    wsky_Value_TRUE, wsky_Value_FALSE, wsky_Value_NULL,
+    wsky_Value_fromInt(-128), wsky_Value_fromInt(0), wsky_Value_fromInt(1023),
+  };
+  for (size_t i = 0; i < sizeof values / sizeof values[0]; i++) {
+    wsky_Result a = wsky_toString(values[i]);
+    wsky_Result b = wsky_toString(values[i]);
+    yolo_assert_ptr_eq(wsky_Value_toObject(a.v), wsky_Value_toObject(b.v));
+  }
+
+  yolo_assert_null(wsky_String_getCached(wsky_Value_fromInt(1024)));
+  yolo_assert_null(wsky_String_getCached(wsky_Value_fromFloat(1.0)));
+  yolo_assert_str_eq("-128",
+                     wsky_String_getCached(wsky_Value_fromInt(-128))->string);
+  yolo_assert_str_eq("", wsky_String_getEmpty()->string);
+}
+
+void valueTestSuite(void) {
+  types();
+  booleans();
+  integers();
+  floats();
+  objects();
+  formatting();
+  cachedStrings();
+}